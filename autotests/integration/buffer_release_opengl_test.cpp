@@ -0,0 +1,19 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "generic_buffer_release_test.h"
+
+class BufferReleaseOpenGLTest : public GenericBufferReleaseTest
+{
+    Q_OBJECT
+public:
+    BufferReleaseOpenGLTest() : GenericBufferReleaseTest(QByteArrayLiteral("O2"), KWin::OpenGLCompositing) {}
+};
+
+WAYLANDTEST_MAIN(BufferReleaseOpenGLTest)
+#include "buffer_release_opengl_test.moc"
@@ -0,0 +1,511 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "abstract_output.h"
+#include "composite.h"
+#include "effectloader.h"
+#include "effects.h"
+#include "platform.h"
+#include "renderloop.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+#include "x11client.h"
+
+#include <config-kwin.h>
+
+#include <KConfigGroup>
+
+#include <KWayland/Client/buffer.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/subsurface.h>
+#include <KWayland/Client/surface.h>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+#include <time.h>
+
+#include <xcb/xcb.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_compositor_benchmark-0");
+
+// Counts the allocations made with operator new by the whole process, including KWin.
+static std::atomic<quint64> s_allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+static qint64 processCpuTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static qint64 monotonicTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+static int environmentValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+/**
+ * Returns the value below which the given @a fraction of the samples lies.
+ */
+static qint64 percentile(QVector<qint64> samples, qreal fraction)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    const int index = std::min<int>(samples.count() - 1, samples.count() * fraction);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+static qint64 average(const QVector<qint64> &samples)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    qint64 sum = 0;
+    for (qint64 sample : samples) {
+        sum += sample;
+    }
+    return sum / samples.count();
+}
+
+enum class DamagePattern {
+    Full, ///< the whole surface changes, e.g. a video
+    Small, ///< a small square moves around, e.g. a spinner or a blinking cursor
+    Band, ///< a full width band moves down, e.g. a scrolling text view
+};
+
+Q_DECLARE_METATYPE(DamagePattern)
+
+/**
+ * The CompositorBenchmark measures the performance of the compositor with a number of
+ * synthetic Wayland clients that update their contents every frame.
+ *
+ * For every configuration, the benchmark measures
+ *
+ * - the frame time, from the start of a frame until the scene has rendered it,
+ * - the CPU time of the process per frame, including all threads,
+ * - the number of allocations per frame,
+ * - the latency from the commit of the clients until the frame has been rendered and
+ *   presented.
+ *
+ * The X11 configurations use Xwayland clients that draw with core protocol requests, so
+ * they are only run by benchmarkCompositorXwayland.
+ *
+ * The number of frames per configuration can be set with KWIN_BENCHMARK_FRAMES, the
+ * number of clients can be overridden with KWIN_BENCHMARK_CLIENTS. The median frame
+ * time is reported as the benchmark result, so the usual QtTest output formats can be
+ * used. In addition, all measurements are written as JSON to the file specified with
+ * KWIN_BENCHMARK_RESULTS.
+ */
+class CompositorBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+    void benchmarkFrames_data();
+    void benchmarkFrames();
+    void benchmarkX11Frames_data();
+    void benchmarkX11Frames();
+
+private:
+    /**
+     * Lets the clients update their contents with @a updateClients for @a frameCount frames
+     * and measures how the compositor handles every frame.
+     */
+    void measureFrames(int clientCount, int frameCount, const std::function<void(int frame)> &updateClients);
+
+    struct Client
+    {
+        Surface *surface = nullptr;
+        Test::XdgToplevel *shellSurface = nullptr;
+        QVector<Surface *> subSurfaces;
+        QVector<SubSurface *> subSurfaceRoles;
+        QVector<Buffer::Ptr> buffers;
+        QVector<Buffer::Ptr> subSurfaceBuffers;
+    };
+
+    QJsonArray m_results;
+};
+
+static const QSize s_clientSize(400, 300);
+static const QSize s_subSurfaceSize(64, 64);
+
+void CompositorBenchmark::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1920, 1080));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    // effects are enabled explicitly by the configurations that need them
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+}
+
+void CompositorBenchmark::cleanupTestCase()
+{
+    const QString fileName = qEnvironmentVariable("KWIN_BENCHMARK_RESULTS");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QJsonObject document;
+    document[QStringLiteral("version")] = QStringLiteral(KWIN_VERSION_STRING);
+    document[QStringLiteral("compositor")] = kwinApp()->platform()->selectedCompositor() == QPainterCompositing
+        ? QStringLiteral("qpainter") : QStringLiteral("opengl");
+    document[QStringLiteral("results")] = m_results;
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(QJsonDocument(document).toJson());
+}
+
+void CompositorBenchmark::cleanup()
+{
+    auto effectsImpl = qobject_cast<EffectsHandlerImpl *>(effects);
+    if (effectsImpl) {
+        effectsImpl->unloadAllEffects();
+    }
+    Test::destroyWaylandConnection();
+}
+
+void CompositorBenchmark::benchmarkFrames_data()
+{
+    QTest::addColumn<int>("clientCount");
+    QTest::addColumn<QImage::Format>("format");
+    QTest::addColumn<DamagePattern>("damage");
+    QTest::addColumn<int>("subSurfaceCount");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<QStringList>("effectNames");
+
+    QTest::newRow("1 client, full damage") << 1 << QImage::Format_RGB32 << DamagePattern::Full << 0 << 1.0 << QStringList();
+    QTest::newRow("8 clients, full damage") << 8 << QImage::Format_RGB32 << DamagePattern::Full << 0 << 1.0 << QStringList();
+    QTest::newRow("8 clients, small damage") << 8 << QImage::Format_RGB32 << DamagePattern::Small << 0 << 1.0 << QStringList();
+    QTest::newRow("8 clients, band damage") << 8 << QImage::Format_RGB32 << DamagePattern::Band << 0 << 1.0 << QStringList();
+    QTest::newRow("8 clients, alpha buffers") << 8 << QImage::Format_ARGB32_Premultiplied << DamagePattern::Full << 0 << 1.0 << QStringList();
+    QTest::newRow("8 clients, translucent") << 8 << QImage::Format_RGB32 << DamagePattern::Full << 0 << 0.8 << QStringList();
+    QTest::newRow("8 clients, subsurfaces") << 8 << QImage::Format_RGB32 << DamagePattern::Small << 4 << 1.0 << QStringList();
+    QTest::newRow("8 clients, effects") << 8 << QImage::Format_RGB32 << DamagePattern::Small << 0 << 1.0
+                                        << QStringList{QStringLiteral("kwin4_effect_translucency"), QStringLiteral("diminactive")};
+    QTest::newRow("32 clients, small damage") << 32 << QImage::Format_RGB32 << DamagePattern::Small << 0 << 1.0 << QStringList();
+}
+
+static QRect damageForFrame(DamagePattern pattern, const QSize &size, int frame)
+{
+    switch (pattern) {
+    case DamagePattern::Full:
+        return QRect(QPoint(0, 0), size);
+    case DamagePattern::Small: {
+        const int columns = size.width() / 32;
+        const int rows = size.height() / 32;
+        const int cell = frame % (columns * rows);
+        return QRect((cell % columns) * 32, (cell / columns) * 32, 32, 32);
+    }
+    case DamagePattern::Band:
+        return QRect(0, (frame * 16) % size.height(), size.width(), 32) & QRect(QPoint(0, 0), size);
+    }
+    Q_UNREACHABLE();
+}
+
+void CompositorBenchmark::measureFrames(int clientCount, int frameCount, const std::function<void(int frame)> &updateClients)
+{
+    Scene *scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    RenderLoop *renderLoop = kwinApp()->platform()->enabledOutputs().constFirst()->renderLoop();
+
+    QVector<qint64> frameTimes;
+    QVector<qint64> cpuTimes;
+    QVector<qint64> allocations;
+    QVector<qint64> renderLatencies;
+    QVector<qint64> presentLatencies;
+
+    qint64 frameStart = 0;
+    qint64 cpuStart = 0;
+    quint64 allocationStart = 0;
+    qint64 commitTime = 0;
+    bool measuring = false;
+    bool rendered = false;
+    bool presented = false;
+
+    QMetaObject::Connection aboutToRequestConnection = connect(renderLoop, &RenderLoop::aboutToRequestFrame, this, [&]() {
+        frameStart = monotonicTime();
+        cpuStart = processCpuTime();
+        allocationStart = s_allocationCount.load(std::memory_order_relaxed);
+    });
+    QMetaObject::Connection renderedConnection = connect(scene, &Scene::frameRendered, this, [&]() {
+        const qint64 now = monotonicTime();
+        if (measuring && frameStart) {
+            frameTimes.append(now - frameStart);
+            cpuTimes.append(processCpuTime() - cpuStart);
+            allocations.append(s_allocationCount.load(std::memory_order_relaxed) - allocationStart);
+            renderLatencies.append(now - commitTime);
+        }
+        rendered = true;
+    });
+    QMetaObject::Connection presentedConnection = connect(renderLoop, &RenderLoop::framePresented, this, [&]() {
+        if (measuring && rendered) {
+            presentLatencies.append(monotonicTime() - commitTime);
+        }
+        presented = true;
+    });
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        updateClients(frame);
+
+        rendered = false;
+        presented = false;
+        frameStart = 0;
+        measuring = true;
+        commitTime = monotonicTime();
+        QTRY_VERIFY(rendered && presented);
+        measuring = false;
+    }
+
+    disconnect(aboutToRequestConnection);
+    disconnect(renderedConnection);
+    disconnect(presentedConnection);
+
+    QTest::setBenchmarkResult(percentile(frameTimes, 0.5) / 1000000.0, QTest::WalltimeMilliseconds);
+
+    QJsonObject result;
+    result[QStringLiteral("name")] = QString::fromUtf8(QTest::currentDataTag());
+    result[QStringLiteral("clients")] = clientCount;
+    result[QStringLiteral("frames")] = frameTimes.count();
+    result[QStringLiteral("frameTimeMedianNs")] = percentile(frameTimes, 0.5);
+    result[QStringLiteral("frameTimeP95Ns")] = percentile(frameTimes, 0.95);
+    result[QStringLiteral("cpuTimePerFrameNs")] = average(cpuTimes);
+    result[QStringLiteral("allocationsPerFrame")] = average(allocations);
+    result[QStringLiteral("renderLatencyMedianNs")] = percentile(renderLatencies, 0.5);
+    result[QStringLiteral("renderLatencyP99Ns")] = percentile(renderLatencies, 0.99);
+    result[QStringLiteral("presentLatencyMedianNs")] = percentile(presentLatencies, 0.5);
+    result[QStringLiteral("presentLatencyP99Ns")] = percentile(presentLatencies, 0.99);
+    m_results.append(result);
+}
+
+void CompositorBenchmark::benchmarkFrames()
+{
+    QFETCH(int, clientCount);
+    QFETCH(QImage::Format, format);
+    QFETCH(DamagePattern, damage);
+    QFETCH(int, subSurfaceCount);
+    QFETCH(qreal, opacity);
+    QFETCH(QStringList, effectNames);
+
+    clientCount = environmentValue("KWIN_BENCHMARK_CLIENTS", clientCount);
+    const int frameCount = environmentValue("KWIN_BENCHMARK_FRAMES", 120);
+
+    QVERIFY(Test::setupWaylandConnection());
+
+    auto effectsImpl = qobject_cast<EffectsHandlerImpl *>(effects);
+    for (const QString &effectName : qAsConst(effectNames)) {
+        QVERIFY(effectsImpl);
+        QVERIFY(effectsImpl->loadEffect(effectName));
+    }
+
+    // The buffers are created upfront, so the clients don't paint anything while the
+    // compositor is being measured.
+    QImage images[2] = {QImage(s_clientSize, format), QImage(s_clientSize, format)};
+    images[0].fill(QColor(0, 0, 255, 200));
+    images[1].fill(QColor(0, 255, 0, 200));
+    QImage subSurfaceImages[2] = {QImage(s_subSurfaceSize, format), QImage(s_subSurfaceSize, format)};
+    subSurfaceImages[0].fill(Qt::red);
+    subSurfaceImages[1].fill(Qt::yellow);
+
+    QVector<Client> clients;
+    QVector<AbstractClient *> windows;
+    for (int i = 0; i < clientCount; ++i) {
+        Client client;
+        client.surface = Test::createSurface();
+        client.shellSurface = Test::createXdgToplevelSurface(client.surface);
+        for (int j = 0; j < subSurfaceCount; ++j) {
+            Surface *surface = Test::createSurface();
+            SubSurface *subSurface = Test::createSubSurface(surface, client.surface);
+            subSurface->setPosition(QPoint(j * (s_subSurfaceSize.width() + 8), 8));
+            client.subSurfaces.append(surface);
+            client.subSurfaceRoles.append(subSurface);
+        }
+        for (const QImage &image : images) {
+            client.buffers.append(Test::waylandShmPool()->createBuffer(image));
+        }
+        for (const QImage &image : subSurfaceImages) {
+            client.subSurfaceBuffers.append(Test::waylandShmPool()->createBuffer(image));
+        }
+        for (Surface *surface : qAsConst(client.subSurfaces)) {
+            surface->attachBuffer(client.subSurfaceBuffers[0]);
+            surface->damage(QRect(QPoint(0, 0), s_subSurfaceSize));
+            surface->commit(Surface::CommitFlag::None);
+        }
+        AbstractClient *window = Test::renderAndWaitForShown(client.surface, s_clientSize, Qt::blue, format);
+        QVERIFY(window);
+        window->setOpacity(opacity);
+        clients.append(client);
+        windows.append(window);
+    }
+
+    measureFrames(clientCount, frameCount, [&](int frame) {
+        for (Client &client : clients) {
+            for (Surface *surface : qAsConst(client.subSurfaces)) {
+                surface->attachBuffer(client.subSurfaceBuffers[frame % 2]);
+                surface->damage(QRect(QPoint(0, 0), s_subSurfaceSize));
+                surface->commit(Surface::CommitFlag::None);
+            }
+            client.surface->attachBuffer(client.buffers[frame % 2]);
+            client.surface->damage(damageForFrame(damage, s_clientSize, frame));
+            client.surface->commit(Surface::CommitFlag::None);
+        }
+        Test::flushWaylandConnection();
+    });
+
+    for (int i = 0; i < clients.count(); ++i) {
+        Client &client = clients[i];
+        qDeleteAll(client.subSurfaceRoles);
+        qDeleteAll(client.subSurfaces);
+        delete client.shellSurface;
+        delete client.surface;
+        QVERIFY(Test::waitForWindowDestroyed(windows[i]));
+    }
+}
+
+void CompositorBenchmark::benchmarkX11Frames_data()
+{
+    QTest::addColumn<int>("clientCount");
+    QTest::addColumn<DamagePattern>("damage");
+
+    QTest::newRow("50 X11 clients, small damage") << 50 << DamagePattern::Small;
+    QTest::newRow("50 X11 clients, full damage") << 50 << DamagePattern::Full;
+}
+
+struct XcbConnectionDeleter
+{
+    static inline void cleanup(xcb_connection_t *pointer)
+    {
+        xcb_disconnect(pointer);
+    }
+};
+
+void CompositorBenchmark::benchmarkX11Frames()
+{
+#ifdef NO_XWAYLAND
+    QSKIP("X11 clients need Xwayland, run benchmarkCompositorXwayland instead");
+#endif
+    QFETCH(int, clientCount);
+    QFETCH(DamagePattern, damage);
+
+    clientCount = environmentValue("KWIN_BENCHMARK_CLIENTS", clientCount);
+    const int frameCount = environmentValue("KWIN_BENCHMARK_FRAMES", 120);
+
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+
+    QSignalSpy clientAddedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+
+    // The clients paint with core protocol requests, so they do hardly any work themselves
+    // and the damage reaches the compositor through the X server.
+    const uint32_t colors[2] = {0xff0000ff, 0xff00ff00};
+    QHash<xcb_window_t, xcb_gcontext_t> contexts;
+    for (int i = 0; i < clientCount; ++i) {
+        const xcb_window_t window = xcb_generate_id(c.data());
+        xcb_create_window(c.data(), XCB_COPY_FROM_PARENT, window, rootWindow(),
+                          0, 0, s_clientSize.width(), s_clientSize.height(),
+                          0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, XCB_CW_BACK_PIXEL, &colors[0]);
+        const xcb_gcontext_t context = xcb_generate_id(c.data());
+        xcb_create_gc(c.data(), context, window, XCB_GC_FOREGROUND, &colors[0]);
+        xcb_map_window(c.data(), window);
+        contexts.insert(window, context);
+    }
+    xcb_flush(c.data());
+
+    while (clientAddedSpy.count() < clientCount) {
+        QVERIFY(clientAddedSpy.wait());
+    }
+    QVector<X11Client *> clients;
+    for (const QList<QVariant> &arguments : qAsConst(clientAddedSpy)) {
+        X11Client *client = qobject_cast<X11Client *>(arguments.first().value<AbstractClient *>());
+        QVERIFY(client);
+        QVERIFY(contexts.contains(client->window()));
+        QTRY_VERIFY(client->readyForPainting());
+        clients.append(client);
+    }
+
+    measureFrames(clientCount, frameCount, [&](int frame) {
+        const QRect rect = damageForFrame(damage, s_clientSize, frame);
+        const xcb_rectangle_t rectangle{int16_t(rect.x()), int16_t(rect.y()), uint16_t(rect.width()), uint16_t(rect.height())};
+        for (auto it = contexts.constBegin(); it != contexts.constEnd(); ++it) {
+            xcb_change_gc(c.data(), it.value(), XCB_GC_FOREGROUND, &colors[(frame + 1) % 2]);
+            xcb_poly_fill_rectangle(c.data(), it.key(), it.value(), 1, &rectangle);
+        }
+        xcb_flush(c.data());
+    });
+
+    for (X11Client *client : qAsConst(clients)) {
+        xcb_destroy_window(c.data(), client->window());
+        xcb_flush(c.data());
+        QVERIFY(Test::waitForWindowDestroyed(client));
+    }
+}
+
+WAYLANDTEST_MAIN(CompositorBenchmark)
+#include "compositor_benchmark.moc"
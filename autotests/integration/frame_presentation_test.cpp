@@ -0,0 +1,135 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "abstract_output.h"
+#include "composite.h"
+#include "platform.h"
+#include "renderloop.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/surface.h>
+
+#include <wayland-client-protocol.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_presentation-0");
+
+struct FrameCallback
+{
+    bool done = false;
+    uint32_t time = 0;
+};
+
+static void frameCallbackDone(void *data, wl_callback *callback, uint32_t time)
+{
+    auto frameCallback = static_cast<FrameCallback *>(data);
+    frameCallback->done = true;
+    frameCallback->time = time;
+    wl_callback_destroy(callback);
+}
+
+static const wl_callback_listener s_frameCallbackListener = {
+    frameCallbackDone,
+};
+
+class FramePresentationTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testFrameCallbackTimestamp();
+    void testPresentationSequence();
+};
+
+void FramePresentationTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+}
+
+void FramePresentationTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void FramePresentationTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void FramePresentationTest::testFrameCallbackTimestamp()
+{
+    // this test verifies that frame callbacks are sent when the frame is presented by the
+    // software vsync of the virtual backend and carry the timestamp of that frame rather than
+    // the one of the previous frame
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    AbstractOutput *output = kwinApp()->platform()->enabledOutputs().constFirst();
+    RenderLoop *renderLoop = output->renderLoop();
+    QSignalSpy framePresentedSpy(renderLoop, &RenderLoop::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+
+    for (int i = 0; i < 3; ++i) {
+        FrameCallback frameCallback;
+        wl_callback *callback = wl_surface_frame(*surface.data());
+        wl_callback_add_listener(callback, &s_frameCallbackListener, &frameCallback);
+        surface->commit(Surface::CommitFlag::None);
+        Compositor::self()->scene()->addRepaintFull();
+
+        framePresentedSpy.clear();
+        QTRY_VERIFY(frameCallback.done);
+
+        // the frame callback must not be sent before the frame has been presented
+        QVERIFY(!framePresentedSpy.isEmpty());
+        const auto timestamp = framePresentedSpy.last().at(1).value<std::chrono::nanoseconds>();
+        const auto frameTime = std::chrono::duration_cast<std::chrono::milliseconds>(timestamp);
+        QCOMPARE(frameCallback.time, uint32_t(frameTime.count()));
+        QCOMPARE(renderLoop->lastPresentationTimestamp(), timestamp);
+    }
+}
+
+void FramePresentationTest::testPresentationSequence()
+{
+    // this test verifies that every presented frame advances the presentation sequence
+    AbstractOutput *output = kwinApp()->platform()->enabledOutputs().constFirst();
+    RenderLoop *renderLoop = output->renderLoop();
+    QSignalSpy framePresentedSpy(renderLoop, &RenderLoop::framePresented);
+    QVERIFY(framePresentedSpy.isValid());
+
+    const uint64_t sequence = renderLoop->lastPresentationSequence();
+    Compositor::self()->scene()->addRepaintFull();
+    QVERIFY(framePresentedSpy.wait());
+    QCOMPARE(renderLoop->lastPresentationSequence(), sequence + 1);
+
+    Compositor::self()->scene()->addRepaintFull();
+    QVERIFY(framePresentedSpy.wait());
+    QCOMPARE(renderLoop->lastPresentationSequence(), sequence + 2);
+}
+
+WAYLANDTEST_MAIN(FramePresentationTest)
+#include "frame_presentation_test.moc"
@@ -0,0 +1,127 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "abstract_output.h"
+#include "composite.h"
+#include "effectloader.h"
+#include "platform.h"
+#include "renderbackend.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KConfigGroup>
+
+#include <KWayland/Client/surface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_throttling_scanout-0");
+
+class FrameThrottlingScanoutTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testScanoutAfterOcclusion();
+};
+
+void FrameThrottlingScanoutTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    // disable all effects, they could force painting windows that are covered
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+    QMetaObject::invokeMethod(kwinApp()->platform(), "setDirectScanoutEmulated", Qt::DirectConnection, Q_ARG(bool, true));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+    QCOMPARE(Compositor::self()->backend()->compositingType(), KWin::OpenGLCompositing);
+}
+
+void FrameThrottlingScanoutTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void FrameThrottlingScanoutTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void FrameThrottlingScanoutTest::testScanoutAfterOcclusion()
+{
+    // this test verifies that a window which was occluded in the last composited frame gets
+    // frame callbacks with every frame once it's scanned out directly
+    AbstractOutput *output = kwinApp()->platform()->enabledOutputs().constFirst();
+    output->inhibitDirectScanout();
+
+    QScopedPointer<Surface> bottomSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> bottomShellSurface(Test::createXdgToplevelSurface(bottomSurface.data()));
+    AbstractClient *bottom = Test::renderAndWaitForShown(bottomSurface.data(), QSize(100, 50), Qt::red, QImage::Format_RGB32);
+    QVERIFY(bottom);
+    bottom->move(QPoint(0, 0));
+
+    QScopedPointer<Surface> topSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> topShellSurface(Test::createXdgToplevelSurface(topSurface.data()));
+    AbstractClient *top = Test::renderAndWaitForShown(topSurface.data(), QSize(200, 100), Qt::blue, QImage::Format_RGB32);
+    QVERIFY(top);
+    top->move(QPoint(0, 0));
+
+    QSignalSpy bottomFrameSpy(bottomSurface.data(), &Surface::frameRendered);
+    QVERIFY(bottomFrameSpy.isValid());
+    QSignalSpy topFrameSpy(topSurface.data(), &Surface::frameRendered);
+    QVERIFY(topFrameSpy.isValid());
+
+    // the composited frames mark the bottom window as occluded
+    bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+    for (int i = 0; i < 3; ++i) {
+        topSurface->commit(Surface::CommitFlag::FrameCallback);
+        Compositor::self()->scene()->addRepaintFull();
+        QVERIFY(topFrameSpy.wait());
+    }
+    QCOMPARE(bottomFrameSpy.count(), 0);
+
+    // without the top window, the bottom window is the only content of the output and
+    // gets scanned out, it must get a frame callback with every frame again
+    output->uninhibitDirectScanout();
+    topShellSurface.reset();
+    topSurface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(top));
+
+    const int count = bottomFrameSpy.count();
+    for (int i = 1; i <= 3; ++i) {
+        bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+        Compositor::self()->scene()->addRepaintFull();
+        QVERIFY(bottomFrameSpy.wait(500));
+        QCOMPARE(bottomFrameSpy.count(), count + i);
+    }
+}
+
+WAYLANDTEST_MAIN(FrameThrottlingScanoutTest)
+#include "frame_throttling_scanout_test.moc"
@@ -0,0 +1,170 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "composite.h"
+#include "effectloader.h"
+#include "platform.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KConfigGroup>
+
+#include <KWayland/Client/surface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_frame_throttling-0");
+
+class FrameThrottlingTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testOccludedWindow();
+    void testPartiallyOccludedWindow();
+    void testTranslucentWindowAbove();
+};
+
+void FrameThrottlingTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    // disable all effects, they could force painting windows that are covered
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    const auto builtinNames = EffectLoader().listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("Q"));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+}
+
+void FrameThrottlingTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void FrameThrottlingTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+void FrameThrottlingTest::testOccludedWindow()
+{
+    // this test verifies that a window which is entirely covered by an opaque window
+    // doesn't get frame callbacks for every frame, but only at a low rate
+    QScopedPointer<Surface> bottomSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> bottomShellSurface(Test::createXdgToplevelSurface(bottomSurface.data()));
+    AbstractClient *bottom = Test::renderAndWaitForShown(bottomSurface.data(), QSize(100, 50), Qt::red, QImage::Format_RGB32);
+    QVERIFY(bottom);
+    bottom->move(QPoint(0, 0));
+
+    QScopedPointer<Surface> topSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> topShellSurface(Test::createXdgToplevelSurface(topSurface.data()));
+    AbstractClient *top = Test::renderAndWaitForShown(topSurface.data(), QSize(200, 100), Qt::blue, QImage::Format_RGB32);
+    QVERIFY(top);
+    top->move(QPoint(0, 0));
+    QVERIFY(top->frameGeometry().contains(bottom->frameGeometry()));
+
+    QSignalSpy bottomFrameSpy(bottomSurface.data(), &Surface::frameRendered);
+    QVERIFY(bottomFrameSpy.isValid());
+    QSignalSpy topFrameSpy(topSurface.data(), &Surface::frameRendered);
+    QVERIFY(topFrameSpy.isValid());
+
+    bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+    for (int i = 0; i < 3; ++i) {
+        topSurface->commit(Surface::CommitFlag::FrameCallback);
+        Compositor::self()->scene()->addRepaintFull();
+        QVERIFY(topFrameSpy.wait());
+    }
+    QCOMPARE(topFrameSpy.count(), 3);
+    QCOMPARE(bottomFrameSpy.count(), 0);
+
+    // the fallback tick still delivers the frame callback eventually
+    QVERIFY(bottomFrameSpy.wait(2000));
+    QCOMPARE(bottomFrameSpy.count(), 1);
+
+    // once the window is uncovered, it gets frame callbacks with every frame again
+    top->move(QPoint(500, 500));
+    bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+    Compositor::self()->scene()->addRepaintFull();
+    QVERIFY(bottomFrameSpy.wait(500));
+    QCOMPARE(bottomFrameSpy.count(), 2);
+}
+
+void FrameThrottlingTest::testPartiallyOccludedWindow()
+{
+    // this test verifies that a window which is only partially covered keeps getting
+    // a frame callback for every frame
+    QScopedPointer<Surface> bottomSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> bottomShellSurface(Test::createXdgToplevelSurface(bottomSurface.data()));
+    AbstractClient *bottom = Test::renderAndWaitForShown(bottomSurface.data(), QSize(100, 50), Qt::red, QImage::Format_RGB32);
+    QVERIFY(bottom);
+    bottom->move(QPoint(0, 0));
+
+    QScopedPointer<Surface> topSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> topShellSurface(Test::createXdgToplevelSurface(topSurface.data()));
+    AbstractClient *top = Test::renderAndWaitForShown(topSurface.data(), QSize(200, 100), Qt::blue, QImage::Format_RGB32);
+    QVERIFY(top);
+    top->move(QPoint(50, 0));
+
+    QSignalSpy bottomFrameSpy(bottomSurface.data(), &Surface::frameRendered);
+    QVERIFY(bottomFrameSpy.isValid());
+    for (int i = 0; i < 3; ++i) {
+        bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+        Compositor::self()->scene()->addRepaintFull();
+        QVERIFY(bottomFrameSpy.wait(500));
+    }
+    QCOMPARE(bottomFrameSpy.count(), 3);
+}
+
+void FrameThrottlingTest::testTranslucentWindowAbove()
+{
+    // this test verifies that a window covered by a translucent window is considered visible
+    QScopedPointer<Surface> bottomSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> bottomShellSurface(Test::createXdgToplevelSurface(bottomSurface.data()));
+    AbstractClient *bottom = Test::renderAndWaitForShown(bottomSurface.data(), QSize(100, 50), Qt::red, QImage::Format_RGB32);
+    QVERIFY(bottom);
+    bottom->move(QPoint(0, 0));
+
+    QScopedPointer<Surface> topSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> topShellSurface(Test::createXdgToplevelSurface(topSurface.data()));
+    AbstractClient *top = Test::renderAndWaitForShown(topSurface.data(), QSize(200, 100), QColor(0, 0, 255, 128));
+    QVERIFY(top);
+    top->move(QPoint(0, 0));
+
+    QSignalSpy bottomFrameSpy(bottomSurface.data(), &Surface::frameRendered);
+    QVERIFY(bottomFrameSpy.isValid());
+    for (int i = 0; i < 3; ++i) {
+        bottomSurface->commit(Surface::CommitFlag::FrameCallback);
+        Compositor::self()->scene()->addRepaintFull();
+        QVERIFY(bottomFrameSpy.wait(500));
+    }
+    QCOMPARE(bottomFrameSpy.count(), 3);
+}
+
+WAYLANDTEST_MAIN(FrameThrottlingTest)
+#include "frame_throttling_test.moc"
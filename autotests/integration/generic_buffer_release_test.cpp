@@ -0,0 +1,125 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "generic_buffer_release_test.h"
+
+#include "abstract_client.h"
+#include "composite.h"
+#include "platform.h"
+#include "renderbackend.h"
+#include "scene.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/buffer.h>
+#include <KWayland/Client/shm_pool.h>
+#include <KWayland/Client/surface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_buffer_release-0");
+
+GenericBufferReleaseTest::GenericBufferReleaseTest(const QByteArray &envVariable, CompositingType compositingType)
+    : QObject()
+    , m_envVariable(envVariable)
+    , m_compositingType(compositingType)
+{
+}
+
+GenericBufferReleaseTest::~GenericBufferReleaseTest()
+{
+}
+
+void GenericBufferReleaseTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+    qputenv("KWIN_COMPOSE", m_envVariable);
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+    QCOMPARE(Compositor::self()->backend()->compositingType(), m_compositingType);
+
+    // the OpenGL scene can only tell when the GPU is done with a buffer using native fences
+    if (m_compositingType == OpenGLCompositing && !Compositor::self()->scene()->canReleaseClientBuffersEarly()) {
+        QSKIP("EGL_ANDROID_native_fence_sync is unavailable");
+    }
+    QVERIFY(Compositor::self()->scene()->canReleaseClientBuffersEarly());
+}
+
+void GenericBufferReleaseTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void GenericBufferReleaseTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+static Buffer::Ptr createBuffer(const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    return Test::waylandShmPool()->createBuffer(image);
+}
+
+void GenericBufferReleaseTest::testReleaseOnCommit()
+{
+    // this test verifies that the previous buffer is released as soon as the client commits
+    // a new one, without waiting for the compositor to render another frame
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    QSignalSpy frameRenderedSpy(Compositor::self()->scene(), &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+
+    Buffer::Ptr first = createBuffer(QSize(100, 50), Qt::red);
+    surface->attachBuffer(first);
+    surface->damage(QRect(0, 0, 100, 50));
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(frameRenderedSpy.wait());
+    QVERIFY(!first.toStrongRef()->isReleased());
+
+    // no damage is posted, so nothing schedules a new frame
+    frameRenderedSpy.clear();
+    Buffer::Ptr second = createBuffer(QSize(100, 50), Qt::green);
+    surface->attachBuffer(second);
+    surface->commit(Surface::CommitFlag::None);
+    QTRY_VERIFY(first.toStrongRef()->isReleased());
+    QVERIFY(frameRenderedSpy.isEmpty());
+    QVERIFY(!second.toStrongRef()->isReleased());
+}
+
+void GenericBufferReleaseTest::testReleaseOnDestroy()
+{
+    // this test verifies that the last buffer is released when the window is destroyed
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    Buffer::Ptr buffer = createBuffer(QSize(100, 50), Qt::red);
+    surface->attachBuffer(buffer);
+    surface->damage(QRect(0, 0, 100, 50));
+    surface->commit(Surface::CommitFlag::None);
+    QSignalSpy frameRenderedSpy(Compositor::self()->scene(), &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    QVERIFY(frameRenderedSpy.wait());
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(client));
+    QTRY_VERIFY(buffer.toStrongRef()->isReleased());
+}
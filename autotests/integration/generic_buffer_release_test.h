@@ -0,0 +1,34 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+#include "kwin_wayland_test.h"
+
+#include <kwinglobals.h>
+
+#include <QObject>
+
+class GenericBufferReleaseTest : public QObject
+{
+Q_OBJECT
+public:
+    ~GenericBufferReleaseTest() override;
+protected:
+    GenericBufferReleaseTest(const QByteArray &envVariable, KWin::CompositingType compositingType);
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testReleaseOnCommit();
+    void testReleaseOnDestroy();
+
+private:
+    QByteArray m_envVariable;
+    KWin::CompositingType m_compositingType;
+};
@@ -12,6 +12,16 @@
 #include <QRasterWindow>
 #include <QTimer>
 
+static QString clipboardText()
+{
+    // benchmarks ask for a large payload instead of the short test string
+    const int size = qEnvironmentVariableIntValue("KWIN_TEST_CLIPBOARD_SIZE");
+    if (size > 0) {
+        return QString(size, QLatin1Char('a'));
+    }
+    return QStringLiteral("test");
+}
+
 class Window : public QRasterWindow
 {
     Q_OBJECT
@@ -43,7 +53,7 @@ void Window::focusInEvent(QFocusEvent *event)
     QRasterWindow::focusInEvent(event);
     // TODO: make it work without singleshot
     QTimer::singleShot(100,[] {
-        qApp->clipboard()->setText(QStringLiteral("test"));
+        qApp->clipboard()->setText(clipboardText());
     });
 }
 
@@ -0,0 +1,150 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "cursor.h"
+#include "input.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/fakeinput.h>
+#include <KWayland/Client/registry.h>
+
+#include <linux/input.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_input_dispatch-0");
+
+// the number of events injected per benchmark iteration
+static const int s_eventCount = 100;
+
+class InputDispatchTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void benchmarkPointerMotion();
+    void benchmarkPointerAxis();
+    void benchmarkKey();
+
+private:
+    Registry *m_registry = nullptr;
+    FakeInput *m_fakeInput = nullptr;
+};
+
+void InputDispatchTest::initTestCase()
+{
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    Test::initWaylandWorkspace();
+}
+
+void InputDispatchTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+
+    m_registry = new Registry(this);
+    QSignalSpy allAnnounced(m_registry, &Registry::interfacesAnnounced);
+    QVERIFY(allAnnounced.isValid());
+    m_registry->create(Test::waylandConnection());
+    QVERIFY(m_registry->isValid());
+    m_registry->setup();
+    QVERIFY(allAnnounced.wait());
+
+    const auto fakeInputData = m_registry->interface(Registry::Interface::FakeInput);
+    QVERIFY(fakeInputData.name != 0);
+    m_fakeInput = m_registry->createFakeInput(fakeInputData.name, fakeInputData.version, this);
+    QVERIFY(m_fakeInput->isValid());
+    m_fakeInput->authenticate(QStringLiteral("kwin"), QStringLiteral("input dispatch benchmark"));
+
+    // the fake input device is only announced to InputRedirection after the round-trip
+    QSignalSpy deviceAddedSpy(input(), &InputRedirection::deviceAdded);
+    QVERIFY(deviceAddedSpy.isValid());
+    QVERIFY(deviceAddedSpy.wait());
+
+    workspace()->setActiveOutput(QPoint(640, 512));
+    Cursors::self()->mouse()->setPos(QPoint(640, 512));
+}
+
+void InputDispatchTest::cleanup()
+{
+    delete m_fakeInput;
+    m_fakeInput = nullptr;
+    delete m_registry;
+    m_registry = nullptr;
+    Test::destroyWaylandConnection();
+}
+
+void InputDispatchTest::benchmarkPointerMotion()
+{
+    // this benchmark measures how long it takes to send pointer motion events
+    // through all installed input event spies and filters
+    QSignalSpy pointerChangedSpy(input(), &InputRedirection::globalPointerChanged);
+    QVERIFY(pointerChangedSpy.isValid());
+
+    QBENCHMARK {
+        pointerChangedSpy.clear();
+        for (int i = 0; i < s_eventCount; ++i) {
+            m_fakeInput->requestPointerMoveAbsolute(QPointF(100 + i % 2, 100));
+        }
+        Test::flushWaylandConnection();
+        while (pointerChangedSpy.count() < s_eventCount) {
+            QVERIFY(pointerChangedSpy.wait());
+        }
+    }
+}
+
+void InputDispatchTest::benchmarkPointerAxis()
+{
+    QSignalSpy pointerAxisSpy(input(), &InputRedirection::pointerAxisChanged);
+    QVERIFY(pointerAxisSpy.isValid());
+
+    QBENCHMARK {
+        pointerAxisSpy.clear();
+        for (int i = 0; i < s_eventCount; ++i) {
+            m_fakeInput->requestPointerAxis(Qt::Vertical, 10);
+        }
+        Test::flushWaylandConnection();
+        while (pointerAxisSpy.count() < s_eventCount) {
+            QVERIFY(pointerAxisSpy.wait());
+        }
+    }
+}
+
+void InputDispatchTest::benchmarkKey()
+{
+    QSignalSpy keyStateChangedSpy(input(), &InputRedirection::keyStateChanged);
+    QVERIFY(keyStateChangedSpy.isValid());
+
+    QBENCHMARK {
+        keyStateChangedSpy.clear();
+        for (int i = 0; i < s_eventCount / 2; ++i) {
+            m_fakeInput->requestKeyboardKeyPress(KEY_A);
+            m_fakeInput->requestKeyboardKeyRelease(KEY_A);
+        }
+        Test::flushWaylandConnection();
+        while (keyStateChangedSpy.count() < s_eventCount) {
+            QVERIFY(keyStateChangedSpy.wait());
+        }
+    }
+}
+
+WAYLANDTEST_MAIN(InputDispatchTest)
+#include "input_dispatch_test.moc"
@@ -13,6 +13,7 @@
 #include "deleted.h"
 #include "effects.h"
 #include "internal_client.h"
+#include "plugins/qpa/imagepool.h"
 #include "screens.h"
 #include "wayland_server.h"
 #include "workspace.h"
@@ -68,6 +69,7 @@ private Q_SLOTS:
     void testEffectWindow();
     void testReentrantMoveResize();
     void testDismissPopup();
+    void testBackingStoreReuse();
 };
 
 class HelperWindow : public QRasterWindow
@@ -856,6 +858,41 @@ void InternalWindowTest::testDismissPopup()
     QTRY_COMPARE(popupClosedSpy.count(), 1);
 }
 
+void InternalWindowTest::testBackingStoreReuse()
+{
+    // This test verifies that an internal window that is shown and hidden over and over
+    // again, e.g. an on-screen display, reuses the memory of its backing store.
+    QSignalSpy clientAddedSpy(workspace(), &Workspace::internalClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    HelperWindow win;
+    win.setGeometry(0, 0, 100, 100);
+
+    // The first cycles allocate the back buffer and the front buffers.
+    const int warmupCycles = 2;
+    quint64 allocationCount = 0;
+    for (int i = 0; i < warmupCycles + 3; ++i) {
+        win.show();
+        QTRY_COMPARE(clientAddedSpy.count(), i + 1);
+        auto client = clientAddedSpy.last().first().value<InternalClient *>();
+        QVERIFY(client);
+        QSignalSpy windowClosedSpy(client, &InternalClient::windowClosed);
+        QVERIFY(windowClosedSpy.isValid());
+        win.hide();
+        QCOMPARE(windowClosedSpy.count(), 1);
+        auto deleted = windowClosedSpy.first().at(1).value<Deleted *>();
+        QVERIFY(deleted);
+        QSignalSpy deletedDestroyedSpy(deleted, &QObject::destroyed);
+        QVERIFY(deletedDestroyedSpy.isValid());
+        QVERIFY(deletedDestroyedSpy.wait());
+
+        const quint64 count = QPA::ImagePool::self()->allocationCount();
+        if (i >= warmupCycles) {
+            QCOMPARE(count, allocationCount);
+        }
+        allocationCount = count;
+    }
+}
+
 }
 
 WAYLANDTEST_MAIN(KWin::InternalWindowTest)
@@ -0,0 +1,144 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "abstract_output.h"
+#include "composite.h"
+#include "platform.h"
+#include "scene.h"
+#include "surfaceitem.h"
+#include "wayland_server.h"
+#include "windowitem.h"
+#include "workspace.h"
+
+#include <KWayland/Client/surface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_item_repaints-0");
+static const int s_idleWindowCount = 50;
+
+class ItemRepaintsTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testRepaintsAreConsumed();
+    void benchmarkIdleWindows();
+
+private:
+    QVector<AbstractOutput *> repaintOutputs() const;
+};
+
+void ItemRepaintsTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    QVERIFY(Compositor::self());
+}
+
+void ItemRepaintsTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void ItemRepaintsTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+QVector<AbstractOutput *> ItemRepaintsTest::repaintOutputs() const
+{
+    if (kwinApp()->platform()->isPerScreenRenderingEnabled()) {
+        return kwinApp()->platform()->enabledOutputs();
+    }
+    return {nullptr};
+}
+
+void ItemRepaintsTest::testRepaintsAreConsumed()
+{
+    // this test verifies that the repaints scheduled by an item are taken by the next frame,
+    // even though the scene only visits the items that have been marked dirty
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    QSignalSpy frameRenderedSpy(Compositor::self()->scene(), &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+
+    client->surfaceItem()->scheduleRepaint(QRect(0, 0, 10, 10));
+    for (AbstractOutput *output : repaintOutputs()) {
+        if (!output || output->geometry().intersects(client->frameGeometry())) {
+            QVERIFY(!client->surfaceItem()->repaints(output).isEmpty());
+        }
+    }
+
+    QVERIFY(frameRenderedSpy.wait());
+    for (AbstractOutput *output : repaintOutputs()) {
+        QVERIFY(client->windowItem()->repaints(output).isEmpty());
+        QVERIFY(client->surfaceItem()->repaints(output).isEmpty());
+    }
+
+    // the destroyed item must leave the list of dirty items
+    client->surfaceItem()->scheduleRepaint(QRect(0, 0, 10, 10));
+    shellSurface.reset();
+    surface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(client));
+    frameRenderedSpy.clear();
+    Compositor::self()->scene()->addRepaintFull();
+    QVERIFY(frameRenderedSpy.wait());
+}
+
+void ItemRepaintsTest::benchmarkIdleWindows()
+{
+    // this benchmark measures the frame time with many idle windows and a single window
+    // that updates its contents every frame
+    QVector<Surface *> surfaces;
+    QVector<Test::XdgToplevel *> shellSurfaces;
+    for (int i = 0; i < s_idleWindowCount; ++i) {
+        Surface *surface = Test::createSurface();
+        Test::XdgToplevel *shellSurface = Test::createXdgToplevelSurface(surface);
+        QVERIFY(Test::renderAndWaitForShown(surface, QSize(100, 50), Qt::blue));
+        surfaces.append(surface);
+        shellSurfaces.append(shellSurface);
+    }
+
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::red);
+    QVERIFY(client);
+
+    QSignalSpy frameRenderedSpy(Compositor::self()->scene(), &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+
+    int frame = 0;
+    QBENCHMARK {
+        Test::render(surface.data(), QSize(100, 50), frame % 2 ? Qt::red : Qt::green);
+        QVERIFY(frameRenderedSpy.wait());
+        ++frame;
+    }
+
+    qDeleteAll(shellSurfaces);
+    qDeleteAll(surfaces);
+}
+
+WAYLANDTEST_MAIN(ItemRepaintsTest)
+#include "item_repaints_test.moc"
@@ -0,0 +1,173 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "cursor.h"
+#include "input.h"
+#include "input_event.h"
+#include "input_event_spy.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWaylandServer/keyboard_interface.h>
+#include <KWaylandServer/seat_interface.h>
+
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include <linux/input.h>
+
+using namespace KWin;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_keyboard_repeat-0");
+
+// repeat rate of 25 per second, that is one repeat every 40 ms
+static const int s_repeatRate = 25;
+static const int s_repeatInterval = 1000 / s_repeatRate;
+static const int s_repeatDelay = 300;
+
+class RepeatRecorder : public InputEventSpy
+{
+public:
+    InputEventTypes eventTypes() const override
+    {
+        return KeyInputEvent;
+    }
+
+    void keyEvent(KeyEvent *event) override
+    {
+        if (event->isAutoRepeat()) {
+            timestamps << event->timestamp();
+            arrivals << clock.elapsed();
+        }
+    }
+
+    QElapsedTimer clock;
+    QVector<quint32> timestamps;
+    QVector<qint64> arrivals;
+};
+
+class KeyboardRepeatTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testRepeatTimestamps();
+    void testRepeatUnderLoad_data();
+    void testRepeatUnderLoad();
+
+private:
+    RepeatRecorder *m_recorder = nullptr;
+};
+
+void KeyboardRepeatTest::initTestCase()
+{
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+    Test::initWaylandWorkspace();
+}
+
+void KeyboardRepeatTest::init()
+{
+    workspace()->setActiveOutput(QPoint(640, 512));
+    Cursors::self()->mouse()->setPos(QPoint(640, 512));
+    waylandServer()->seat()->keyboard()->setRepeatInfo(s_repeatRate, s_repeatDelay);
+
+    m_recorder = new RepeatRecorder;
+    input()->installInputEventSpy(m_recorder);
+}
+
+void KeyboardRepeatTest::cleanup()
+{
+    input()->uninstallInputEventSpy(m_recorder);
+    delete m_recorder;
+    m_recorder = nullptr;
+}
+
+void KeyboardRepeatTest::testRepeatTimestamps()
+{
+    // this test verifies that repeats carry the time at which they were due
+    // and that they stop as soon as the key is released
+    quint32 timestamp = 1000;
+    m_recorder->clock.start();
+    kwinApp()->platform()->keyboardKeyPressed(KEY_A, timestamp);
+    QTRY_VERIFY_WITH_TIMEOUT(m_recorder->timestamps.count() >= 5, 2000);
+    kwinApp()->platform()->keyboardKeyReleased(KEY_A, timestamp + 1000);
+
+    const int count = m_recorder->timestamps.count();
+    QTest::qWait(2 * s_repeatInterval);
+    QCOMPARE(m_recorder->timestamps.count(), count);
+
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(m_recorder->timestamps[i], timestamp + s_repeatDelay + i * s_repeatInterval);
+    }
+}
+
+void KeyboardRepeatTest::testRepeatUnderLoad_data()
+{
+    QTest::addColumn<int>("load");
+
+    QTest::newRow("idle") << 0;
+    QTest::newRow("10 ms frames") << 10;
+    QTest::newRow("30 ms frames") << 30;
+}
+
+void KeyboardRepeatTest::testRepeatUnderLoad()
+{
+    // this test verifies that slow frames blocking the main thread neither shift the repeat
+    // schedule nor lose or duplicate repeats
+    QFETCH(int, load);
+    QTimer frameTimer;
+    frameTimer.setInterval(50);
+    connect(&frameTimer, &QTimer::timeout, this, [load] {
+        QElapsedTimer frame;
+        frame.start();
+        while (frame.elapsed() < load) {
+        }
+    });
+    if (load > 0) {
+        frameTimer.start();
+    }
+
+    const int repeatCount = 20;
+    quint32 timestamp = 1000;
+    m_recorder->clock.start();
+    kwinApp()->platform()->keyboardKeyPressed(KEY_A, timestamp);
+    QTRY_VERIFY_WITH_TIMEOUT(m_recorder->timestamps.count() >= repeatCount, 5000);
+    const qint64 released = m_recorder->clock.elapsed();
+    kwinApp()->platform()->keyboardKeyReleased(KEY_A, timestamp + 5000);
+    frameTimer.stop();
+
+    const int count = m_recorder->timestamps.count();
+    QTest::qWait(2 * s_repeatInterval);
+    QCOMPARE(m_recorder->timestamps.count(), count);
+    // no more repeats than were due until the key got released
+    QVERIFY(count <= (released - s_repeatDelay) / s_repeatInterval + 1);
+
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(m_recorder->timestamps[i], timestamp + s_repeatDelay + i * s_repeatInterval);
+        // a repeat is never delivered before it's due
+        QVERIFY(m_recorder->arrivals[i] >= s_repeatDelay + i * s_repeatInterval);
+        if (i > 0) {
+            QVERIFY(m_recorder->arrivals[i] >= m_recorder->arrivals[i - 1]);
+        }
+    }
+}
+
+WAYLANDTEST_MAIN(KeyboardRepeatTest)
+#include "keyboard_repeat_test.moc"
@@ -11,6 +11,7 @@
 #include "composite.h"
 #include "effects.h"
 #include "inputmethod.h"
+#include "options.h"
 #include "platform.h"
 #include "pluginmanager.h"
 #include "wayland_server.h"
@@ -159,6 +160,11 @@ void WaylandTestApplication::continueStartupWithScene()
     }
 
     m_xwayland = new Xwl::Xwayland(this);
+    if (options->xwaylandStartOnDemand()) {
+        m_xwayland->start(Xwl::Xwayland::StartMode::OnDemand);
+        finalizeStartup();
+        return;
+    }
     connect(m_xwayland, &Xwl::Xwayland::errorOccurred, this, &WaylandTestApplication::finalizeStartup);
     connect(m_xwayland, &Xwl::Xwayland::started, this, &WaylandTestApplication::finalizeStartup);
     m_xwayland->start();
@@ -7,6 +7,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "kwin_wayland_test.h"
+#include "abstract_client.h"
 #include "composite.h"
 #include "effectloader.h"
 #include "x11client.h"
@@ -42,6 +43,8 @@ private Q_SLOTS:
     void testCursorMoving();
     void testWindow();
     void testWindowScaled();
+    void testTranslucentWindow();
+    void benchmarkTranslucentWindows();
     void testCompositorRestart();
     void testX11Window();
 };
@@ -235,6 +238,71 @@ void SceneQPainterTest::testWindowScaled()
     QCOMPARE(referenceImage, *scene->qpainterRenderBuffer(outputs.constFirst()));
 }
 
+void SceneQPainterTest::testTranslucentWindow()
+{
+    // this test verifies that translucent windows are blended correctly, also where the
+    // window spans several tiles
+    KWin::Cursors::self()->mouse()->setPos(1000, 1000);
+    QVERIFY(Test::setupWaylandConnection());
+    QScopedPointer<KWayland::Client::Surface> s(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> ss(Test::createXdgToplevelSurface(s.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(s.data(), QSize(300, 200), Qt::blue);
+    QVERIFY(client);
+    QCOMPARE(client->frameGeometry(), QRect(0, 0, 300, 200));
+
+    auto scene = KWin::Compositor::self()->scene();
+    QVERIFY(scene);
+    QSignalSpy frameRenderedSpy(scene, &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+    client->setOpacity(0.5);
+    QVERIFY(frameRenderedSpy.wait());
+
+    QImage referenceImage(QSize(300, 200), QImage::Format_RGB32);
+    referenceImage.fill(QColor(0, 0, 128));
+    const auto outputs = kwinApp()->platform()->enabledOutputs();
+    QCOMPARE(scene->qpainterRenderBuffer(outputs.constFirst())->copy(QRect(0, 0, 300, 200)), referenceImage);
+}
+
+void SceneQPainterTest::benchmarkTranslucentWindows()
+{
+    // this benchmark measures the frame time with a few translucent panels stacked above
+    // a window that updates its contents every frame
+    KWin::Cursors::self()->mouse()->setPos(1000, 1000);
+    QVERIFY(Test::setupWaylandConnection());
+    QScopedPointer<KWayland::Client::Surface> s(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> ss(Test::createXdgToplevelSurface(s.data()));
+    AbstractClient *client = Test::renderAndWaitForShown(s.data(), QSize(1280, 1024), Qt::blue);
+    QVERIFY(client);
+
+    QVector<KWayland::Client::Surface *> panelSurfaces;
+    QVector<Test::XdgToplevel *> panelShellSurfaces;
+    for (int i = 0; i < 3; ++i) {
+        KWayland::Client::Surface *surface = Test::createSurface();
+        Test::XdgToplevel *shellSurface = Test::createXdgToplevelSurface(surface);
+        AbstractClient *panel = Test::renderAndWaitForShown(surface, QSize(1280, 48), QColor(0, 0, 0, 128));
+        QVERIFY(panel);
+        panel->move(QPoint(0, i * 400));
+        panel->setOpacity(0.8);
+        panelSurfaces.append(surface);
+        panelShellSurfaces.append(shellSurface);
+    }
+
+    auto scene = KWin::Compositor::self()->scene();
+    QVERIFY(scene);
+    QSignalSpy frameRenderedSpy(scene, &Scene::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+
+    int frame = 0;
+    QBENCHMARK {
+        Test::render(s.data(), QSize(1280, 1024), frame % 2 ? Qt::blue : Qt::green);
+        QVERIFY(frameRenderedSpy.wait());
+        ++frame;
+    }
+
+    qDeleteAll(panelShellSurfaces);
+    qDeleteAll(panelSurfaces);
+}
+
 void SceneQPainterTest::testCompositorRestart()
 {
     // this test verifies that the compositor/SceneQPainter survive a restart of the compositor and still render correctly
@@ -0,0 +1,234 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "kwin_wayland_test.h"
+
+#include "abstract_client.h"
+#include "platform.h"
+#include "surfaceitem_wayland.h"
+#include "wayland_server.h"
+#include "workspace.h"
+
+#include <KWayland/Client/subsurface.h>
+#include <KWayland/Client/surface.h>
+
+#include <KWaylandServer/surface_interface.h>
+
+using namespace KWin;
+using namespace KWayland::Client;
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_subsurface-0");
+
+// the number of subsurfaces a browser or a video player with a busy page may have
+static const int s_subSurfaceCount = 100;
+
+class SubSurfaceTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testStackingOrder();
+    void testRestackAfterDestroy();
+    void benchmarkCommit_data();
+    void benchmarkCommit();
+};
+
+void SubSurfaceTest::initTestCase()
+{
+    qRegisterMetaType<KWin::AbstractClient *>();
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+}
+
+void SubSurfaceTest::init()
+{
+    QVERIFY(Test::setupWaylandConnection());
+}
+
+void SubSurfaceTest::cleanup()
+{
+    Test::destroyWaylandConnection();
+}
+
+static QList<KWaylandServer::SurfaceInterface *> stackedSurfaces(Item *item)
+{
+    QList<KWaylandServer::SurfaceInterface *> surfaces;
+    const QList<Item *> childItems = item->sortedChildItems();
+    for (Item *childItem : childItems) {
+        surfaces.append(static_cast<SurfaceItemWayland *>(childItem)->surface());
+    }
+    return surfaces;
+}
+
+void SubSurfaceTest::testStackingOrder()
+{
+    // this test verifies that the subsurface items follow the stacking order of the subsurfaces
+    QScopedPointer<Surface> parentSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(parentSurface.data()));
+
+    QVector<Surface *> surfaces;
+    QVector<SubSurface *> subSurfaces;
+    for (int i = 0; i < 4; ++i) {
+        Surface *surface = Test::createSurface(parentSurface.data());
+        subSurfaces.append(Test::createSubSurface(surface, parentSurface.data(), surface));
+        Test::render(surface, QSize(10, 10), Qt::red);
+        surfaces.append(surface);
+    }
+    AbstractClient *client = Test::renderAndWaitForShown(parentSurface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    KWaylandServer::SurfaceInterface *serverSurface = client->surface();
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+    QVERIFY(committedSpy.isValid());
+
+    auto commitAndCheck = [&]() {
+        parentSurface->commit(Surface::CommitFlag::None);
+        QVERIFY(committedSpy.wait());
+        const auto expected = serverSurface->below() + serverSurface->above();
+        QList<KWaylandServer::SurfaceInterface *> expectedSurfaces;
+        for (auto subSurface : expected) {
+            expectedSurfaces.append(subSurface->surface());
+        }
+        QCOMPARE(stackedSurfaces(client->surfaceItem()), expectedSurfaces);
+    };
+
+    commitAndCheck();
+
+    // raise the bottom-most subsurface
+    subSurfaces[0]->raise();
+    commitAndCheck();
+
+    // move a subsurface below the parent
+    subSurfaces[2]->lower();
+    commitAndCheck();
+
+    // move it back into the middle of the subsurfaces above the parent
+    subSurfaces[2]->placeAbove(subSurfaces[1]);
+    commitAndCheck();
+
+    // destroy a subsurface in the middle and add a new one
+    delete subSurfaces.takeAt(1);
+    Surface *surface = Test::createSurface(parentSurface.data());
+    subSurfaces.append(Test::createSubSurface(surface, parentSurface.data(), surface));
+    Test::render(surface, QSize(10, 10), Qt::green);
+    commitAndCheck();
+}
+
+void SubSurfaceTest::testRestackAfterDestroy()
+{
+    // this test verifies that destroying a subsurface doesn't leave stale stacking information
+    // behind that a following restack relies on
+    QScopedPointer<Surface> parentSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(parentSurface.data()));
+
+    // the subsurfaces are created in the order q, x, p, y
+    QVector<SubSurface *> subSurfaces;
+    for (int i = 0; i < 4; ++i) {
+        Surface *surface = Test::createSurface(parentSurface.data());
+        subSurfaces.append(Test::createSubSurface(surface, parentSurface.data(), surface));
+        Test::render(surface, QSize(10, 10), Qt::red);
+    }
+    SubSurface *q = subSurfaces[0];
+    SubSurface *x = subSurfaces[1];
+    SubSurface *p = subSurfaces[2];
+    AbstractClient *client = Test::renderAndWaitForShown(parentSurface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+
+    KWaylandServer::SurfaceInterface *serverSurface = client->surface();
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+    QVERIFY(committedSpy.isValid());
+
+    auto commitAndCheck = [&]() {
+        parentSurface->commit(Surface::CommitFlag::None);
+        QVERIFY(committedSpy.wait());
+        const auto expected = serverSurface->below() + serverSurface->above();
+        QList<KWaylandServer::SurfaceInterface *> expectedSurfaces;
+        for (auto subSurface : expected) {
+            expectedSurfaces.append(subSurface->surface());
+        }
+        QCOMPARE(stackedSurfaces(client->surfaceItem()), expectedSurfaces);
+    };
+
+    // x, p, y, q
+    q->raise();
+    commitAndCheck();
+
+    // destroy x and restack q right above p, q must end up above p although it's older
+    subSurfaces.removeOne(x);
+    delete x;
+    q->placeAbove(p);
+    commitAndCheck();
+
+    // the same below the parent
+    for (SubSurface *subSurface : qAsConst(subSurfaces)) {
+        subSurface->lower();
+    }
+    commitAndCheck();
+    delete subSurfaces.takeLast();
+    q->placeBelow(p);
+    commitAndCheck();
+}
+
+void SubSurfaceTest::benchmarkCommit_data()
+{
+    QTest::addColumn<bool>("restack");
+
+    QTest::newRow("commit") << false;
+    QTest::newRow("commit and restack") << true;
+}
+
+void SubSurfaceTest::benchmarkCommit()
+{
+    // this benchmark measures how long it takes to apply a frame in which all subsurfaces
+    // of a window have been updated, every iteration corresponds to one frame of a video
+    // player or a browser that updates all of its subsurfaces at 60Hz
+    QScopedPointer<Surface> parentSurface(Test::createSurface());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(parentSurface.data()));
+
+    QVector<Surface *> surfaces;
+    QVector<SubSurface *> subSurfaces;
+    for (int i = 0; i < s_subSurfaceCount; ++i) {
+        Surface *surface = Test::createSurface(parentSurface.data());
+        SubSurface *subSurface = Test::createSubSurface(surface, parentSurface.data(), surface);
+        subSurface->setPosition(QPoint(i % 10 * 10, i / 10 * 10));
+        Test::render(surface, QSize(10, 10), Qt::red);
+        surfaces.append(surface);
+        subSurfaces.append(subSurface);
+    }
+    AbstractClient *client = Test::renderAndWaitForShown(parentSurface.data(), QSize(100, 100), Qt::blue);
+    QVERIFY(client);
+
+    QSignalSpy committedSpy(client->surface(), &KWaylandServer::SurfaceInterface::committed);
+    QVERIFY(committedSpy.isValid());
+
+    QFETCH(bool, restack);
+    int frame = 0;
+    QBENCHMARK {
+        for (Surface *surface : qAsConst(surfaces)) {
+            surface->damage(QRect(0, 0, 10, 10));
+            surface->commit(Surface::CommitFlag::None);
+        }
+        if (restack) {
+            subSurfaces[frame % s_subSurfaceCount]->raise();
+        }
+        parentSurface->commit(Surface::CommitFlag::None);
+        QVERIFY(committedSpy.wait());
+        ++frame;
+    }
+}
+
+WAYLANDTEST_MAIN(SubSurfaceTest)
+#include "subsurface_test.moc"
@@ -138,6 +138,10 @@ private Q_SLOTS:
     void testNoBorderForceTemporarily();
 
     void testMatchAfterNameChange();
+    void testMatchCacheInvalidation();
+
+    void benchmarkMatchRules_data();
+    void benchmarkMatchRules();
 
 private:
     template <typename T> void setWindowRule(const QString &property, const T &value, int policy);
@@ -3710,5 +3714,94 @@ void TestXdgShellClientRules::testMatchAfterNameChange()
     QCOMPARE(c->keepAbove(), true);
 }
 
+void TestXdgShellClientRules::testMatchCacheInvalidation()
+{
+    setWindowRule("above", true, int(Rules::Force));
+
+    AbstractClient *client;
+    KWayland::Client::Surface *surface;
+    Test::XdgToplevel *shellSurface;
+    std::tie(client, surface, shellSurface) = createWindow(QStringLiteral("org.kde.foo"));
+    QVERIFY(client);
+    QVERIFY(client->keepAbove());
+    QVERIFY(client->rules()->checkKeepAbove(false));
+
+    // Change the rule so it doesn't match the window anymore.
+    KConfigGroup group = m_config->group("1");
+    group.writeEntry("wmclass", "org.kde.bar");
+    group.sync();
+    workspace()->slotReconfigure();
+    QVERIFY(!client->rules()->checkKeepAbove(false));
+
+    // Change the window so it matches the changed rule.
+    QSignalSpy desktopFileNameSpy(client, &AbstractClient::desktopFileNameChanged);
+    QVERIFY(desktopFileNameSpy.isValid());
+    shellSurface->set_app_id(QStringLiteral("org.kde.bar"));
+    QVERIFY(desktopFileNameSpy.wait());
+    QVERIFY(client->rules()->checkKeepAbove(false));
+
+    // And back, the match cached for the old window class must not be used.
+    shellSurface->set_app_id(QStringLiteral("org.kde.foo"));
+    QVERIFY(desktopFileNameSpy.wait());
+    QVERIFY(!client->rules()->checkKeepAbove(false));
+
+    delete shellSurface;
+    delete surface;
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
+void TestXdgShellClientRules::benchmarkMatchRules_data()
+{
+    QTest::addColumn<int>("ruleCount");
+
+    QTest::newRow("10 rules") << 10;
+    QTest::newRow("50 rules") << 50;
+    QTest::newRow("200 rules") << 200;
+}
+
+void TestXdgShellClientRules::benchmarkMatchRules()
+{
+    // Build a synthetic rule book where a third of the rules match the window class exactly,
+    // a third use a regular expression and the remaining ones match the caption.
+    QFETCH(int, ruleCount);
+    m_config->group("General").writeEntry("count", ruleCount);
+    for (int i = 1; i <= ruleCount; ++i) {
+        KConfigGroup group = m_config->group(QString::number(i));
+        group.writeEntry("above", true);
+        group.writeEntry("aboverule", int(Rules::Force));
+        switch (i % 3) {
+        case 0:
+            group.writeEntry("wmclass", QStringLiteral("org.kde.app%1").arg(i));
+            group.writeEntry("wmclassmatch", int(Rules::ExactMatch));
+            break;
+        case 1:
+            group.writeEntry("wmclass", QStringLiteral("^org\\.kde\\.app%1$").arg(i));
+            group.writeEntry("wmclassmatch", int(Rules::RegExpMatch));
+            break;
+        case 2:
+            group.writeEntry("title", QStringLiteral("^Document %1 - .*$").arg(i));
+            group.writeEntry("titlematch", int(Rules::RegExpMatch));
+            break;
+        }
+    }
+    m_config->sync();
+    workspace()->slotReconfigure();
+
+    AbstractClient *client;
+    KWayland::Client::Surface *surface;
+    Test::XdgToplevel *shellSurface;
+    std::tie(client, surface, shellSurface) = createWindow(QStringLiteral("org.kde.foo"));
+    QVERIFY(client);
+
+    QBENCHMARK {
+        const WindowRules rules = RuleBook::self()->find(client, true);
+        Q_UNUSED(rules)
+    }
+
+    delete shellSurface;
+    delete surface;
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
 WAYLANDTEST_MAIN(TestXdgShellClientRules)
 #include "xdgshellclient_rules_test.moc"
@@ -41,6 +41,11 @@ private Q_SLOTS:
     void initTestCase();
     void testSync_data();
     void testSync();
+    void benchmarkLargeTransfer_data();
+    void benchmarkLargeTransfer();
+
+private:
+    void syncClipboard(const QString &copyPlatform, const QString &pastePlatform, int size);
 };
 
 void XwaylandSelectionsTest::initTestCase()
@@ -81,6 +86,37 @@ void XwaylandSelectionsTest::testSync_data()
 void XwaylandSelectionsTest::testSync()
 {
     // this test verifies the syncing of X11 to Wayland clipboard
+    QFETCH(QString, copyPlatform);
+    QFETCH(QString, pastePlatform);
+    syncClipboard(copyPlatform, pastePlatform, 0);
+}
+
+void XwaylandSelectionsTest::benchmarkLargeTransfer_data()
+{
+    QTest::addColumn<QString>("copyPlatform");
+    QTest::addColumn<QString>("pastePlatform");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("x11->wayland 1MB") << QStringLiteral("xcb") << QStringLiteral("wayland") << (1 << 20);
+    QTest::newRow("wayland->x11 1MB") << QStringLiteral("wayland") << QStringLiteral("xcb") << (1 << 20);
+    QTest::newRow("x11->wayland 64MB") << QStringLiteral("xcb") << QStringLiteral("wayland") << (64 << 20);
+    QTest::newRow("wayland->x11 64MB") << QStringLiteral("wayland") << QStringLiteral("xcb") << (64 << 20);
+}
+
+void XwaylandSelectionsTest::benchmarkLargeTransfer()
+{
+    // this benchmark measures how long it takes to paste a large clipboard payload,
+    // including the startup of the paste process
+    QFETCH(QString, copyPlatform);
+    QFETCH(QString, pastePlatform);
+    QFETCH(int, size);
+    QBENCHMARK_ONCE {
+        syncClipboard(copyPlatform, pastePlatform, size);
+    }
+}
+
+void XwaylandSelectionsTest::syncClipboard(const QString &copyPlatform, const QString &pastePlatform, int size)
+{
     const QString copy = QFINDTESTDATA(QStringLiteral("copy"));
     QVERIFY(!copy.isEmpty());
     const QString paste = QFINDTESTDATA(QStringLiteral("paste"));
@@ -92,9 +128,11 @@ void XwaylandSelectionsTest::testSync()
     QVERIFY(clipboardChangedSpy.isValid());
 
     QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    if (size > 0) {
+        environment.insert(QStringLiteral("KWIN_TEST_CLIPBOARD_SIZE"), QString::number(size));
+    }
 
     // start the copy process
-    QFETCH(QString, copyPlatform);
     environment.insert(QStringLiteral("QT_QPA_PLATFORM"), copyPlatform);
     environment.insert(QStringLiteral("WAYLAND_DISPLAY"), s_socketName);
     QScopedPointer<QProcess, ProcessKillBeforeDeleter> copyProcess(new QProcess());
@@ -118,7 +156,6 @@ void XwaylandSelectionsTest::testSync()
     QScopedPointer<QProcess, ProcessKillBeforeDeleter> pasteProcess(new QProcess());
     QSignalSpy finishedSpy(pasteProcess.data(), static_cast<void(QProcess::*)(int,QProcess::ExitStatus)>(&QProcess::finished));
     QVERIFY(finishedSpy.isValid());
-    QFETCH(QString, pastePlatform);
     environment.insert(QStringLiteral("QT_QPA_PLATFORM"), pastePlatform);
     pasteProcess->setProcessEnvironment(environment);
     pasteProcess->setProcessChannelMode(QProcess::ForwardedChannels);
@@ -140,7 +177,8 @@ void XwaylandSelectionsTest::testSync()
         QVERIFY(clientActivatedSpy.wait());
     }
     QTRY_COMPARE(workspace()->activeClient(), pasteClient);
-    QVERIFY(finishedSpy.wait());
+    // large payloads take a while to be transferred
+    QVERIFY(finishedSpy.wait(size > 0 ? 60000 : 5000));
     QCOMPARE(finishedSpy.first().first().toInt(), 0);
 }
 
@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+#include "main.h"
+#include "platform.h"
+#include "wayland_server.h"
+#include "xwl/xwayland.h"
+
+#include <QtConcurrentRun>
+
+namespace KWin
+{
+
+struct XcbConnectionDeleter
+{
+    static inline void cleanup(xcb_connection_t *pointer)
+    {
+        xcb_disconnect(pointer);
+    }
+};
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_xwayland_server_ondemand-0");
+
+class XwaylandServerOnDemandTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testStartOnDemand();
+};
+
+void XwaylandServerOnDemandTest::initTestCase()
+{
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup xwaylandGroup = config->group("Xwayland");
+    xwaylandGroup.writeEntry(QStringLiteral("XwaylandStartOnDemand"), true);
+    xwaylandGroup.sync();
+    kwinApp()->setConfig(config);
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+}
+
+void XwaylandServerOnDemandTest::testStartOnDemand()
+{
+    // This test verifies that the Xwayland server is spawned when the first X11 client connects.
+
+    Xwl::Xwayland *xwayland = static_cast<Xwl::Xwayland *>(XwaylandInterface::self());
+
+    // The compositor has started, but Xwayland is not running yet.
+    QVERIFY(!xwayland->process());
+    QVERIFY(!kwinApp()->x11Connection());
+    QVERIFY(!qEnvironmentVariableIsEmpty("DISPLAY"));
+
+    // xcb_connect() blocks until the server replies, so connect from another thread.
+    QSignalSpy startedSpy(xwayland, &Xwl::Xwayland::started);
+    QVERIFY(startedSpy.isValid());
+    QFuture<xcb_connection_t *> future = QtConcurrent::run([]() {
+        return xcb_connect(nullptr, nullptr);
+    });
+    QVERIFY(startedSpy.wait());
+    QVERIFY(xwayland->process());
+    QVERIFY(kwinApp()->x11Connection());
+
+    QTRY_VERIFY(future.isFinished());
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(future.result());
+    QVERIFY(!xcb_connection_has_error(c.data()));
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::XwaylandServerOnDemandTest)
+#include "xwaylandserver_ondemand_test.moc"
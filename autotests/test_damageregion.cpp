@@ -0,0 +1,180 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "utils/damageregion.h"
+
+using namespace KWin;
+
+class TestDamageRegion : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testContainment();
+    void testAdjacentRectsAreMerged();
+    void testSimplify();
+    void testIntersected();
+    void testTranslated();
+
+    void benchmarkDamageRegion_data();
+    void benchmarkDamageRegion();
+    void benchmarkRegion_data();
+    void benchmarkRegion();
+
+private:
+    void addTraces();
+};
+
+void TestDamageRegion::testEmpty()
+{
+    DamageRegion region;
+    QVERIFY(region.isEmpty());
+    QCOMPARE(region.rectCount(), 0);
+    QCOMPARE(region.boundingRect(), QRect());
+    QVERIFY(region.toRegion().isEmpty());
+
+    region += QRect(10, 10, 0, 10);
+    QVERIFY(region.isEmpty());
+}
+
+void TestDamageRegion::testContainment()
+{
+    DamageRegion region;
+    region += QRect(0, 0, 100, 100);
+    region += QRect(10, 10, 10, 10);
+    QCOMPARE(region.rects(), QVector<QRect>{QRect(0, 0, 100, 100)});
+
+    // a bigger rect replaces all the rects it contains
+    region += QRect(200, 0, 10, 10);
+    region += QRect(-10, -10, 300, 300);
+    QCOMPARE(region.rects(), QVector<QRect>{QRect(-10, -10, 300, 300)});
+}
+
+void TestDamageRegion::testAdjacentRectsAreMerged()
+{
+    // this is what a scrolling terminal looks like
+    DamageRegion region;
+    for (int i = 0; i < 40; ++i) {
+        region += QRect(0, i * 16, 800, 16);
+    }
+    QCOMPARE(region.rects(), QVector<QRect>{QRect(0, 0, 800, 640)});
+    QCOMPARE(region.toRegion(), QRegion(0, 0, 800, 640));
+}
+
+void TestDamageRegion::testSimplify()
+{
+    DamageRegion region(4);
+    QRegion expected;
+    for (int i = 0; i < 10; ++i) {
+        const QRect rect(i * 50, (i % 3) * 100, 20, 20);
+        region += rect;
+        expected += rect;
+    }
+    QVERIFY(region.rectCount() <= 4);
+    QCOMPARE(region.boundingRect(), expected.boundingRect());
+    // the simplified region may be bigger, but it must never lose damage
+    QVERIFY((expected - region.toRegion()).isEmpty());
+
+    // lowering the limit simplifies the region right away
+    region.setMaxRectCount(1);
+    QCOMPARE(region.rects(), QVector<QRect>{expected.boundingRect()});
+}
+
+void TestDamageRegion::testIntersected()
+{
+    DamageRegion region;
+    region += QRect(0, 0, 100, 100);
+    region += QRect(1000, 0, 100, 100);
+
+    const DamageRegion left = region.intersected(QRect(50, 50, 500, 500));
+    QCOMPARE(left.rects(), QVector<QRect>{QRect(50, 50, 50, 50)});
+    QVERIFY(region.intersected(QRect(200, 0, 100, 100)).isEmpty());
+}
+
+void TestDamageRegion::testTranslated()
+{
+    DamageRegion region;
+    region += QRect(0, 0, 10, 10);
+    region += QRect(50, 50, 10, 10);
+
+    const DamageRegion translated = region.translated(QPoint(5, -5));
+    QCOMPARE(translated.toRegion(), region.toRegion().translated(5, -5));
+    QCOMPARE(translated.boundingRect(), QRect(5, -5, 60, 60));
+}
+
+void TestDamageRegion::addTraces()
+{
+    QTest::addColumn<QVector<QRect>>("trace");
+
+    QVector<QRect> terminal;
+    for (int frame = 0; frame < 10; ++frame) {
+        for (int line = 0; line < 50; ++line) {
+            terminal.append(QRect(0, line * 18, 1200, 18));
+        }
+        terminal.append(QRect(4, 49 * 18, 9, 18)); // the cursor
+    }
+    QTest::newRow("terminal") << terminal;
+
+    QVector<QRect> spinner;
+    for (int frame = 0; frame < 200; ++frame) {
+        spinner.append(QRect(600, 400, 32, 32));
+        spinner.append(QRect(620 + (frame % 8) * 4, 440, 4, 14)); // progress label
+    }
+    QTest::newRow("spinner") << spinner;
+
+    QVector<QRect> scattered;
+    QRandomGenerator generator(42);
+    for (int i = 0; i < 400; ++i) {
+        scattered.append(QRect(generator.bounded(1900), generator.bounded(1060),
+                               generator.bounded(1, 64), generator.bounded(1, 64)));
+    }
+    QTest::newRow("scattered") << scattered;
+}
+
+void TestDamageRegion::benchmarkDamageRegion_data()
+{
+    addTraces();
+}
+
+void TestDamageRegion::benchmarkDamageRegion()
+{
+    QFETCH(QVector<QRect>, trace);
+
+    QBENCHMARK {
+        DamageRegion region;
+        for (const QRect &rect : qAsConst(trace)) {
+            region += rect;
+        }
+        region.intersected(QRect(0, 0, 1920, 1080)).toRegion();
+    }
+}
+
+void TestDamageRegion::benchmarkRegion_data()
+{
+    addTraces();
+}
+
+void TestDamageRegion::benchmarkRegion()
+{
+    QFETCH(QVector<QRect>, trace);
+
+    QBENCHMARK {
+        QRegion region;
+        for (const QRect &rect : qAsConst(trace)) {
+            region += rect;
+        }
+        region &= QRect(0, 0, 1920, 1080);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestDamageRegion)
+#include "test_damageregion.moc"
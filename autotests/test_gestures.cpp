@@ -11,7 +11,12 @@
 #include <QTest>
 #include <QSignalSpy>
 
+#include <functional>
+
 using namespace KWin;
+using namespace std::chrono_literals;
+
+Q_DECLARE_METATYPE(std::function<qreal(qreal)>)
 
 class GestureTest : public QObject
 {
@@ -50,6 +55,10 @@ private Q_SLOTS:
     void testSwipeGeometryStart();
     void testSwipeDiagonalCancels_data();
     void testSwipeDiagonalCancels();
+    void testResamplerOneUpdatePerFrame();
+    void testResamplerPrediction();
+    void benchmarkResampler_data();
+    void benchmarkResampler();
 };
 
 void GestureTest::testSwipeMinFinger_data()
@@ -600,5 +609,160 @@ void GestureTest::testSwipeDiagonalCancels()
 
 }
 
+void GestureTest::testResamplerOneUpdatePerFrame()
+{
+    GestureProgressResampler resampler;
+    resampler.setPredictionEnabled(false);
+    QSignalSpy progressSpy(&resampler, &GestureProgressResampler::progress);
+    QVERIFY(progressSpy.isValid());
+
+    // without any update there is nothing to emit
+    resampler.frame(16ms);
+    QCOMPARE(progressSpy.count(), 0);
+
+    // several updates between two frames result in a single update with the latest progress
+    resampler.addSample(0.1, 20ms);
+    resampler.addSample(0.2, 24ms);
+    resampler.addSample(0.3, 28ms);
+    QVERIFY(resampler.hasPendingUpdate());
+    resampler.frame(33ms);
+    QCOMPARE(progressSpy.count(), 1);
+    QCOMPARE(progressSpy.last().first().value<qreal>(), 0.3);
+    QVERIFY(!resampler.hasPendingUpdate());
+    resampler.frame(50ms);
+    QCOMPARE(progressSpy.count(), 1);
+
+    // flushing only emits if there is something left
+    resampler.flush();
+    QCOMPARE(progressSpy.count(), 1);
+    resampler.addSample(0.4, 52ms);
+    resampler.flush();
+    QCOMPARE(progressSpy.count(), 2);
+    QCOMPARE(progressSpy.last().first().value<qreal>(), 0.4);
+}
+
+void GestureTest::testResamplerPrediction()
+{
+    GestureProgressResampler resampler;
+    QSignalSpy progressSpy(&resampler, &GestureProgressResampler::progress);
+    QVERIFY(progressSpy.isValid());
+
+    // a single sample doesn't provide a velocity
+    resampler.addSample(0.1, 10ms);
+    QCOMPARE(resampler.predictedProgress(20ms), 0.1);
+
+    // progress of 0.1 per 10 ms
+    resampler.addSample(0.2, 20ms);
+    QCOMPARE(resampler.predictedProgress(20ms), 0.2);
+    QCOMPARE(resampler.predictedProgress(30ms), 0.3);
+    // the prediction is limited in time
+    QCOMPARE(resampler.predictedProgress(100ms), resampler.predictedProgress(45ms));
+    // and the result stays in the valid range
+    resampler.addSample(0.9, 30ms);
+    QCOMPARE(resampler.predictedProgress(50ms), 1.0);
+
+    resampler.frame(40ms);
+    QCOMPARE(progressSpy.count(), 1);
+    QCOMPARE(progressSpy.last().first().value<qreal>(), 1.0);
+
+    resampler.reset();
+    QVERIFY(!resampler.hasPendingUpdate());
+    QCOMPARE(resampler.predictedProgress(50ms), 0.0);
+}
+
+struct ResamplerStatistics
+{
+    int samples = 0;
+    int updates = 0;
+    qreal totalLatency = 0;
+};
+
+static void replaySwipeTrace(const std::function<qreal(qreal)> &trace, bool prediction, ResamplerStatistics *statistics)
+{
+    // a touchpad reporting at 125 Hz and an output refreshing at 60 Hz, each frame is
+    // presented one refresh cycle after it has been started
+    const std::chrono::nanoseconds duration = 500ms;
+    const std::chrono::nanoseconds inputInterval = 8ms;
+    const std::chrono::nanoseconds frameInterval = 16666667ns;
+
+    GestureProgressResampler resampler;
+    resampler.setPredictionEnabled(prediction);
+    std::chrono::nanoseconds presentationTime = std::chrono::nanoseconds::zero();
+    QObject::connect(&resampler, &GestureProgressResampler::progress, [&](qreal progress) {
+        if (!statistics) {
+            return;
+        }
+        statistics->updates++;
+        // find the point in time at which the gesture actually had the presented progress
+        qreal low = 0;
+        qreal high = 1;
+        for (int i = 0; i < 32; ++i) {
+            const qreal middle = (low + high) / 2;
+            if (trace(middle) < progress) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        const std::chrono::duration<qreal, std::milli> shownAt = low * duration;
+        statistics->totalLatency += std::chrono::duration<qreal, std::milli>(presentationTime).count() - shownAt.count();
+    });
+
+    std::chrono::nanoseconds nextInput = inputInterval;
+    for (std::chrono::nanoseconds frameTime = frameInterval; frameTime <= duration; frameTime += frameInterval) {
+        for (; nextInput <= frameTime && nextInput <= duration; nextInput += inputInterval) {
+            resampler.addSample(trace(std::chrono::duration<qreal>(nextInput) / duration), nextInput);
+            if (statistics) {
+                statistics->samples++;
+            }
+        }
+        presentationTime = frameTime + frameInterval;
+        resampler.frame(presentationTime);
+    }
+}
+
+void GestureTest::benchmarkResampler_data()
+{
+    QTest::addColumn<std::function<qreal(qreal)>>("trace");
+    QTest::addColumn<bool>("prediction");
+
+    const std::function<qreal(qreal)> linear = [](qreal t) {
+        return t;
+    };
+    const std::function<qreal(qreal)> accelerating = [](qreal t) {
+        return t * t;
+    };
+    const std::function<qreal(qreal)> decelerating = [](qreal t) {
+        return 1 - (1 - t) * (1 - t);
+    };
+
+    QTest::newRow("linear") << linear << false;
+    QTest::newRow("linear/prediction") << linear << true;
+    QTest::newRow("accelerating") << accelerating << false;
+    QTest::newRow("accelerating/prediction") << accelerating << true;
+    QTest::newRow("decelerating") << decelerating << false;
+    QTest::newRow("decelerating/prediction") << decelerating << true;
+}
+
+void GestureTest::benchmarkResampler()
+{
+    // this benchmark replays swipe traces through the resampler and reports how many
+    // updates, and thus re-layouts in the consumer, are saved and the remaining latency
+    QFETCH(std::function<qreal(qreal)>, trace);
+    QFETCH(bool, prediction);
+
+    ResamplerStatistics statistics;
+    replaySwipeTrace(trace, prediction, &statistics);
+    QVERIFY(statistics.updates > 0);
+    QVERIFY(statistics.updates < statistics.samples);
+    qDebug() << "raw updates:" << statistics.samples << "resampled updates:" << statistics.updates
+             << "avoided:" << statistics.samples - statistics.updates
+             << "average latency:" << statistics.totalLatency / statistics.updates << "ms";
+
+    QBENCHMARK {
+        replaySwipeTrace(trace, prediction, nullptr);
+    }
+}
+
 QTEST_MAIN(GestureTest)
 #include "test_gestures.moc"
@@ -0,0 +1,161 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "abstract_output.h"
+#include "backends/virtual/virtual_framecapture.h"
+
+#include <cstring>
+
+using namespace KWin;
+
+class MockOutput : public AbstractOutput
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("Mock-1");
+    }
+    QRect geometry() const override
+    {
+        return QRect(100, 50, 64, 32);
+    }
+    int refreshRate() const override
+    {
+        return 60000;
+    }
+    qreal scale() const override
+    {
+        return 2;
+    }
+    QSize pixelSize() const override
+    {
+        return QSize(128, 64);
+    }
+};
+
+class TestVirtualFrameCapture : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testRingFormat();
+    void testDamageBoundingRect();
+
+private:
+    QByteArray captureFrames(const QVector<QColor> &colors, const QRegion &damage);
+};
+
+static quint64 alignedSize(quint64 size)
+{
+    return (size + 63) & ~quint64(63);
+}
+
+void TestVirtualFrameCapture::initTestCase()
+{
+    // small enough that the ring wraps around after two frames
+    qputenv("KWIN_WAYLAND_VIRTUAL_CAPTURE_SLOTS", QByteArrayLiteral("2"));
+}
+
+QByteArray TestVirtualFrameCapture::captureFrames(const QVector<QColor> &colors, const QRegion &damage)
+{
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        return QByteArray();
+    }
+
+    MockOutput output;
+    {
+        VirtualFrameCapture capture(directory.path(), VirtualFrameCapture::Format::Raw);
+        for (const QColor &color : colors) {
+            QImage image(output.pixelSize(), QImage::Format_RGB32);
+            image.fill(color);
+            capture.capture(&output, image, damage);
+        }
+    }
+
+    QFile ring(directory.filePath(QStringLiteral("Mock-1.ring")));
+    if (!ring.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return ring.readAll();
+}
+
+void TestVirtualFrameCapture::testRingFormat()
+{
+    const QVector<QColor> colors{Qt::red, Qt::green, Qt::blue};
+    const QByteArray data = captureFrames(colors, QRegion(110, 60, 10, 5) + QRegion(100, 50, 1, 1));
+    QVERIFY(!data.isEmpty());
+
+    const quint64 frameSize = 128 * 64 * 4;
+    const quint64 slotSize = alignedSize(sizeof(VirtualFrameCapture::FrameHeader)) + alignedSize(frameSize);
+    QCOMPARE(quint64(data.size()), alignedSize(sizeof(VirtualFrameCapture::RingHeader)) + 2 * slotSize);
+
+    VirtualFrameCapture::RingHeader ringHeader;
+    std::memcpy(&ringHeader, data.constData(), sizeof(ringHeader));
+    QCOMPARE(QByteArray(ringHeader.magic, sizeof(ringHeader.magic)), QByteArrayLiteral("KWINRING"));
+    QCOMPARE(ringHeader.version, VirtualFrameCapture::ringVersion);
+    QCOMPARE(ringHeader.slotCount, 2u);
+    QCOMPARE(ringHeader.slotSize, slotSize);
+    QCOMPARE(ringHeader.frameCount, quint64(colors.count()));
+
+    // the first frame has been overwritten by the third one
+    for (quint64 sequence = 1; sequence < ringHeader.frameCount; ++sequence) {
+        const char *slot = data.constData() + alignedSize(sizeof(VirtualFrameCapture::RingHeader)) + (sequence % ringHeader.slotCount) * slotSize;
+
+        VirtualFrameCapture::FrameHeader header;
+        std::memcpy(&header, slot, sizeof(header));
+        QCOMPARE(header.sequence, sequence);
+        QCOMPARE(header.width, 128u);
+        QCOMPARE(header.height, 64u);
+        QCOMPARE(header.stride, 128u * 4);
+        QCOMPARE(header.format, quint32(QImage::Format_RGB32));
+        QVERIFY(header.timestamp > 0);
+
+        // the damage is stored in device coordinates relative to the output
+        QCOMPARE(header.damageRectCount, 2u);
+        QRegion damage;
+        for (quint32 i = 0; i < header.damageRectCount; ++i) {
+            const qint32 *rect = header.damageRects[i];
+            damage += QRect(rect[0], rect[1], rect[2], rect[3]);
+        }
+        QCOMPARE(damage, QRegion(20, 20, 20, 10) + QRegion(0, 0, 2, 2));
+
+        const QImage image(reinterpret_cast<const uchar *>(slot + alignedSize(sizeof(header))),
+                           header.width, header.height, header.stride, QImage::Format(header.format));
+        QCOMPARE(image.pixelColor(0, 0), colors[sequence]);
+        QCOMPARE(image.pixelColor(127, 63), colors[sequence]);
+    }
+}
+
+void TestVirtualFrameCapture::testDamageBoundingRect()
+{
+    // if there are too many damage rectangles, only the bounding rectangle is stored
+    QRegion damage;
+    for (int i = 0; i <= VirtualFrameCapture::maxDamageRects; ++i) {
+        damage += QRect(100 + i * 2, 50, 1, 1);
+    }
+    QCOMPARE(damage.rectCount(), VirtualFrameCapture::maxDamageRects + 1);
+
+    const QByteArray data = captureFrames({Qt::white}, damage);
+    QVERIFY(!data.isEmpty());
+
+    VirtualFrameCapture::FrameHeader header;
+    std::memcpy(&header, data.constData() + alignedSize(sizeof(VirtualFrameCapture::RingHeader)), sizeof(header));
+    QCOMPARE(header.sequence, quint64(0));
+    QCOMPARE(header.damageRectCount, 1u);
+    const qint32 *rect = header.damageRects[0];
+    QCOMPARE(QRect(rect[0], rect[1], rect[2], rect[3]), QRect(0, 0, VirtualFrameCapture::maxDamageRects * 4 + 2, 2));
+}
+
+QTEST_GUILESS_MAIN(TestVirtualFrameCapture)
+#include "test_virtual_framecapture.moc"
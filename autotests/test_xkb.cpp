@@ -8,6 +8,8 @@
 */
 #include "xkb.h"
 
+#include <KConfigGroup>
+
 #include <QtTest>
 #include <xkbcommon/xkbcommon-keysyms.h>
 
@@ -19,6 +21,8 @@ class XkbTest : public QObject
 private Q_SLOTS:
     void testToQtKey_data();
     void testToQtKey();
+    void testPrefetchKeymap();
+    void testPrefetchKeymapConfigChanged();
 };
 
 // from kwindowsystem/src/platforms/xcb/kkeyserver.cpp
@@ -478,5 +482,58 @@ void XkbTest::testToQtKey()
     QTEST(xkb.toQtKey(keySym), "qt");
 }
 
+static KSharedConfigPtr createLayoutConfig(const QString &layouts)
+{
+    KSharedConfigPtr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup group = config->group("Layout");
+    group.writeEntry("Model", "pc105");
+    group.writeEntry("LayoutList", layouts);
+    return config;
+}
+
+static QByteArray keymapString(xkb_keymap *keymap)
+{
+    char *string = xkb_keymap_get_as_string(keymap, XKB_KEYMAP_FORMAT_TEXT_V1);
+    const QByteArray result(string);
+    free(string);
+    return result;
+}
+
+void XkbTest::testPrefetchKeymap()
+{
+    // this test verifies that a keymap compiled ahead of time matches the one compiled on demand
+    const KSharedConfigPtr config = createLayoutConfig(QStringLiteral("de,us"));
+
+    Xkb expected;
+    expected.setConfig(config);
+    expected.reconfigure();
+    QVERIFY(expected.keymap());
+
+    Xkb::prefetchKeymap(config);
+    Xkb xkb;
+    xkb.setConfig(config);
+    xkb.reconfigure();
+    QVERIFY(xkb.keymap());
+    QCOMPARE(xkb.numberOfLayouts(), 2u);
+    QCOMPARE(xkb.layoutShortName(0), QStringLiteral("de"));
+    QCOMPARE(keymapString(xkb.keymap()), keymapString(expected.keymap()));
+}
+
+void XkbTest::testPrefetchKeymapConfigChanged()
+{
+    // this test verifies that a prefetched keymap is discarded if the config changes in the meantime
+    const KSharedConfigPtr config = createLayoutConfig(QStringLiteral("de,us"));
+    Xkb::prefetchKeymap(config);
+
+    config->group("Layout").writeEntry("LayoutList", QStringLiteral("fr"));
+
+    Xkb xkb;
+    xkb.setConfig(config);
+    xkb.reconfigure();
+    QVERIFY(xkb.keymap());
+    QCOMPARE(xkb.numberOfLayouts(), 1u);
+    QCOMPARE(xkb.layoutShortName(0), QStringLiteral("fr"));
+}
+
 QTEST_MAIN(XkbTest)
 #include "test_xkb.moc"
@@ -30,4 +30,16 @@ RenderLoop *DrmAbstractOutput::renderLoop() const
     return m_renderLoop;
 }
 
+DrmAbstractOutput::ScanoutStats DrmAbstractOutput::scanoutStats() const
+{
+    return m_scanoutStats;
+}
+
+void DrmAbstractOutput::recordFrame(bool scanout, bool scaled)
+{
+    m_scanoutStats.frames++;
+    m_scanoutStats.scanout += scanout;
+    m_scanoutStats.scaled += scanout && scaled;
+}
+
 }
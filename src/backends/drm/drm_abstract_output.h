@@ -37,6 +37,19 @@ public:
     DrmGpu *gpu() const;
     RenderLoop *renderLoop() const override;
 
+    struct ScanoutStats {
+        quint64 frames = 0;
+        // frames that have been scanned out directly from a client buffer
+        quint64 scanout = 0;
+        // directly scanned out frames that have been cropped, scaled or letterboxed
+        quint64 scaled = 0;
+    };
+    /**
+     * Counts the frames presented with the OpenGL backend since the output has been created.
+     */
+    ScanoutStats scanoutStats() const;
+    void recordFrame(bool scanout, bool scaled);
+
 protected:
     friend class DrmBackend;
     friend class DrmGpu;
@@ -44,6 +57,7 @@ protected:
 
     RenderLoop *m_renderLoop;
     DrmGpu *m_gpu;
+    ScanoutStats m_scanoutStats;
 };
 
 }
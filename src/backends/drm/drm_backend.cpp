@@ -583,6 +583,11 @@ QString DrmBackend::supportInformation() const
     for (int g = 0; g < m_gpus.size(); g++) {
         s << "Atomic Mode Setting on GPU " << g << ": " << m_gpus.at(g)->atomicModeSetting() << Qt::endl;
     }
+    for (const DrmAbstractOutput *output : m_outputs) {
+        const DrmAbstractOutput::ScanoutStats stats = output->scanoutStats();
+        s << "Direct scanout on " << output->name() << ": " << stats.scanout << " of " << stats.frames << " frames, "
+          << stats.scaled << " of them cropped, scaled or letterboxed" << Qt::endl;
+    }
     return supportInfo;
 }
 
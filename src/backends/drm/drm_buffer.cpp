@@ -13,6 +13,7 @@
 
 // system
 #include <sys/mman.h>
+#include <unistd.h>
 // c++
 #include <cerrno>
 // drm
@@ -30,6 +31,11 @@ DrmBuffer::DrmBuffer(DrmGpu *gpu, uint32_t format, uint64_t modifier)
 {
 }
 
+DrmBuffer::~DrmBuffer()
+{
+    setSyncFd(-1);
+}
+
 quint32 DrmBuffer::bufferId() const
 {
     return m_bufferId;
@@ -55,6 +61,19 @@ uint64_t DrmBuffer::modifier() const
     return m_modifier;
 }
 
+void DrmBuffer::setSyncFd(int fd)
+{
+    if (m_syncFd != -1) {
+        close(m_syncFd);
+    }
+    m_syncFd = fd;
+}
+
+int DrmBuffer::syncFd() const
+{
+    return m_syncFd;
+}
+
 // DrmDumbBuffer
 DrmDumbBuffer::DrmDumbBuffer(DrmGpu *gpu, const QSize &size, uint32_t drmFormat)
     : DrmBuffer(gpu, drmFormat, DRM_FORMAT_MOD_LINEAR)
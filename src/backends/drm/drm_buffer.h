@@ -21,7 +21,7 @@ class DrmBuffer
 {
 public:
     DrmBuffer(DrmGpu *gpu, uint32_t format, uint64_t modifier);
-    virtual ~DrmBuffer() = default;
+    virtual ~DrmBuffer();
 
     virtual bool needsModeChange(DrmBuffer *b) const {Q_UNUSED(b) return false;}
 
@@ -31,12 +31,21 @@ public:
     uint32_t format() const;
     uint64_t modifier() const;
 
+    /**
+     * Sets the sync file that gets signaled once the contents of the buffer have been
+     * written, the buffer takes ownership of @a fd. It is passed to the kernel with the
+     * commit that shows the buffer, so the display waits for it instead of the compositor.
+     */
+    void setSyncFd(int fd);
+    int syncFd() const;
+
 protected:
     quint32 m_bufferId = 0;
     QSize m_size;
     DrmGpu *m_gpu;
     uint32_t m_format;
     uint64_t m_modifier;
+    int m_syncFd = -1;
 };
 
 class DrmDumbBuffer : public DrmBuffer
@@ -504,7 +504,6 @@ static std::chrono::nanoseconds convertTimestamp(clockid_t sourceClock, clockid_
 
 void DrmGpu::pageFlipHandler(int fd, unsigned int sequence, unsigned int sec, unsigned int usec, unsigned int crtc_id, void *user_data)
 {
-    Q_UNUSED(sequence)
     Q_UNUSED(user_data)
     auto backend = dynamic_cast<DrmBackend*>(kwinApp()->platform());
     if (!backend) {
@@ -534,7 +533,7 @@ void DrmGpu::pageFlipHandler(int fd, unsigned int sequence, unsigned int sec, un
     if (it == pipelines.end()) {
         qCWarning(KWIN_DRM, "received invalid page flip event for crtc %u", crtc_id);
     } else {
-        (*it)->pageFlipped(timestamp);
+        (*it)->pageFlipped(timestamp, sequence);
     }
 }
 
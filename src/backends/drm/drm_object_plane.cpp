@@ -42,6 +42,8 @@ DrmPlane::DrmPlane(DrmGpu *gpu, uint32_t planeId)
             QByteArrayLiteral("reflect-x"),
             QByteArrayLiteral("reflect-y")}),
         PropertyDefinition(QByteArrayLiteral("IN_FORMATS"), Requirement::Optional),
+        PropertyDefinition(QByteArrayLiteral("FB_DAMAGE_CLIPS"), Requirement::Optional),
+        PropertyDefinition(QByteArrayLiteral("IN_FENCE_FD"), Requirement::Optional),
         }, DRM_MODE_OBJECT_PLANE)
 {
 }
@@ -40,6 +40,8 @@ public:
         CrtcId,
         Rotation,
         In_Formats,
+        FbDamageClips,
+        InFenceFd,
         Count
     };
     Q_ENUM(PropertyIndex)
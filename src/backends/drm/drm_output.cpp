@@ -159,7 +159,14 @@ void DrmOutput::moveCursor()
     Cursor *cursor = Cursors::self()->currentCursor();
     const QMatrix4x4 monitorMatrix = logicalToNativeMatrix(geometry(), scale(), transform());
     const QMatrix4x4 hotspotMatrix = logicalToNativeMatrix(cursor->rect(), scale(), transform());
-    m_moveCursorSuccessful = m_pipeline->moveCursor(monitorMatrix.map(cursor->pos()) - hotspotMatrix.map(cursor->hotspot()));
+    // only attribute the move to the last pointer motion once, warps and output changes move the cursor as well
+    std::chrono::microseconds inputTimestamp = cursor->lastMotionTimestamp();
+    if (inputTimestamp > m_lastCursorInputTimestamp) {
+        m_lastCursorInputTimestamp = inputTimestamp;
+    } else {
+        inputTimestamp = std::chrono::microseconds::zero();
+    }
+    m_moveCursorSuccessful = m_pipeline->moveCursor(monitorMatrix.map(cursor->pos()) - hotspotMatrix.map(cursor->hotspot()), inputTimestamp);
     if (!m_moveCursorSuccessful) {
         m_pipeline->setCursor(nullptr);
     }
@@ -325,6 +332,11 @@ bool DrmOutput::needsSoftwareTransformation() const
 }
 
 bool DrmOutput::present(const QSharedPointer<DrmBuffer> &buffer, QRegion damagedRegion)
+{
+    return present(buffer, damagedRegion, QRect(), QRect());
+}
+
+bool DrmOutput::present(const QSharedPointer<DrmBuffer> &buffer, QRegion damagedRegion, const QRect &source, const QRect &destination)
 {
     if (!buffer || buffer->bufferId() == 0) {
         presentFailed();
@@ -340,7 +352,17 @@ bool DrmOutput::present(const QSharedPointer<DrmBuffer> &buffer, QRegion damaged
             setVrrPolicy(RenderLoop::VrrPolicy::Never);
         }
     }
-    if (m_pipeline->present(buffer)) {
+    // With hardware rotation or a scaled buffer, the damage would have to be mapped to the
+    // buffer, just let the driver assume that everything has changed in that case.
+    QRegion bufferDamage;
+    if (m_pipeline->pending.bufferTransformation == DrmPlane::Transformation::Rotate0 && !source.isValid() && !destination.isValid()) {
+        const QMatrix4x4 matrix = logicalToNativeMatrix(geometry(), scale(), transform());
+        const QRect bufferRect(QPoint(0, 0), buffer->size());
+        for (const QRect &rect : damagedRegion) {
+            bufferDamage += matrix.mapRect(QRectF(rect)).toAlignedRect() & bufferRect;
+        }
+    }
+    if (m_pipeline->present(buffer, bufferDamage, source, destination)) {
         Q_EMIT outputChange(damagedRegion);
         return true;
     } else {
@@ -460,9 +482,9 @@ void DrmOutput::revertQueuedChanges()
     m_pipeline->revertPendingChanges();
 }
 
-void DrmOutput::pageFlipped(std::chrono::nanoseconds timestamp)
+void DrmOutput::pageFlipped(std::chrono::nanoseconds timestamp, uint sequence)
 {
-    RenderLoopPrivate::get(m_renderLoop)->notifyFrameCompleted(timestamp);
+    RenderLoopPrivate::get(m_renderLoop)->notifyFrameCompleted(timestamp, sequence);
 }
 
 void DrmOutput::presentFailed()
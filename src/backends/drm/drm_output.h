@@ -44,6 +44,12 @@ public:
     ~DrmOutput() override;
 
     bool present(const QSharedPointer<DrmBuffer> &buffer, QRegion damagedRegion) override;
+    /**
+     * Presents the part @p source of the @p buffer in the rect @p destination of the crtc,
+     * in native output coordinates. Used for direct scanout of surfaces that don't exactly
+     * cover the output.
+     */
+    bool present(const QSharedPointer<DrmBuffer> &buffer, QRegion damagedRegion, const QRect &source, const QRect &destination);
 
     DrmConnector *connector() const;
     DrmPipeline *pipeline() const;
@@ -60,7 +66,7 @@ public:
     void revertQueuedChanges();
     void updateModes();
 
-    void pageFlipped(std::chrono::nanoseconds timestamp);
+    void pageFlipped(std::chrono::nanoseconds timestamp, uint sequence = 0);
     void presentFailed();
     bool usesSoftwareCursor() const override;
 
@@ -84,6 +90,7 @@ private:
     QSharedPointer<DumbSwapchain> m_cursor;
     bool m_setCursorSuccessful = false;
     bool m_moveCursorSuccessful = false;
+    std::chrono::microseconds m_lastCursorInputTimestamp = std::chrono::microseconds::zero();
     QRect m_lastCursorGeometry;
     QTimer m_turnOffTimer;
 };
@@ -23,6 +23,7 @@
 #include "drm_backend.h"
 #include "egl_gbm_backend.h"
 #include "drm_buffer_gbm.h"
+#include "ftrace.h"
 
 #include <gbm.h>
 #include <drm_fourcc.h>
@@ -44,11 +45,17 @@ DrmPipeline::~DrmPipeline()
     }
 }
 
-bool DrmPipeline::present(const QSharedPointer<DrmBuffer> &buffer)
+bool DrmPipeline::present(const QSharedPointer<DrmBuffer> &buffer, const QRegion &damage, const QRect &source, const QRect &destination)
 {
     Q_ASSERT(pending.crtc);
     Q_ASSERT(buffer);
+    if ((source.isValid() || destination.isValid()) && !gpu()->atomicModeSetting()) {
+        // page flips can't change the geometry of the primary plane
+        return false;
+    }
     m_primaryBuffer = buffer;
+    m_primarySource = source;
+    m_primaryDestination = destination;
     auto buf = dynamic_cast<DrmGbmBuffer*>(buffer.data());
     // with direct scanout disallow modesets, calling presentFailed() and logging warnings
     bool directScanout = buf && buf->clientBuffer();
@@ -60,30 +67,10 @@ bool DrmPipeline::present(const QSharedPointer<DrmBuffer> &buffer)
         return gpu()->maybeModeset();
     }
     if (gpu()->atomicModeSetting()) {
-        if (!commitPipelines({this}, CommitMode::Commit)) {
-            // update properties and try again
-            m_connector->updateProperties();
-            if (pending.crtc) {
-                pending.crtc->updateProperties();
-                if (pending.crtc->primaryPlane()) {
-                    pending.crtc->primaryPlane()->updateProperties();
-                }
-                if (pending.crtc->cursorPlane()) {
-                    pending.crtc->cursorPlane()->updateProperties();
-                }
-            }
-            if (!commitPipelines({this}, CommitMode::Commit)) {
-                if (directScanout) {
-                    return false;
-                }
-                qCWarning(KWIN_DRM) << "Atomic present failed!" << strerror(errno);
-                printDebugInfo();
-                if (m_output) {
-                    m_output->presentFailed();
-                }
-                return false;
-            }
-        }
+        setDamageClips(damage);
+        const bool presented = presentAtomic(directScanout);
+        setDamageClips(QRegion());
+        return presented;
     } else {
         if (!presentLegacy()) {
             qCWarning(KWIN_DRM) << "Present failed!" << strerror(errno);
@@ -96,6 +83,83 @@ bool DrmPipeline::present(const QSharedPointer<DrmBuffer> &buffer)
     return true;
 }
 
+bool DrmPipeline::presentAtomic(bool directScanout)
+{
+    if (!commitPipelines({this}, CommitMode::Commit)) {
+        // update properties and try again
+        m_connector->updateProperties();
+        if (pending.crtc) {
+            pending.crtc->updateProperties();
+            if (pending.crtc->primaryPlane()) {
+                pending.crtc->primaryPlane()->updateProperties();
+            }
+            if (pending.crtc->cursorPlane()) {
+                pending.crtc->cursorPlane()->updateProperties();
+            }
+        }
+        if (!commitPipelines({this}, CommitMode::Commit)) {
+            if (directScanout) {
+                return false;
+            }
+            qCWarning(KWIN_DRM) << "Atomic present failed!" << strerror(errno);
+            printDebugInfo();
+            if (m_output) {
+                m_output->presentFailed();
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void DrmPipeline::setDamageClips(const QRegion &damage)
+{
+    if (m_damageClipsBlob) {
+        // the kernel keeps its own reference for the committed plane state
+        drmModeDestroyPropertyBlob(gpu()->fd(), m_damageClipsBlob);
+        m_damageClipsBlob = 0;
+    }
+
+    static bool valid;
+    static const bool damageClipsDisabled = qEnvironmentVariableIntValue("KWIN_DRM_NO_DAMAGE_CLIPS", &valid) == 1 && valid;
+    if (damage.isEmpty() || damageClipsDisabled || !pending.crtc || !pending.crtc->primaryPlane()
+            || !pending.crtc->primaryPlane()->getProp(DrmPlane::PropertyIndex::FbDamageClips)) {
+        return;
+    }
+
+    QVector<drm_mode_rect> clips;
+    clips.reserve(damage.rectCount());
+    for (const QRect &rect : damage) {
+        clips.append(drm_mode_rect{rect.left(), rect.top(), rect.right() + 1, rect.bottom() + 1});
+    }
+    if (drmModeCreatePropertyBlob(gpu()->fd(), clips.constData(), sizeof(drm_mode_rect) * clips.count(), &m_damageClipsBlob) != 0) {
+        qCWarning(KWIN_DRM) << "Failed to create damage clips blob!" << strerror(errno);
+        m_damageClipsBlob = 0;
+    }
+}
+
+bool DrmPipeline::supportsInFence() const
+{
+    return pending.crtc && pending.crtc->primaryPlane()
+        && pending.crtc->primaryPlane()->getProp(DrmPlane::PropertyIndex::InFenceFd);
+}
+
+bool DrmPipeline::populateInFence(drmModeAtomicReq *req) const
+{
+    if (!activePending() || !m_primaryBuffer || m_primaryBuffer->syncFd() == -1 || !supportsInFence()) {
+        return true;
+    }
+    // The fence belongs to the buffer and not to the plane, so it's added to every commit
+    // instead of being tracked like the other plane properties.
+    DrmPlane *plane = pending.crtc->primaryPlane();
+    const DrmProperty *inFence = plane->getProp(DrmPlane::PropertyIndex::InFenceFd);
+    if (drmModeAtomicAddProperty(req, plane->id(), inFence->propId(), m_primaryBuffer->syncFd()) <= 0) {
+        qCWarning(KWIN_DRM) << "Adding the in fence to the atomic commit failed:" << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
 bool DrmPipeline::commitPipelines(const QVector<DrmPipeline*> &pipelines, CommitMode mode, const QVector<DrmObject*> &unusedObjects)
 {
     Q_ASSERT(!pipelines.isEmpty());
@@ -192,8 +256,11 @@ bool DrmPipeline::populateAtomicValues(drmModeAtomicReq *req, uint32_t &flags)
         pending.crtc->setPending(DrmCrtc::PropertyIndex::VrrEnabled, pending.syncMode == RenderLoopPrivate::SyncMode::Adaptive);
         pending.crtc->setPending(DrmCrtc::PropertyIndex::Gamma_LUT, pending.gamma ? pending.gamma->blobId() : 0);
         auto modeSize = m_connector->modes().at(pending.modeIndex)->size();
-        pending.crtc->primaryPlane()->set(QPoint(0, 0), m_primaryBuffer ? m_primaryBuffer->size() : bufferSize(), QPoint(0, 0), modeSize);
+        const QRect source = m_primarySource.isValid() ? m_primarySource : QRect(QPoint(0, 0), m_primaryBuffer ? m_primaryBuffer->size() : bufferSize());
+        const QRect destination = m_primaryDestination.isValid() ? m_primaryDestination : QRect(QPoint(0, 0), modeSize);
+        pending.crtc->primaryPlane()->set(source.topLeft(), source.size(), destination.topLeft(), destination.size());
         pending.crtc->primaryPlane()->setBuffer(activePending() ? m_primaryBuffer.get() : nullptr);
+        pending.crtc->primaryPlane()->setPending(DrmPlane::PropertyIndex::FbDamageClips, m_damageClipsBlob);
 
         if (pending.crtc->cursorPlane()) {
             pending.crtc->cursorPlane()->set(QPoint(0, 0), gpu()->cursorSize(), pending.cursorPos, gpu()->cursorSize());
@@ -211,6 +278,9 @@ bool DrmPipeline::populateAtomicValues(drmModeAtomicReq *req, uint32_t &flags)
         if (!pending.crtc->primaryPlane()->atomicPopulate(req)) {
             return false;
         }
+        if (!populateInFence(req)) {
+            return false;
+        }
         if (pending.crtc->cursorPlane() && !pending.crtc->cursorPlane()->atomicPopulate(req)) {
             return false;
         }
@@ -311,6 +381,9 @@ void DrmPipeline::atomicCommitSuccessful(CommitMode mode)
             }
         }
         m_current = pending;
+        // the cursor position is now on its way to the screen, don't count it again in later commits
+        pending.cursorInputTimestamp = std::chrono::microseconds::zero();
+        m_next.cursorInputTimestamp = std::chrono::microseconds::zero();
         if (mode == CommitMode::CommitModeset && activePending()) {
             pageFlipped(std::chrono::steady_clock::now().time_since_epoch());
         }
@@ -319,9 +392,19 @@ void DrmPipeline::atomicCommitSuccessful(CommitMode mode)
 
 bool DrmPipeline::checkTestBuffer()
 {
-    if (!pending.crtc || (m_primaryBuffer && m_primaryBuffer->size() == bufferSize())) {
+    if (!pending.crtc) {
         return true;
     }
+    if (m_primaryBuffer) {
+        if (m_primarySource.isValid() || m_primaryDestination.isValid()) {
+            // a direct scanout buffer with its own geometry, only usable as long as the mode stays
+            if (!needsModeset()) {
+                return true;
+            }
+        } else if (m_primaryBuffer->size() == bufferSize()) {
+            return true;
+        }
+    }
     auto backend = gpu()->eglBackend();
     QSharedPointer<DrmBuffer> buffer;
     // try to re-use buffers if possible.
@@ -359,6 +442,8 @@ bool DrmPipeline::checkTestBuffer()
     if (buffer && buffer->bufferId()) {
         m_oldTestBuffer = m_primaryBuffer;
         m_primaryBuffer = buffer;
+        m_primarySource = QRect();
+        m_primaryDestination = QRect();
         return true;
     }
     return false;
@@ -390,7 +475,7 @@ bool DrmPipeline::setCursor(const QSharedPointer<DrmDumbBuffer> &buffer, const Q
     return result;
 }
 
-bool DrmPipeline::moveCursor(QPoint pos)
+bool DrmPipeline::moveCursor(QPoint pos, std::chrono::microseconds inputTimestamp)
 {
     if (pending.cursorPos == pos) {
         return true;
@@ -398,11 +483,27 @@ bool DrmPipeline::moveCursor(QPoint pos)
     const bool visibleBefore = isCursorVisible();
     bool result;
     pending.cursorPos = pos;
+    pending.cursorInputTimestamp = inputTimestamp;
     // explicitly check for the cursor plane and not for AMS, as we might not always have one
     if (pending.crtc->cursorPlane()) {
+        if (moveCursorAsync()) {
+            // the new position is already with the kernel, no need to wait for the next frame
+            if (inputTimestamp != std::chrono::microseconds::zero()) {
+                recordCursorLatency(inputTimestamp, estimateNextVblank());
+            }
+            pending.cursorInputTimestamp = std::chrono::microseconds::zero();
+            // only the cursor position has been applied, other pending changes still need to be tested
+            m_current.cursorPos = pos;
+            m_next.cursorPos = pos;
+            return true;
+        }
         result = commitPipelines({this}, CommitMode::Test);
     } else {
         result = moveCursorLegacy();
+        if (result && inputTimestamp != std::chrono::microseconds::zero()) {
+            recordCursorLatency(inputTimestamp, estimateNextVblank());
+        }
+        pending.cursorInputTimestamp = std::chrono::microseconds::zero();
     }
     if (result) {
         m_next = pending;
@@ -415,6 +516,65 @@ bool DrmPipeline::moveCursor(QPoint pos)
     return result;
 }
 
+bool DrmPipeline::moveCursorAsync()
+{
+    static bool valid;
+    static const bool asyncCursorDisabled = qEnvironmentVariableIntValue("KWIN_DRM_NO_ASYNC_CURSOR", &valid) == 1 && valid;
+    DrmPlane *cursorPlane = pending.crtc->cursorPlane();
+    // only the position may differ from what the kernel currently shows, everything
+    // else has to go through a full atomic commit together with the next frame
+    if (asyncCursorDisabled
+        || !activePending()
+        || gpu()->needsModeset()
+        || m_current.crtc != pending.crtc
+        || !pending.cursorBo
+        || m_current.cursorBo != pending.cursorBo
+        || m_next.cursorBo != pending.cursorBo
+        || cursorPlane->getProp(DrmPlane::PropertyIndex::CrtcId)->current() != pending.crtc->id()) {
+        return false;
+    }
+    // The legacy cursor ioctl is implemented as a cursor plane only atomic update by the kernel.
+    // Unlike a normal atomic commit it doesn't fail with EBUSY while a page flip is pending and
+    // drivers with async plane updates apply it at the next vblank, regardless of the primary plane
+    if (!moveCursorLegacy()) {
+        return false;
+    }
+    // the kernel state was changed behind the back of the atomic property tracking, so update
+    // the cached values. Otherwise a later atomic commit could skip the position as unchanged
+    for (const auto &[index, value] : {std::pair(DrmPlane::PropertyIndex::CrtcX, pending.cursorPos.x()),
+                                       std::pair(DrmPlane::PropertyIndex::CrtcY, pending.cursorPos.y())}) {
+        DrmProperty *prop = cursorPlane->getProp(index);
+        prop->setPending(value);
+        prop->commitPending();
+        prop->commit();
+    }
+    return true;
+}
+
+std::chrono::nanoseconds DrmPipeline::estimateNextVblank() const
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    if (!m_output || m_output->renderLoop()->refreshRate() <= 0) {
+        return now;
+    }
+    const std::chrono::nanoseconds lastVblank = m_output->renderLoop()->lastPresentationTimestamp();
+    const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / m_output->renderLoop()->refreshRate());
+    if (lastVblank > now) {
+        return lastVblank;
+    }
+    return lastVblank + ((now - lastVblank) / vblankInterval + 1) * vblankInterval;
+}
+
+void DrmPipeline::recordCursorLatency(std::chrono::nanoseconds inputTimestamp, std::chrono::nanoseconds photonTimestamp)
+{
+    if (photonTimestamp < inputTimestamp) {
+        // the input event was timestamped with a different clock
+        return;
+    }
+    const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(photonTimestamp - inputTimestamp);
+    fTrace("cursor latency connector=", m_connector->id(), " usec=", latency.count());
+}
+
 void DrmPipeline::applyPendingChanges()
 {
     if (!pending.crtc) {
@@ -457,7 +617,7 @@ DrmGpu *DrmPipeline::gpu() const
     return m_connector->gpu();
 }
 
-void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
+void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp, uint sequence)
 {
     m_current.crtc->flipBuffer();
     if (m_current.crtc->primaryPlane()) {
@@ -467,8 +627,12 @@ void DrmPipeline::pageFlipped(std::chrono::nanoseconds timestamp)
         m_current.crtc->cursorPlane()->flipBuffer();
     }
     m_pageflipPending = false;
+    if (m_current.cursorInputTimestamp != std::chrono::microseconds::zero()) {
+        recordCursorLatency(m_current.cursorInputTimestamp, timestamp);
+        m_current.cursorInputTimestamp = std::chrono::microseconds::zero();
+    }
     if (m_output) {
-        m_output->pageFlipped(timestamp);
+        m_output->pageFlipped(timestamp, sequence);
     }
 }
 
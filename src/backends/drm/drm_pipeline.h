@@ -10,6 +10,7 @@
 #pragma once
 
 #include <QPoint>
+#include <QRegion>
 #include <QSize>
 #include <QVector>
 #include <QSharedPointer>
@@ -58,21 +59,32 @@ public:
     /**
      * tests the pending commit first and commits it if the test passes
      * if the test fails, there is a guarantee for no lasting changes
+     * @p damage is the part of the buffer that changed since the last presented buffer,
+     * in buffer coordinates. An empty region means that the whole buffer may have changed
+     * @p source is the part of the buffer that is shown and @p destination is where it is
+     * shown on the crtc, the primary plane scales it if the sizes differ. Invalid rects mean
+     * the whole buffer and the whole crtc. This is only supported with atomic modesetting
      */
-    bool present(const QSharedPointer<DrmBuffer> &buffer);
+    bool present(const QSharedPointer<DrmBuffer> &buffer, const QRegion &damage = QRegion(),
+                 const QRect &source = QRect(), const QRect &destination = QRect());
 
     bool needsModeset() const;
     void applyPendingChanges();
     void revertPendingChanges();
 
     bool setCursor(const QSharedPointer<DrmDumbBuffer> &buffer, const QPoint &hotspot = QPoint());
-    bool moveCursor(QPoint pos);
+    /**
+     * Moves the cursor to @p pos. If possible this is applied right away with a cursor plane only
+     * update instead of waiting for the next frame. @p inputTimestamp is the time of the input event
+     * that caused the move and is used for measuring input to photon latency, if available
+     */
+    bool moveCursor(QPoint pos, std::chrono::microseconds inputTimestamp = std::chrono::microseconds::zero());
 
     DrmConnector *connector() const;
     DrmCrtc *currentCrtc() const;
     DrmGpu *gpu() const;
 
-    void pageFlipped(std::chrono::nanoseconds timestamp);
+    void pageFlipped(std::chrono::nanoseconds timestamp, uint sequence = 0);
     bool pageflipPending() const;
     bool modesetPresentPending() const;
     void resetModesetPresentPending();
@@ -89,6 +101,10 @@ public:
     bool isFormatSupported(uint32_t drmFormat) const;
     QVector<uint64_t> supportedModifiers(uint32_t drmFormat) const;
     QMap<uint32_t, QVector<uint64_t>> supportedFormats() const;
+    /**
+     * whether the primary plane can wait for the sync file of a buffer before showing it
+     */
+    bool supportsInFence() const;
 
     void setOutput(DrmOutput *output);
     DrmOutput *output() const;
@@ -106,6 +122,8 @@ public:
         QPoint cursorPos;
         QPoint cursorHotspot;
         QSharedPointer<DrmDumbBuffer> cursorBo;
+        // the time of the input event that caused the last cursor move, if not presented yet
+        std::chrono::microseconds cursorInputTimestamp = std::chrono::microseconds::zero();
 
         // the transformation that this pipeline will apply to submitted buffers
         DrmPlane::Transformations bufferTransformation = DrmPlane::Transformation::Rotate0;
@@ -127,6 +145,9 @@ private:
     bool activePending() const;
     bool isCursorVisible() const;
     uint32_t calculateUnderscan();
+    bool moveCursorAsync();
+    std::chrono::nanoseconds estimateNextVblank() const;
+    void recordCursorLatency(std::chrono::nanoseconds inputTimestamp, std::chrono::nanoseconds photonTimestamp);
 
     // legacy only
     bool presentLegacy();
@@ -137,7 +158,10 @@ private:
     static bool commitPipelinesLegacy(const QVector<DrmPipeline*> &pipelines, CommitMode mode);
 
     // atomic modesetting only
+    bool presentAtomic(bool directScanout);
+    void setDamageClips(const QRegion &damage);
     bool populateAtomicValues(drmModeAtomicReq *req, uint32_t &flags);
+    bool populateInFence(drmModeAtomicReq *req) const;
     void atomicCommitFailed();
     void atomicCommitSuccessful(CommitMode mode);
     void prepareAtomicModeset();
@@ -152,9 +176,13 @@ private:
     DrmConnector *m_connector = nullptr;
 
     QSharedPointer<DrmBuffer> m_primaryBuffer;
+    QRect m_primarySource;
+    QRect m_primaryDestination;
     QSharedPointer<DrmBuffer> m_oldTestBuffer;
     bool m_pageflipPending = false;
     bool m_modesetPresentPending = false;
+    // the FB_DAMAGE_CLIPS blob for the commit that is being built
+    uint32_t m_damageClipsBlob = 0;
 
     // the state that will be applied at the next real atomic commit
     State m_next;
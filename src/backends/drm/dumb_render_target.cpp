@@ -0,0 +1,114 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "dumb_render_target.h"
+
+#include "drm_buffer.h"
+#include "drm_gpu.h"
+#include "eglnativefence.h"
+#include "logging.h"
+
+#include <drm_fourcc.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <xf86drm.h>
+
+namespace KWin
+{
+
+DumbRenderTarget::DumbRenderTarget(EGLDisplay display, const QSharedPointer<DrmDumbBuffer> &buffer, bool syncWithFence)
+    : m_buffer(buffer)
+    , m_display(display)
+    , m_syncWithFence(syncWithFence)
+{
+    int fd = -1;
+    if (drmPrimeHandleToFD(buffer->gpu()->fd(), buffer->handle(), DRM_CLOEXEC | DRM_RDWR, &fd) != 0) {
+        qCWarning(KWIN_DRM) << "Failed to export dumb buffer as dmabuf:" << strerror(errno);
+        return;
+    }
+
+    const EGLint attributes[] = {
+        EGL_WIDTH, EGLint(buffer->size().width()),
+        EGL_HEIGHT, EGLint(buffer->size().height()),
+        EGL_LINUX_DRM_FOURCC_EXT, EGLint(buffer->format()),
+        EGL_DMA_BUF_PLANE0_FD_EXT, fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, 0,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, EGLint(buffer->stride()),
+        EGL_NONE
+    };
+    m_image = eglCreateImageKHR(m_display, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, nullptr, attributes);
+    close(fd);
+    if (m_image == EGL_NO_IMAGE_KHR) {
+        qCDebug(KWIN_DRM) << "Failed to import dumb buffer into the rendering GPU";
+        return;
+    }
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, static_cast<GLeglImageOES>(m_image));
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    m_complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!m_complete) {
+        qCDebug(KWIN_DRM) << "Framebuffer for the imported dumb buffer is not complete";
+    }
+}
+
+DumbRenderTarget::~DumbRenderTarget()
+{
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+    }
+    if (m_image != EGL_NO_IMAGE_KHR) {
+        eglDestroyImageKHR(m_display, m_image);
+    }
+}
+
+bool DumbRenderTarget::isComplete() const
+{
+    return m_complete;
+}
+
+void DumbRenderTarget::blitFromFramebuffer(const QSize &size)
+{
+    const QSize targetSize = m_buffer->size();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer);
+    // The first row of the dumb buffer is the top of the image, whereas the origin of
+    // the default framebuffer is in the bottom left corner.
+    glBlitFramebuffer(0, 0, size.width(), size.height(),
+                      0, targetSize.height(), targetSize.width(), 0,
+                      GL_COLOR_BUFFER_BIT, size == targetSize ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (m_syncWithFence) {
+        EGLNativeFence fence(m_display);
+        if (fence.isValid()) {
+            m_buffer->setSyncFd(dup(fence.fileDescriptor()));
+            return;
+        }
+    }
+    // the display GPU doesn't wait for the rendering GPU on its own
+    m_buffer->setSyncFd(-1);
+    glFinish();
+}
+
+QSharedPointer<DrmDumbBuffer> DumbRenderTarget::buffer() const
+{
+    return m_buffer;
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QSharedPointer>
+#include <QSize>
+#include <kwinglutils.h>
+
+#include <epoxy/egl.h>
+
+namespace KWin
+{
+
+class DrmDumbBuffer;
+
+/**
+ * The DumbRenderTarget class makes a dumb buffer of the display GPU available as a render
+ * target on the rendering GPU. The dumb buffer is exported as a dmabuf and imported as an
+ * EGLImage, so the rendering GPU can copy a frame into it with a blit and the display GPU
+ * can scan it out directly.
+ *
+ * The rendering context has to be current when a DumbRenderTarget is created or destroyed.
+ */
+class DumbRenderTarget
+{
+public:
+    /**
+     * If @a syncWithFence is @c true, the display GPU waits for the copies with the sync
+     * files attached to the buffer rather than the rendering GPU finishing them right away.
+     */
+    DumbRenderTarget(EGLDisplay display, const QSharedPointer<DrmDumbBuffer> &buffer, bool syncWithFence);
+    ~DumbRenderTarget();
+
+    bool isComplete() const;
+
+    /**
+     * Copies the contents of the currently bound default framebuffer of the given @a size
+     * into the dumb buffer. The buffer gets the sync file of the copy if possible, otherwise
+     * this waits until the copy has finished.
+     */
+    void blitFromFramebuffer(const QSize &size);
+
+    QSharedPointer<DrmDumbBuffer> buffer() const;
+
+private:
+    QSharedPointer<DrmDumbBuffer> m_buffer;
+    EGLDisplay m_display;
+    EGLImageKHR m_image = EGL_NO_IMAGE_KHR;
+    GLuint m_texture = 0;
+    GLuint m_framebuffer = 0;
+    bool m_complete = false;
+    bool m_syncWithFence;
+};
+
+}
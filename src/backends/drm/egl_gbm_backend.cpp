@@ -23,14 +23,17 @@
 #include "drm_gpu.h"
 #include "linux_dmabuf.h"
 #include "dumb_swapchain.h"
+#include "dumb_render_target.h"
 #include "kwineglutils_p.h"
 #include "shadowbuffer.h"
 #include "drm_pipeline.h"
 #include "drm_abstract_output.h"
 #include "egl_dmabuf.h"
+#include "ftrace.h"
 // kwin libs
 #include <kwinglplatform.h>
 #include <kwineglimagetexture.h>
+#include <QtConcurrent>
 // system
 #include <gbm.h>
 #include <unistd.h>
@@ -70,6 +73,11 @@ void EglGbmBackend::cleanupSurfaces()
 void EglGbmBackend::cleanupRenderData(Output::RenderData &render)
 {
     render.gbmSurface = nullptr;
+    if (!render.importTargets.isEmpty()) {
+        // the render targets live in the context of the rendering GPU
+        renderingBackend()->makeCurrent();
+        render.importTargets.clear();
+    }
     render.importSwapchain = nullptr;
     if (render.shadowBuffer) {
         makeContextCurrent(render);
@@ -231,11 +239,15 @@ void EglGbmBackend::removeOutput(AbstractOutput *output)
     m_outputs.remove(output);
 }
 
-bool EglGbmBackend::swapBuffers(DrmAbstractOutput *drmOutput, const QRegion &dirty)
+bool EglGbmBackend::swapBuffers(DrmAbstractOutput *drmOutput, const QRegion &dirty, DumbRenderTarget *copyTarget)
 {
     Q_ASSERT(m_outputs.contains(drmOutput));
     Output &output = m_outputs[drmOutput];
     renderFramebufferToSurface(output);
+    if (copyTarget) {
+        makeContextCurrent(output.current);
+        copyTarget->blitFromFramebuffer(drmOutput->bufferSize());
+    }
     if (output.current.gbmSurface->swapBuffers()) {
         cleanupRenderData(output.old);
         updateBufferAge(output, dirty);
@@ -256,7 +268,20 @@ bool EglGbmBackend::exportFramebuffer(DrmAbstractOutput *drmOutput, void *data,
         // shouldn't happen if formats are the same
         return false;
     }
-    return memcpy(data, bo->mappedData(), size.height() * stride);
+    // Copy in stripes on the thread pool, reading from uncached memory with a single
+    // thread doesn't come close to the available memory bandwidth.
+    static const int stripeHeight = 64;
+    QVector<int> stripes;
+    for (int y = 0; y < size.height(); y += stripeHeight) {
+        stripes.append(y);
+    }
+    const uchar *source = static_cast<const uchar *>(bo->mappedData());
+    uchar *destination = static_cast<uchar *>(data);
+    QtConcurrent::blockingMap(stripes, [&](int y) {
+        const int height = std::min(stripeHeight, size.height() - y);
+        memcpy(destination + y * stride, source + y * stride, height * stride);
+    });
+    return true;
 }
 
 bool EglGbmBackend::exportFramebufferAsDmabuf(DrmAbstractOutput *drmOutput, int *fds, int *strides, int *offsets, uint32_t *num_fds, uint32_t *format, uint64_t *modifier)
@@ -296,8 +321,63 @@ bool EglGbmBackend::exportFramebufferAsDmabuf(DrmAbstractOutput *drmOutput, int
     return true;
 }
 
+bool EglGbmBackend::ensureImportSwapchain(Output &output) const
+{
+    const auto size = output.output->modeSize();
+    if (!output.current.importSwapchain || output.current.importSwapchain->size() != size) {
+        if (!output.current.importTargets.isEmpty()) {
+            renderingBackend()->makeCurrent();
+            output.current.importTargets.clear();
+        }
+        const uint32_t format = renderingBackend()->drmFormat(output.output);
+        output.current.importSwapchain = QSharedPointer<DumbSwapchain>::create(m_gpu, size, format);
+        if (output.current.importSwapchain->isEmpty() || output.current.importSwapchain->currentBuffer()->format() != format) {
+            output.current.importSwapchain = nullptr;
+        }
+    }
+    return output.current.importSwapchain;
+}
+
+DumbRenderTarget *EglGbmBackend::acquireImportTarget(Output &output) const
+{
+    if (!ensureImportSwapchain(output)) {
+        return nullptr;
+    }
+    const auto buffer = output.current.importSwapchain->acquireBuffer();
+    for (const auto &target : qAsConst(output.current.importTargets)) {
+        if (target->buffer() == buffer) {
+            return target.data();
+        }
+    }
+    // let the display wait for the copy instead of stalling the rendering GPU every frame
+    const auto drmOutput = qobject_cast<DrmOutput *>(output.output);
+    const bool syncWithFence = renderingBackend()->supportsNativeFence() && drmOutput && drmOutput->pipeline()->supportsInFence();
+    renderingBackend()->makeCurrent();
+    auto target = QSharedPointer<DumbRenderTarget>::create(renderingBackend()->eglDisplay(), buffer, syncWithFence);
+    if (!target->isComplete()) {
+        return nullptr;
+    }
+    output.current.importTargets.append(target);
+    return target.data();
+}
+
 QSharedPointer<DrmBuffer> EglGbmBackend::importFramebuffer(Output &output, const QRegion &dirty) const
 {
+    if (output.current.importMode == ImportMode::GpuCopy) {
+        if (DumbRenderTarget *target = acquireImportTarget(output)) {
+            if (!renderingBackend()->swapBuffers(output.output, dirty, target)) {
+                qCWarning(KWIN_DRM) << "swapping buffers failed on output" << output.output;
+                return nullptr;
+            }
+            return target->buffer();
+        }
+        qCDebug(KWIN_DRM) << "GPU copy failed! Switching to CPU import on output" << output.output;
+        output.current.importMode = ImportMode::DumbBuffer;
+        if (!output.current.importTargets.isEmpty()) {
+            renderingBackend()->makeCurrent();
+            output.current.importTargets.clear();
+        }
+    }
     if (!renderingBackend()->swapBuffers(output.output, dirty)) {
         qCWarning(KWIN_DRM) << "swapping buffers failed on output" << output.output;
         return nullptr;
@@ -330,18 +410,18 @@ QSharedPointer<DrmBuffer> EglGbmBackend::importFramebuffer(Output &output, const
                 }
             }
         }
-        qCDebug(KWIN_DRM) << "import with dmabuf failed! Switching to CPU import on output" << output.output;
-        output.current.importMode = ImportMode::DumbBuffer;
-    }
-    // ImportMode::DumbBuffer
-    if (!output.current.importSwapchain || output.current.importSwapchain->size() != size) {
-        const uint32_t format = renderingBackend()->drmFormat(output.output);
-        output.current.importSwapchain = QSharedPointer<DumbSwapchain>::create(m_gpu, size, format);
-        if (output.current.importSwapchain->isEmpty() || output.current.importSwapchain->currentBuffer()->format() != format) {
-            output.current.importSwapchain = nullptr;
+        // The GPU copy is used from the next frame on, this frame has been presented
+        // on the rendering GPU already and can only be copied with the CPU.
+        if (GLRenderTarget::blitSupported() && renderingBackend()->hasExtension(QByteArrayLiteral("EGL_EXT_image_dma_buf_import"))) {
+            qCDebug(KWIN_DRM) << "import with dmabuf failed! Switching to GPU copy on output" << output.output;
+            output.current.importMode = ImportMode::GpuCopy;
+        } else {
+            qCDebug(KWIN_DRM) << "import with dmabuf failed! Switching to CPU import on output" << output.output;
+            output.current.importMode = ImportMode::DumbBuffer;
         }
     }
-    if (output.current.importSwapchain) {
+    // ImportMode::DumbBuffer
+    if (ensureImportSwapchain(output)) {
         auto buffer = output.current.importSwapchain->acquireBuffer();
         if (renderingBackend()->exportFramebuffer(output.output, buffer->data(), size, buffer->stride())) {
             return buffer;
@@ -623,6 +703,47 @@ void EglGbmBackend::endFrame(AbstractOutput *drmOutput, const QRegion &renderedR
     const QRegion dirty = damagedRegion.intersected(output.output->geometry());
     QSharedPointer<DrmBuffer> buffer = endFrameWithBuffer(drmOutput, dirty);
     output.output->present(buffer, dirty);
+    recordScanout(output, false);
+}
+
+void EglGbmBackend::recordScanout(const Output &output, bool scanout) const
+{
+    const bool scaled = scanout && (output.scanoutSource.isValid() || output.scanoutDestination.isValid());
+    fTrace("EGL frame output=", output.output->name(), " scanout=", scanout, " scaled=", scaled);
+    output.output->recordFrame(scanout, scaled);
+}
+
+// Calculates which part of the buffer the primary plane has to show where on the crtc to
+// show the surface like the compositor would. Invalid rects mean the whole buffer and the
+// whole crtc. Returns false if the plane can't show the surface.
+static bool scanoutGeometry(DrmAbstractOutput *output, SurfaceItem *item, const QSize &bufferSize, QRect *source, QRect *destination)
+{
+    const QRect globalRect = item->mapToGlobal(item->rect());
+    if (bufferSize == output->modeSize() && globalRect == output->geometry()) {
+        *source = QRect();
+        *destination = QRect();
+        return true;
+    }
+    // the buffer has to be scaled in the crtc coordinate system, which hardware rotation changes
+    if (output->transform() != AbstractOutput::Transform::Normal || !qobject_cast<DrmOutput *>(output)) {
+        return false;
+    }
+    // rotated and flipped buffers aren't supported
+    const QMatrix4x4 surfaceToBuffer = item->surfaceToBufferMatrix();
+    if (surfaceToBuffer(0, 1) != 0 || surfaceToBuffer(1, 0) != 0 || surfaceToBuffer(0, 0) <= 0 || surfaceToBuffer(1, 1) <= 0) {
+        return false;
+    }
+    const QRect sourceRect = surfaceToBuffer.mapRect(QRectF(item->rect())).toRect();
+    const QRectF outputRect = globalRect.translated(-output->geometry().topLeft());
+    const qreal scale = output->scale();
+    const QRect destinationRect = QRectF(outputRect.topLeft() * scale, outputRect.size() * scale).toRect();
+    if (sourceRect.isEmpty() || !QRect(QPoint(0, 0), bufferSize).contains(sourceRect)
+        || destinationRect.isEmpty() || !QRect(QPoint(0, 0), output->modeSize()).contains(destinationRect)) {
+        return false;
+    }
+    *source = sourceRect;
+    *destination = destinationRect;
+    return true;
 }
 
 void EglGbmBackend::updateBufferAge(Output &output, const QRegion &dirty)
@@ -657,7 +778,9 @@ bool EglGbmBackend::scanout(AbstractOutput *drmOutput, SurfaceItem *surfaceItem)
     }
     Output &output = m_outputs[drmOutput];
     const auto planes = buffer->planes();
-    if (buffer->size() != output.output->modeSize() || planes.isEmpty()) {
+    QRect source;
+    QRect destination;
+    if (planes.isEmpty() || !scanoutGeometry(output.output, surfaceItem, buffer->size(), &source, &destination)) {
         return false;
     }
     if (output.oldScanoutCandidate && output.oldScanoutCandidate != surface) {
@@ -668,8 +791,13 @@ bool EglGbmBackend::scanout(AbstractOutput *drmOutput, SurfaceItem *surfaceItem)
     }
     if (output.scanoutCandidate.surface != surface) {
         output.scanoutCandidate.attemptedFormats = {};
+        output.scanoutCandidate.rejectedGeometry.reset();
     }
     output.scanoutCandidate.surface = surface;
+    // not every plane can scale or cover only a part of the crtc, don't test the same geometry every frame
+    if (output.scanoutCandidate.rejectedGeometry == qMakePair(source, destination)) {
+        return false;
+    }
     const auto &sendFeedback = [&output, &buffer, &planes, this]() {
         if (!output.scanoutCandidate.attemptedFormats[buffer->format()].contains(planes.first().modifier)) {
             output.scanoutCandidate.attemptedFormats[buffer->format()] << planes.first().modifier;
@@ -743,14 +871,10 @@ bool EglGbmBackend::scanout(AbstractOutput *drmOutput, SurfaceItem *surfaceItem)
     }
     // damage tracking for screen casting
     QRegion damage;
-    if (output.scanoutSurface == surface && buffer->size() == output.output->modeSize()) {
+    if (output.scanoutSurface == surface && output.scanoutSource == source && output.scanoutDestination == destination) {
         QRegion trackedDamage = surfaceItem->damage();
         surfaceItem->resetDamage();
-        for (const auto &rect : trackedDamage) {
-            auto damageRect = QRect(rect);
-            damageRect.translate(output.output->geometry().topLeft());
-            damage |= damageRect;
-        }
+        damage = surfaceItem->mapToGlobal(trackedDamage) & output.output->geometry();
     } else {
         damage = output.output->geometry();
     }
@@ -763,17 +887,29 @@ bool EglGbmBackend::scanout(AbstractOutput *drmOutput, SurfaceItem *surfaceItem)
     }
     // ensure that a context is current like with normal presentation
     makeCurrent();
-    if (output.output->present(bo, damage)) {
+    const bool presented = source.isValid() || destination.isValid()
+        ? static_cast<DrmOutput *>(output.output)->present(bo, damage, source, destination)
+        : output.output->present(bo, damage);
+    if (presented) {
         if (output.scanoutSurface != surface) {
             auto path = surface->client()->executablePath();
             qCDebug(KWIN_DRM).nospace() << "Direct scanout starting on output " << output.output->name() << " for application \"" << path << "\"";
         }
         output.scanoutSurface = surface;
+        output.scanoutSource = source;
+        output.scanoutDestination = destination;
         output.scanoutBuffer = bo;
+        recordScanout(output, true);
         return true;
     } else {
         // TODO clean the modeset and direct scanout code paths up
-        if (!m_gpu->needsModeset()) {
+        if (m_gpu->needsModeset()) {
+            return false;
+        }
+        if (source.isValid() || destination.isValid()) {
+            // most likely the plane can't scale or position the buffer like this, the format isn't the issue
+            output.scanoutCandidate.rejectedGeometry = qMakePair(source, destination);
+        } else {
             sendFeedback();
         }
         return false;
@@ -35,6 +35,7 @@ class DrmOutput;
 class GbmSurface;
 class GbmBuffer;
 class DumbSwapchain;
+class DumbRenderTarget;
 class ShadowBuffer;
 class DrmBackend;
 class DrmGpu;
@@ -70,7 +71,11 @@ public:
     QSharedPointer<GLTexture> textureForOutput(AbstractOutput *requestedOutput) const override;
 
     bool hasOutput(AbstractOutput *output) const;
-    bool swapBuffers(DrmAbstractOutput *output, const QRegion &dirty);
+    /**
+     * Presents the frame that has been rendered for the @a output. If @a copyTarget is
+     * not null, the frame is copied into it before.
+     */
+    bool swapBuffers(DrmAbstractOutput *output, const QRegion &dirty, DumbRenderTarget *copyTarget = nullptr);
     bool exportFramebuffer(DrmAbstractOutput *output, void *data, const QSize &size, uint32_t stride);
     bool exportFramebufferAsDmabuf(DrmAbstractOutput *output, int *fds, int *strides, int *offsets, uint32_t *num_fds, uint32_t *format, uint64_t *modifier);
 
@@ -89,8 +94,16 @@ private:
     bool initBufferConfigs();
     bool initRenderingContext();
 
+    /**
+     * How the frames for an output of a secondary GPU get from the rendering GPU to the
+     * display GPU. The modes are tried in order, the next one is used if a mode fails.
+     */
     enum class ImportMode {
+        /// the rendered buffer is imported by the display GPU and scanned out directly
         Dmabuf,
+        /// the rendering GPU copies the frame into a dumb buffer of the display GPU
+        GpuCopy,
+        /// the frame is copied into a dumb buffer of the display GPU with the CPU
         DumbBuffer
     };
     struct Output {
@@ -106,12 +119,17 @@ private:
             // for secondary GPU import
             ImportMode importMode = ImportMode::Dmabuf;
             QSharedPointer<DumbSwapchain> importSwapchain;
+            QVector<QSharedPointer<DumbRenderTarget>> importTargets;
         } old, current;
 
         KWaylandServer::SurfaceInterface *scanoutSurface = nullptr;
+        QRect scanoutSource;
+        QRect scanoutDestination;
         struct {
             QPointer<KWaylandServer::SurfaceInterface> surface;
             QMap<uint32_t, QVector<uint64_t>> attemptedFormats;
+            // the last source and destination rects the primary plane failed to scan out the surface with
+            std::optional<QPair<QRect, QRect>> rejectedGeometry;
         } scanoutCandidate;
         QSharedPointer<DrmBuffer> scanoutBuffer;
         QPointer<KWaylandServer::SurfaceInterface> oldScanoutCandidate;
@@ -128,9 +146,12 @@ private:
     void renderFramebufferToSurface(Output &output);
     QRegion prepareRenderingForOutput(Output &output);
     QSharedPointer<DrmBuffer> importFramebuffer(Output &output, const QRegion &dirty) const;
+    DumbRenderTarget *acquireImportTarget(Output &output) const;
+    bool ensureImportSwapchain(Output &output) const;
     QSharedPointer<DrmBuffer> endFrameWithBuffer(AbstractOutput *output, const QRegion &dirty);
     void updateBufferAge(Output &output, const QRegion &dirty);
     std::optional<GbmFormat> chooseFormat(Output &output) const;
+    void recordScanout(const Output &output, bool scanout) const;
 
     void cleanupRenderData(Output::RenderData &output);
 
@@ -12,6 +12,11 @@
 namespace KWin
 {
 
+InputEventTypes PlaceholderInputEventFilter::eventTypes() const
+{
+    return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+}
+
 bool PlaceholderInputEventFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(event)
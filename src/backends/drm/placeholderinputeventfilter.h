@@ -16,6 +16,7 @@ namespace KWin
 class PlaceholderInputEventFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override;
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override;
     bool wheelEvent(QWheelEvent *event) override;
     bool keyEvent(QKeyEvent *event) override;
@@ -11,6 +11,7 @@
 #include "drm_output.h"
 #include "drm_gpu.h"
 #include "drm_buffer.h"
+#include "ftrace.h"
 #include "renderloop_p.h"
 
 #include <drm_fourcc.h>
@@ -47,12 +48,14 @@ void DrmQPainterBackend::initOutput(DrmAbstractOutput *output)
 {
     Output o;
     o.swapchain = QSharedPointer<DumbSwapchain>::create(m_gpu, output->sourceSize(), DRM_FORMAT_XRGB8888);
+    o.damageJournal.setCapacity(o.swapchain->slotCount());
     o.output = output;
     m_outputs.insert(output, o);
     connect(output, &DrmOutput::currentModeChanged, this,
         [output, this] {
             auto &o = m_outputs[output];
             o.swapchain = QSharedPointer<DumbSwapchain>::create(m_gpu, output->sourceSize(), DRM_FORMAT_XRGB8888);
+            o.damageJournal.clear();
             o.damageJournal.setCapacity(o.swapchain->slotCount());
         }
     );
@@ -73,18 +76,41 @@ QRegion DrmQPainterBackend::beginFrame(AbstractOutput *output)
     return rendererOutput->damageJournal.accumulate(bufferAge, rendererOutput->output->geometry());
 }
 
+static qint64 regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+    for (const QRect &rect : region) {
+        area += qint64(rect.width()) * rect.height();
+    }
+    return area;
+}
+
 void DrmQPainterBackend::endFrame(AbstractOutput *output, const QRegion &renderedRegion, const QRegion &damage)
 {
-    Q_UNUSED(renderedRegion)
     Output &rendererOutput = m_outputs[output];
     DrmAbstractOutput *drmOutput = rendererOutput.output;
 
     QSharedPointer<DrmDumbBuffer> back = rendererOutput.swapchain->currentBuffer();
     rendererOutput.swapchain->releaseBuffer(back);
 
-    drmOutput->present(back, drmOutput->geometry());
+    // Only the damage has changed since the last presented buffer, so the driver can
+    // restrict uploads to it, e.g. with virtual or USB displays.
+    const QRegion frameDamage = damage & drmOutput->geometry();
+    drmOutput->present(back, frameDamage);
 
     rendererOutput.damageJournal.add(damage);
+
+    recordBytesWritten(rendererOutput, renderedRegion, frameDamage);
+}
+
+void DrmQPainterBackend::recordBytesWritten(const Output &output, const QRegion &renderedRegion, const QRegion &damage)
+{
+    const qreal scale = output.output->scale();
+    // the swapchain buffers are XRGB8888
+    const qint64 bytesPerPixel = 4;
+    const qint64 written = regionArea(renderedRegion) * scale * scale * bytesPerPixel;
+    const qint64 damaged = regionArea(damage) * scale * scale * bytesPerPixel;
+    fTrace("QPainter frame output=", output.output->name(), " written=", written, " damaged=", damaged);
 }
 
 }
@@ -42,6 +42,7 @@ private:
         QSharedPointer<DumbSwapchain> swapchain;
         DamageJournal damageJournal;
     };
+    void recordBytesWritten(const Output &output, const QRegion &renderedRegion, const QRegion &damage);
     QMap<AbstractOutput *, Output> m_outputs;
     DrmBackend *m_backend;
     DrmGpu *m_gpu;
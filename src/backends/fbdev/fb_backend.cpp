@@ -268,9 +268,8 @@ void FramebufferBackend::initImageFormat()
             m_blue.offset == 0 &&
             m_green.offset == 8 &&
             m_red.offset == 16) {
-        qCDebug(KWIN_FB) << "Framebuffer Format is RGB888";
-        m_bgr = true;
-        m_imageFormat = QImage::Format_RGB888;
+        qCDebug(KWIN_FB) << "Framebuffer Format is BGR888";
+        m_imageFormat = QImage::Format_BGR888;
     } else if (m_bitsPerPixel == 16 &&
             m_red.length == 5 &&
             m_green.length == 6 &&
@@ -77,12 +77,6 @@ public:
         return m_bitsPerPixel;
     }
     QImage::Format imageFormat() const;
-    /**
-     * @returns whether the imageFormat is BGR instead of RGB.
-     */
-    bool isBGR() const {
-        return m_bgr;
-    }
 
     Outputs outputs() const override;
     Outputs enabledOutputs() const override;
@@ -112,7 +106,6 @@ private:
     int m_bytesPerLine = 0;
     void *m_memory = nullptr;
     QImage::Format m_imageFormat = QImage::Format_Invalid;
-    bool m_bgr = false;
 };
 
 }
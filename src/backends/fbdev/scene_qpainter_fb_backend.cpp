@@ -20,11 +20,58 @@
 // Qt
 #include <QPainter>
 
+#include <cstring>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace KWin
 {
+
+/**
+ * Returns the format of the render buffer for a framebuffer with the given format. The
+ * scene renders in the channel order of the framebuffer if possible, so that presenting
+ * a frame is a plain copy.
+ */
+static QImage::Format renderFormat(QImage::Format framebufferFormat)
+{
+    switch (framebufferFormat) {
+    case QImage::Format_RGB32:
+    case QImage::Format_BGR888:
+    case QImage::Format_RGB16:
+        return framebufferFormat;
+    case QImage::Format_RGBA8888:
+        // the alpha channel of the framebuffer is unused
+        return QImage::Format_RGBX8888;
+    default:
+        return QImage::Format_RGB32;
+    }
+}
+
+static void copyRow(uchar *dst, const uchar *src, int length)
+{
+#if defined(__SSE2__)
+    // The framebuffer is usually mapped write-combined, so bypass the cache when writing.
+    while (length > 0 && (reinterpret_cast<quintptr>(dst) & 15)) {
+        *dst++ = *src++;
+        --length;
+    }
+    for (; length >= 64; length -= 64, src += 64, dst += 64) {
+        const __m128i *source = reinterpret_cast<const __m128i *>(src);
+        __m128i *destination = reinterpret_cast<__m128i *>(dst);
+        _mm_stream_si128(destination, _mm_loadu_si128(source));
+        _mm_stream_si128(destination + 1, _mm_loadu_si128(source + 1));
+        _mm_stream_si128(destination + 2, _mm_loadu_si128(source + 2));
+        _mm_stream_si128(destination + 3, _mm_loadu_si128(source + 3));
+    }
+#endif
+    std::memcpy(dst, src, length);
+}
+
 FramebufferQPainterBackend::FramebufferQPainterBackend(FramebufferBackend *backend)
     : QPainterBackend()
-    , m_renderBuffer(backend->screenSize(), QImage::Format_RGB32)
+    , m_renderBuffer(backend->screenSize(), renderFormat(backend->imageFormat()))
     , m_backend(backend)
 {
     m_renderBuffer.fill(Qt::black);
@@ -36,6 +83,10 @@ FramebufferQPainterBackend::FramebufferQPainterBackend(FramebufferBackend *backe
                           m_backend->bytesPerLine(), m_backend->imageFormat());
     m_backBuffer.fill(Qt::black);
 
+    // For all known framebuffer formats the render buffer has the same memory layout, so
+    // frames can be copied to the framebuffer as they are.
+    m_nativeFormat = m_backend->imageFormat() != QImage::Format_Invalid;
+
     connect(kwinApp()->platform()->session(), &Session::activeChanged, this, [this](bool active) {
         if (active) {
             reactivate();
@@ -72,22 +123,51 @@ QImage* FramebufferQPainterBackend::bufferForScreen(AbstractOutput *output)
 
 QRegion FramebufferQPainterBackend::beginFrame(AbstractOutput *output)
 {
-    return output->geometry();
+    Q_UNUSED(output)
+    // There is only one render buffer and it always holds the previous frame, i.e. its
+    // age is one, so only the damaged region needs to be repainted.
+    return QRegion();
 }
 
 void FramebufferQPainterBackend::endFrame(AbstractOutput *output, const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
     Q_UNUSED(renderedRegion)
-    Q_UNUSED(damagedRegion)
 
     if (!kwinApp()->platform()->session()->isActive()) {
+        // the whole screen gets repainted when the session becomes active again
         return;
     }
 
     static_cast<FramebufferOutput *>(output)->vsyncMonitor()->arm();
 
-    QPainter p(&m_backBuffer);
-    p.drawImage(QPoint(0, 0), m_backend->isBGR() ? m_renderBuffer.rgbSwapped() : m_renderBuffer);
+    const QRegion damage = damagedRegion.translated(-output->geometry().topLeft())
+        & m_renderBuffer.rect() & m_backBuffer.rect();
+    if (damage.isEmpty()) {
+        return;
+    }
+
+    if (!m_nativeFormat) {
+        QPainter painter(&m_backBuffer);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect &rect : damage) {
+            painter.drawImage(rect.topLeft(), m_renderBuffer, rect);
+        }
+        return;
+    }
+
+    const int bytesPerPixel = m_renderBuffer.depth() / 8;
+    uchar *framebuffer = static_cast<uchar *>(m_backend->mappedMemory());
+    for (const QRect &rect : damage) {
+        const int offset = rect.x() * bytesPerPixel;
+        const int length = rect.width() * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            copyRow(framebuffer + y * m_backend->bytesPerLine() + offset,
+                    m_renderBuffer.constScanLine(y) + offset, length);
+        }
+    }
+#if defined(__SSE2__)
+    _mm_sfence();
+#endif
 }
 
 }
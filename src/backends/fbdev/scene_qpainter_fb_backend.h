@@ -42,6 +42,7 @@ private:
     QImage m_backBuffer;
 
     FramebufferBackend *m_backend;
+    bool m_nativeFormat = false;
 };
 
 }
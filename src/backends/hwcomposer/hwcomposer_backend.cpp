@@ -54,6 +54,11 @@ BacklightInputEventFilter::BacklightInputEventFilter(HwcomposerBackend *backend)
 
 BacklightInputEventFilter::~BacklightInputEventFilter() = default;
 
+InputEventTypes BacklightInputEventFilter::eventTypes() const
+{
+    return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+}
+
 bool BacklightInputEventFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(event)
@@ -12,16 +12,22 @@
 #include "basiceglsurfacetexture_wayland.h"
 #include "composite.h"
 #include "virtual_backend.h"
+#include "virtual_framecapture.h"
 #include "options.h"
 #include "screens.h"
 #include "softwarevsyncmonitor.h"
+#include "surfaceitem_wayland.h"
 #include "virtual_output.h"
 #include <logging.h>
 // kwin libs
 #include <kwinglplatform.h>
 #include <kwinglutils.h>
+// KWayland
+#include <KWaylandServer/shmclientbuffer.h>
+#include <KWaylandServer/surface_interface.h>
 // Qt
 #include <QOpenGLContext>
+#include <QPainter>
 
 #ifndef EGL_PLATFORM_SURFACELESS_MESA
 #define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
@@ -193,7 +199,6 @@ static void convertFromGLImage(QImage &img, int w, int h)
 void EglGbmBackend::endFrame(AbstractOutput *output, const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
     Q_UNUSED(renderedRegion)
-    Q_UNUSED(damagedRegion)
     glFlush();
 
     static_cast<VirtualOutput *>(output)->vsyncMonitor()->arm();
@@ -202,11 +207,43 @@ void EglGbmBackend::endFrame(AbstractOutput *output, const QRegion &renderedRegi
         QImage img = QImage(QSize(m_backBuffer->width(), m_backBuffer->height()), QImage::Format_ARGB32);
         glReadnPixels(0, 0, m_backBuffer->width(), m_backBuffer->height(), GL_RGBA, GL_UNSIGNED_BYTE, img.sizeInBytes(), (GLvoid*)img.bits());
         convertFromGLImage(img, m_backBuffer->width(), m_backBuffer->height());
-        img.save(QStringLiteral("%1/%2.png").arg(m_backend->saveFrames()).arg(QString::number(m_frameCounter++)));
+        m_backend->frameCapture()->capture(output, img, damagedRegion);
     }
     GLRenderTarget::popRenderTarget();
 
     eglSwapBuffers(eglDisplay(), surface());
 }
 
+bool EglGbmBackend::directScanoutAllowed(AbstractOutput *output) const
+{
+    return m_backend->isDirectScanoutEmulated() && !output->directScanoutInhibited();
+}
+
+bool EglGbmBackend::scanout(AbstractOutput *output, SurfaceItem *surfaceItem)
+{
+    SurfaceItemWayland *item = qobject_cast<SurfaceItemWayland *>(surfaceItem);
+    if (!item || !item->surface()) {
+        return false;
+    }
+    // the emulated plane reads the client buffer with the cpu, so only shm buffers can be shown
+    auto buffer = qobject_cast<KWaylandServer::ShmClientBuffer *>(item->surface()->buffer());
+    if (!buffer) {
+        return false;
+    }
+
+    if (m_backend->saveFrames()) {
+        QImage frame(output->pixelSize(), QImage::Format_RGB32);
+        frame.fill(Qt::black);
+        QPainter painter(&frame);
+        painter.scale(output->scale(), output->scale());
+        painter.translate(-output->geometry().topLeft());
+        painter.drawImage(item->mapToGlobal(item->boundingRect()), buffer->data());
+        painter.end();
+        m_backend->frameCapture()->capture(output, frame, output->geometry());
+    }
+
+    static_cast<VirtualOutput *>(output)->vsyncMonitor()->arm();
+    return true;
+}
+
 } // namespace
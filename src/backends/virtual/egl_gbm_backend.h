@@ -30,6 +30,8 @@ public:
     SurfaceTexture *createSurfaceTextureWayland(SurfacePixmapWayland *pixmap) override;
     QRegion beginFrame(AbstractOutput *output) override;
     void endFrame(AbstractOutput *output, const QRegion &renderedRegion, const QRegion &damagedRegion) override;
+    bool scanout(AbstractOutput *output, SurfaceItem *surfaceItem) override;
+    bool directScanoutAllowed(AbstractOutput *output) const override;
     void init() override;
 
 private:
@@ -39,7 +41,6 @@ private:
     VirtualBackend *m_backend;
     GLTexture *m_backBuffer = nullptr;
     GLRenderTarget *m_fbo = nullptr;
-    int m_frameCounter = 0;
 };
 
 } // namespace
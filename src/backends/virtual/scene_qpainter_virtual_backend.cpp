@@ -11,6 +11,7 @@
 #include "screens.h"
 #include "softwarevsyncmonitor.h"
 #include "virtual_backend.h"
+#include "virtual_framecapture.h"
 #include "virtual_output.h"
 
 #include <QPainter>
@@ -51,12 +52,11 @@ void VirtualQPainterBackend::createOutputs()
 void VirtualQPainterBackend::endFrame(AbstractOutput *output, const QRegion &renderedRegion, const QRegion &damagedRegion)
 {
     Q_UNUSED(renderedRegion)
-    Q_UNUSED(damagedRegion)
 
     static_cast<VirtualOutput *>(output)->vsyncMonitor()->arm();
 
     if (m_backend->saveFrames()) {
-        m_backBuffers[output].save(QStringLiteral("%1/%s-%3.png").arg(m_backend->screenshotDirPath(), output->name(), QString::number(m_frameCounter++)));
+        m_backend->frameCapture()->capture(output, m_backBuffers[output], damagedRegion);
     }
 }
 
@@ -36,7 +36,6 @@ private:
 
     QMap<AbstractOutput *, QImage> m_backBuffers;
     VirtualBackend *m_backend;
-    int m_frameCounter = 0;
 };
 
 }
@@ -7,6 +7,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "virtual_backend.h"
+#include "virtual_framecapture.h"
 #include "virtual_output.h"
 #include "scene_qpainter_virtual_backend.h"
 #include "session.h"
@@ -157,6 +158,9 @@ VirtualBackend::VirtualBackend(QObject *parent)
             m_screenshotDir.reset();
         }
         if (!m_screenshotDir.isNull()) {
+            // the captured frames are meant to be inspected or replayed after the session
+            m_screenshotDir->setAutoRemove(false);
+            m_frameCapture.reset(new VirtualFrameCapture(m_screenshotDir->path(), VirtualFrameCapture::defaultFormat()));
             qDebug() << "Screenshots saved to: " << m_screenshotDir->path();
         }
     }
@@ -224,6 +228,11 @@ QString VirtualBackend::screenshotDirPath() const
     return m_screenshotDir->path();
 }
 
+VirtualFrameCapture *VirtualBackend::frameCapture() const
+{
+    return m_frameCapture.data();
+}
+
 InputBackend *VirtualBackend::createInputBackend()
 {
     return new VirtualInputBackend(this);
@@ -318,4 +327,9 @@ void VirtualBackend::removeOutput(AbstractOutput *output)
     Q_EMIT screensQueried();
 }
 
+void VirtualBackend::setDirectScanoutEmulated(bool emulated)
+{
+    m_directScanoutEmulated = emulated;
+}
+
 }
@@ -23,6 +23,7 @@ class QTemporaryDir;
 namespace KWin
 {
 class VirtualBackend;
+class VirtualFrameCapture;
 class VirtualOutput;
 
 class VirtualInputDevice : public InputDevice
@@ -93,6 +94,10 @@ public:
         return !m_screenshotDir.isNull();
     }
     QString screenshotDirPath() const;
+    /**
+     * Returns the sink for the rendered frames if saveFrames() is @c true, otherwise @c null.
+     */
+    VirtualFrameCapture *frameCapture() const;
 
     VirtualInputDevice *virtualPointer() const;
     VirtualInputDevice *virtualKeyboard() const;
@@ -118,6 +123,16 @@ public:
 
     Q_INVOKABLE void removeOutput(AbstractOutput *output);
 
+    /**
+     * There are no planes to scan out from, but the compositor's direct scanout path can be
+     * exercised in tests by letting the OpenGL backend pretend that shm client buffers get
+     * scanned out. The scanned out buffers are still captured if saveFrames() is @c true.
+     */
+    bool isDirectScanoutEmulated() const {
+        return m_directScanoutEmulated;
+    }
+    Q_INVOKABLE void setDirectScanoutEmulated(bool emulated);
+
 Q_SIGNALS:
     void virtualOutputsSet(bool countChanged);
 
@@ -125,7 +140,9 @@ private:
     QVector<VirtualOutput*> m_outputs;
     QVector<VirtualOutput*> m_outputsEnabled;
     QScopedPointer<QTemporaryDir> m_screenshotDir;
+    QScopedPointer<VirtualFrameCapture> m_frameCapture;
     Session *m_session;
+    bool m_directScanoutEmulated = false;
 
     QScopedPointer<VirtualInputDevice> m_virtualPointer;
     QScopedPointer<VirtualInputDevice> m_virtualKeyboard;
@@ -0,0 +1,215 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "virtual_framecapture.h"
+#include "abstract_output.h"
+#include "logging.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace KWin
+{
+
+// Keeps the frame headers and the pixel data in the ring file 64 byte aligned.
+static constexpr quint64 alignedSize(quint64 size)
+{
+    return (size + 63) & ~quint64(63);
+}
+
+static int ringSlotCount()
+{
+    static const int count = [] {
+        bool ok = false;
+        const int count = qEnvironmentVariableIntValue("KWIN_WAYLAND_VIRTUAL_CAPTURE_SLOTS", &ok);
+        return ok && count > 0 ? count : 16;
+    }();
+    return count;
+}
+
+VirtualFrameCapture::Format VirtualFrameCapture::defaultFormat()
+{
+    if (qgetenv("KWIN_WAYLAND_VIRTUAL_CAPTURE_FORMAT") == QByteArrayLiteral("raw")) {
+        return Format::Raw;
+    }
+    return Format::Png;
+}
+
+VirtualFrameCapture::VirtualFrameCapture(const QString &directory, Format format)
+    : m_directory(directory)
+    , m_format(format)
+{
+    // Allow the encoder to fall behind by two frames per thread before blocking the compositor.
+    m_encoderPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+    m_pendingFrames.release(m_encoderPool.maxThreadCount() * 2);
+}
+
+VirtualFrameCapture::~VirtualFrameCapture()
+{
+    m_encoderPool.waitForDone();
+    for (Ring &ring : m_rings) {
+        closeRing(ring);
+    }
+    if (m_frameCount) {
+        qCDebug(KWIN_VIRTUAL) << "Captured" << m_frameCount << "frames, average capture time:"
+                              << m_captureTime / m_frameCount << "ns";
+    }
+}
+
+void VirtualFrameCapture::capture(AbstractOutput *output, const QImage &image, const QRegion &damage)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    switch (m_format) {
+    case Format::Png:
+        capturePng(output, image);
+        break;
+    case Format::Raw:
+        captureRaw(output, image, mapToDevice(output, damage));
+        break;
+    }
+
+    m_previousCaptureTime = timer.nsecsElapsed();
+    m_captureTime += m_previousCaptureTime;
+    m_frameCount++;
+}
+
+QRegion VirtualFrameCapture::mapToDevice(AbstractOutput *output, const QRegion &damage)
+{
+    const qreal scale = output->scale();
+    QRegion deviceDamage;
+    for (const QRect &rect : damage) {
+        const QRectF local = rect.translated(-output->geometry().topLeft());
+        deviceDamage += QRectF(local.topLeft() * scale, local.size() * scale).toAlignedRect();
+    }
+    return deviceDamage;
+}
+
+void VirtualFrameCapture::capturePng(AbstractOutput *output, const QImage &image)
+{
+    const QString fileName = QStringLiteral("%1/%2-%3.png").arg(m_directory, output->name(), QString::number(m_sequences[output]++));
+
+    // The image shares its data with the back buffer, the back buffer gets detached once
+    // the next frame is painted.
+    m_pendingFrames.acquire();
+    m_encoderPool.start([this, image, fileName]() {
+        image.save(fileName);
+        m_pendingFrames.release();
+    });
+}
+
+bool VirtualFrameCapture::openRing(Ring &ring, AbstractOutput *output, const QImage &image)
+{
+    closeRing(ring);
+
+    const QString fileName = QDir(m_directory).filePath(output->name() + QStringLiteral(".ring"));
+    ring.fd = ::open(QFile::encodeName(fileName).constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (ring.fd == -1) {
+        qCWarning(KWIN_VIRTUAL) << "Failed to create" << fileName << strerror(errno);
+        return false;
+    }
+
+    ring.imageSize = image.size();
+    ring.slotCount = ringSlotCount();
+    ring.slotSize = alignedSize(sizeof(FrameHeader)) + alignedSize(image.sizeInBytes());
+    ring.size = alignedSize(sizeof(RingHeader)) + ring.slotCount * ring.slotSize;
+    if (ftruncate(ring.fd, ring.size) == -1) {
+        qCWarning(KWIN_VIRTUAL) << "Failed to resize" << fileName << strerror(errno);
+        closeRing(ring);
+        return false;
+    }
+
+    void *data = mmap(nullptr, ring.size, PROT_READ | PROT_WRITE, MAP_SHARED, ring.fd, 0);
+    if (data == MAP_FAILED) {
+        qCWarning(KWIN_VIRTUAL) << "Failed to map" << fileName << strerror(errno);
+        closeRing(ring);
+        return false;
+    }
+    ring.data = static_cast<uchar *>(data);
+
+    RingHeader *header = reinterpret_cast<RingHeader *>(ring.data);
+    std::memcpy(header->magic, "KWINRING", sizeof(header->magic));
+    header->version = ringVersion;
+    header->slotCount = ring.slotCount;
+    header->slotSize = ring.slotSize;
+    header->frameCount = 0;
+    return true;
+}
+
+void VirtualFrameCapture::closeRing(Ring &ring)
+{
+    if (ring.data) {
+        munmap(ring.data, ring.size);
+        ring.data = nullptr;
+    }
+    if (ring.fd != -1) {
+        ::close(ring.fd);
+        ring.fd = -1;
+    }
+}
+
+void VirtualFrameCapture::captureRaw(AbstractOutput *output, const QImage &image, const QRegion &damage)
+{
+    Ring &ring = m_rings[output];
+    if (ring.imageSize != image.size() || !ring.data) {
+        if (!openRing(ring, output, image)) {
+            return;
+        }
+    }
+
+    RingHeader *ringHeader = reinterpret_cast<RingHeader *>(ring.data);
+    const quint64 sequence = ringHeader->frameCount;
+    uchar *slot = ring.data + alignedSize(sizeof(RingHeader)) + (sequence % ring.slotCount) * ring.slotSize;
+
+    FrameHeader *header = reinterpret_cast<FrameHeader *>(slot);
+    header->sequence = std::numeric_limits<quint64>::max();
+    header->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    header->previousCaptureTime = m_previousCaptureTime;
+    header->width = image.width();
+    header->height = image.height();
+    header->stride = image.bytesPerLine();
+    header->format = image.format();
+
+    if (damage.rectCount() <= maxDamageRects) {
+        header->damageRectCount = 0;
+        for (const QRect &rect : damage) {
+            qint32 *out = header->damageRects[header->damageRectCount++];
+            out[0] = rect.x();
+            out[1] = rect.y();
+            out[2] = rect.width();
+            out[3] = rect.height();
+        }
+    } else {
+        const QRect bounds = damage.boundingRect();
+        header->damageRectCount = 1;
+        header->damageRects[0][0] = bounds.x();
+        header->damageRects[0][1] = bounds.y();
+        header->damageRects[0][2] = bounds.width();
+        header->damageRects[0][3] = bounds.height();
+    }
+
+    std::memcpy(slot + alignedSize(sizeof(FrameHeader)), image.constBits(), image.sizeInBytes());
+
+    header->sequence = sequence;
+    ringHeader->frameCount = sequence + 1;
+}
+
+} // namespace KWin
@@ -0,0 +1,120 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QRegion>
+#include <QSemaphore>
+#include <QString>
+#include <QThreadPool>
+
+namespace KWin
+{
+
+class AbstractOutput;
+
+/**
+ * The VirtualFrameCapture class stores the frames rendered by the virtual backend.
+ *
+ * In the Png format, every frame is saved as a PNG file. The frames are encoded on a
+ * thread pool, so the compositor is only blocked if the encoder falls behind by more
+ * than a few frames.
+ *
+ * In the Raw format, the frames are copied unencoded into a memory-mapped ring file
+ * per output, named after the output with the ".ring" suffix. The file starts with a
+ * RingHeader, followed by slotCount slots of slotSize bytes. Every slot starts with a
+ * FrameHeader, followed by the pixel data. The headers and the pixel data start at
+ * offsets that are multiples of 64 bytes. The frame with the sequence number n is
+ * stored in the slot n % slotCount. The sequence number of a slot is written after
+ * the pixel data, so a slot whose sequence number is not smaller than frameCount is
+ * being written. The ring file is recreated when the size of the output changes.
+ */
+class VirtualFrameCapture
+{
+public:
+    enum class Format {
+        Png,
+        Raw,
+    };
+
+    static constexpr int maxDamageRects = 16;
+    static constexpr quint32 ringVersion = 1;
+
+    struct RingHeader
+    {
+        char magic[8];
+        quint32 version;
+        quint32 slotCount;
+        quint64 slotSize;
+        quint64 frameCount;
+    };
+
+    struct FrameHeader
+    {
+        quint64 sequence;
+        /// The time when the frame has been rendered, in nanoseconds of the monotonic clock.
+        quint64 timestamp;
+        /// How long it took to capture the previous frame, in nanoseconds.
+        quint64 previousCaptureTime;
+        quint32 width;
+        quint32 height;
+        quint32 stride;
+        /// The pixel format, a QImage::Format value.
+        quint32 format;
+        /// The damage rectangles as x, y, width, height; if there are more than
+        /// maxDamageRects rectangles, the bounding rectangle is stored.
+        quint32 damageRectCount;
+        qint32 damageRects[maxDamageRects][4];
+    };
+
+    VirtualFrameCapture(const QString &directory, Format format);
+    ~VirtualFrameCapture();
+
+    /**
+     * Captures the @a image that has been rendered for the given @a output. The @a damage
+     * is in global logical coordinates, it's stored in the device coordinates of the image.
+     */
+    void capture(AbstractOutput *output, const QImage &image, const QRegion &damage);
+
+    /**
+     * Returns the format selected with the KWIN_WAYLAND_VIRTUAL_CAPTURE_FORMAT environment
+     * variable, either "png" or "raw".
+     */
+    static Format defaultFormat();
+
+private:
+    struct Ring
+    {
+        int fd = -1;
+        uchar *data = nullptr;
+        size_t size = 0;
+        QSize imageSize;
+        quint32 slotCount = 0;
+        quint64 slotSize = 0;
+    };
+
+    static QRegion mapToDevice(AbstractOutput *output, const QRegion &damage);
+    void capturePng(AbstractOutput *output, const QImage &image);
+    void captureRaw(AbstractOutput *output, const QImage &image, const QRegion &damage);
+    bool openRing(Ring &ring, AbstractOutput *output, const QImage &image);
+    void closeRing(Ring &ring);
+
+    QString m_directory;
+    Format m_format;
+    QHash<AbstractOutput *, Ring> m_rings;
+    QHash<AbstractOutput *, quint64> m_sequences;
+    QThreadPool m_encoderPool;
+    QSemaphore m_pendingFrames;
+    qint64 m_previousCaptureTime = 0;
+    qint64 m_captureTime = 0;
+    qint64 m_frameCount = 0;
+};
+
+} // namespace KWin
@@ -52,6 +52,7 @@ WaylandQPainterOutput::~WaylandQPainterOutput()
 bool WaylandQPainterOutput::init(KWayland::Client::ShmPool *pool)
 {
     m_pool = pool;
+    m_currentSize = nativeSize();
 
     connect(pool, &KWayland::Client::ShmPool::poolResized, this, &WaylandQPainterOutput::remapBuffer);
     connect(m_waylandOutput, &WaylandOutput::sizeChanged, this, &WaylandQPainterOutput::updateSize);
@@ -59,13 +60,18 @@ bool WaylandQPainterOutput::init(KWayland::Client::ShmPool *pool)
     return true;
 }
 
+QSize WaylandQPainterOutput::nativeSize() const
+{
+    return m_waylandOutput->geometry().size() * m_waylandOutput->scale();
+}
+
 void WaylandQPainterOutput::remapBuffer()
 {
     qCDebug(KWIN_WAYLAND_BACKEND) << "Remapped back buffer of surface" << m_waylandOutput->surface();
 
-    const QSize nativeSize(m_waylandOutput->geometry().size() * m_waylandOutput->scale());
     for (WaylandQPainterBufferSlot *slot : qAsConst(m_slots)) {
-        slot->image = QImage(slot->buffer->address(), nativeSize.width(), nativeSize.height(), QImage::Format_ARGB32);
+        const QSize size = slot->buffer->size();
+        slot->image = QImage(slot->buffer->address(), size.width(), size.height(), QImage::Format_RGB32);
     }
 }
 
@@ -73,8 +79,26 @@ void WaylandQPainterOutput::updateSize(const QSize &size)
 {
     Q_UNUSED(size)
     m_back = nullptr;
-    qDeleteAll(m_slots);
-    m_slots.clear();
+    m_damageJournal.clear();
+
+    const QSize newSize = nativeSize();
+    if (newSize != m_currentSize) {
+        m_previousSize = m_currentSize;
+        m_currentSize = newSize;
+    }
+
+    for (auto it = m_slots.begin(); it != m_slots.end();) {
+        WaylandQPainterBufferSlot *slot = *it;
+        const QSize slotSize = slot->buffer->size();
+        if (slotSize == m_currentSize || slotSize == m_previousSize) {
+            // the contents of the buffer are stale, it has to be repainted completely
+            slot->age = 0;
+            ++it;
+        } else {
+            delete slot;
+            it = m_slots.erase(it);
+        }
+    }
 }
 
 void WaylandQPainterOutput::present(const QRegion &damage)
@@ -87,10 +111,18 @@ void WaylandQPainterOutput::present(const QRegion &damage)
         }
     }
 
+    // Only tell the host compositor about the parts that actually changed, so it doesn't
+    // have to upload and repaint the whole buffer.
+    const qreal scale = m_waylandOutput->scale();
+    QRegion bufferDamage;
+    for (const QRect &rect : damage) {
+        bufferDamage += QRectF(rect.x() * scale, rect.y() * scale, rect.width() * scale, rect.height() * scale).toAlignedRect();
+    }
+
     auto s = m_waylandOutput->surface();
     s->attachBuffer(m_back->buffer);
-    s->damage(damage);
-    s->setScale(std::ceil(m_waylandOutput->scale()));
+    s->damageBuffer(bufferDamage & QRect(QPoint(0, 0), m_back->buffer->size()));
+    s->setScale(std::ceil(scale));
     s->commit();
 
     m_damageJournal.add(damage);
@@ -103,15 +135,15 @@ WaylandQPainterBufferSlot *WaylandQPainterOutput::back() const
 
 WaylandQPainterBufferSlot *WaylandQPainterOutput::acquire()
 {
+    const QSize nativeSize = this->nativeSize();
     for (WaylandQPainterBufferSlot *slot : qAsConst(m_slots)) {
-        if (slot->buffer->isReleased()) {
+        if (slot->buffer->size() == nativeSize && slot->buffer->isReleased()) {
             m_back = slot;
             slot->buffer->setReleased(false);
             return m_back;
         }
     }
 
-    const QSize nativeSize(m_waylandOutput->geometry().size() * m_waylandOutput->scale());
     auto buffer = m_pool->getBuffer(nativeSize, nativeSize.width() * 4).toStrongRef();
     if (!buffer) {
         qCDebug(KWIN_WAYLAND_BACKEND) << "Did not get a new Buffer from Shm Pool";
@@ -66,11 +66,21 @@ public:
     QRegion mapToLocal(const QRegion &region) const;
 
 private:
+    QSize nativeSize() const;
+
     WaylandOutput *m_waylandOutput;
     KWayland::Client::ShmPool *m_pool;
     DamageJournal m_damageJournal;
 
+    /**
+     * The slots of the current size and of the previous size. The slots of the previous
+     * size are kept around, so they can be reused without allocating new buffers from the
+     * shm pool if the output is resized back, e.g. when the host window is maximized and
+     * restored.
+     */
     QVector<WaylandQPainterBufferSlot *> m_slots;
+    QSize m_currentSize;
+    QSize m_previousSize;
     WaylandQPainterBufferSlot *m_back = nullptr;
 
     friend class WaylandQPainterBackend;
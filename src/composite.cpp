@@ -129,6 +129,14 @@ Compositor::Compositor(QObject* workspace)
     connect(&m_unusedSupportPropertyTimer, &QTimer::timeout,
             this, &Compositor::deleteUnusedSupportProperties);
 
+    // Windows that didn't contribute any pixels to a frame get their frame callbacks
+    // at a low rate only, so hidden clients don't keep rendering at full speed.
+    static const int occludedFrameInterval = 1000;
+    m_occludedFrameTimer.setInterval(occludedFrameInterval);
+    m_occludedFrameTimer.setSingleShot(true);
+    connect(&m_occludedFrameTimer, &QTimer::timeout,
+            this, &Compositor::sendOccludedFrameCallbacks);
+
     // Delay the call to start by one event cycle.
     // The ctor of this class is invoked from the Workspace ctor, that means before
     // Workspace is completely constructed, so calling Workspace::self() would result
@@ -402,6 +410,8 @@ void Compositor::registerRenderLoop(RenderLoop *renderLoop, AbstractOutput *outp
     Q_ASSERT(!m_renderLoops.contains(renderLoop));
     m_renderLoops.insert(renderLoop, output);
     connect(renderLoop, &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    connect(renderLoop, &RenderLoop::framePresented, this, &Compositor::handleFramePresented);
+    connect(renderLoop, &RenderLoop::frameFailed, this, &Compositor::handleFrameFailed);
 }
 
 void Compositor::unregisterRenderLoop(RenderLoop *renderLoop)
@@ -409,6 +419,10 @@ void Compositor::unregisterRenderLoop(RenderLoop *renderLoop)
     Q_ASSERT(m_renderLoops.contains(renderLoop));
     m_renderLoops.remove(renderLoop);
     disconnect(renderLoop, &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    disconnect(renderLoop, &RenderLoop::framePresented, this, &Compositor::handleFramePresented);
+    disconnect(renderLoop, &RenderLoop::frameFailed, this, &Compositor::handleFrameFailed);
+    // don't leave the clients waiting for a frame that will never be presented
+    sendFrameCallbacks(renderLoop, std::chrono::steady_clock::now().time_since_epoch());
 }
 
 void Compositor::handleOutputEnabled(AbstractOutput *output)
@@ -630,11 +644,17 @@ void Compositor::composite(RenderLoop *renderLoop)
     const QRegion repaints = m_scene->repaints(output);
     m_scene->resetRepaints(output);
 
+    if (m_pendingFrameCallbacks.contains(renderLoop)) {
+        // the previous frame has neither been presented nor failed, e.g. the render loop
+        // has been reset in the meantime
+        sendFrameCallbacks(renderLoop, std::chrono::steady_clock::now().time_since_epoch());
+    }
+
     m_scene->paint(output, repaints, windows, renderLoop);
 
     if (waylandServer()) {
-        const std::chrono::milliseconds frameTime =
-                std::chrono::duration_cast<std::chrono::milliseconds>(renderLoop->lastPresentationTimestamp());
+        // The frame callbacks are sent when the frame is actually presented on the screen.
+        PendingFrameCallbacks &frameCallbacks = m_pendingFrameCallbacks[renderLoop];
 
         for (Toplevel *window : windows) {
             if (!window->readyForPainting()) {
@@ -647,19 +667,70 @@ void Compositor::composite(RenderLoop *renderLoop)
             if (!window->isOnOutput(output)) {
                 continue;
             }
+            if (m_scene->isWindowOccluded(window, output)) {
+                if (!m_occludedWindows.contains(window)) {
+                    m_occludedWindows.append(window);
+                }
+                if (!m_occludedFrameTimer.isActive()) {
+                    m_occludedFrameTimer.start();
+                }
+                continue;
+            }
             if (auto surface = window->surface()) {
-                surface->frameRendered(frameTime.count());
+                frameCallbacks.surfaces.append(surface);
             }
         }
         if (!Cursors::self()->isCursorHidden()) {
             Cursor *cursor = Cursors::self()->currentCursor();
             if (cursor->geometry().intersects(output->geometry())) {
-                cursor->markAsRendered(frameTime);
+                frameCallbacks.cursor = true;
             }
         }
     }
 }
 
+void Compositor::handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp)
+{
+    sendFrameCallbacks(renderLoop, timestamp);
+}
+
+void Compositor::handleFrameFailed(RenderLoop *renderLoop)
+{
+    // the clients should keep going even if the frame didn't make it to the screen
+    sendFrameCallbacks(renderLoop, std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void Compositor::sendFrameCallbacks(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp)
+{
+    const PendingFrameCallbacks frameCallbacks = m_pendingFrameCallbacks.take(renderLoop);
+    const std::chrono::milliseconds frameTime =
+            std::chrono::duration_cast<std::chrono::milliseconds>(timestamp);
+
+    for (const QPointer<KWaylandServer::SurfaceInterface> &surface : frameCallbacks.surfaces) {
+        if (surface) {
+            surface->frameRendered(frameTime.count());
+        }
+    }
+    if (frameCallbacks.cursor) {
+        Cursors::self()->currentCursor()->markAsRendered(frameTime);
+    }
+}
+
+void Compositor::sendOccludedFrameCallbacks()
+{
+    const std::chrono::milliseconds frameTime =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    for (const QPointer<Toplevel> &window : qAsConst(m_occludedWindows)) {
+        if (!window) {
+            continue;
+        }
+        if (auto surface = window->surface()) {
+            surface->frameRendered(frameTime.count());
+        }
+    }
+    m_occludedWindows.clear();
+}
+
 bool Compositor::isActive()
 {
     return m_state == State::On;
@@ -814,29 +885,24 @@ void X11Compositor::composite(RenderLoop *renderLoop)
     }
 
     QList<Toplevel *> windows = Workspace::self()->xStackingOrder();
-    QList<SurfaceItemX11 *> dirtyItems;
+    bool damaged = false;
 
-    // Reset the damage state of each window and fetch the damage region
-    // without waiting for a reply
+    // Collect the damage that has been reported by the DamageNotify events and reset the
+    // damage objects, no reply has to be waited for
     for (Toplevel *window : qAsConst(windows)) {
         SurfaceItemX11 *surfaceItem = static_cast<SurfaceItemX11 *>(window->surfaceItem());
         if (surfaceItem->fetchDamage()) {
-            dirtyItems.append(surfaceItem);
+            damaged = true;
         }
     }
 
-    if (dirtyItems.count() > 0) {
+    if (damaged) {
         if (m_syncManager) {
             m_syncManager->triggerFence();
         }
         xcb_flush(kwinApp()->x11Connection());
     }
 
-    // Get the replies
-    for (SurfaceItemX11 *item : qAsConst(dirtyItems)) {
-        item->waitForDamage();
-    }
-
     if (m_framesToTestForSafety > 0 && (backend()->compositingType() & OpenGLCompositing)) {
         kwinApp()->platform()->createOpenGLSafePoint(Platform::OpenGLSafePoint::PreFrame);
     }
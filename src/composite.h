@@ -11,10 +11,17 @@
 
 #include <kwinglobals.h>
 
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QTimer>
 #include <QRegion>
 
+namespace KWaylandServer
+{
+class SurfaceInterface;
+}
+
 namespace KWin
 {
 
@@ -119,6 +126,8 @@ protected Q_SLOTS:
 
 private Q_SLOTS:
     void handleFrameRequested(RenderLoop *renderLoop);
+    void handleFramePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp);
+    void handleFrameFailed(RenderLoop *renderLoop);
     void handleOutputEnabled(AbstractOutput *output);
     void handleOutputDisabled(AbstractOutput *output);
 
@@ -128,6 +137,8 @@ private:
 
     void releaseCompositorSelection();
     void deleteUnusedSupportProperties();
+    void sendOccludedFrameCallbacks();
+    void sendFrameCallbacks(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp);
 
     void registerRenderLoop(RenderLoop *renderLoop, AbstractOutput *output);
     void unregisterRenderLoop(RenderLoop *renderLoop);
@@ -140,6 +151,18 @@ private:
     QTimer m_releaseSelectionTimer;
     QList<xcb_atom_t> m_unusedSupportProperties;
     QTimer m_unusedSupportPropertyTimer;
+    QTimer m_occludedFrameTimer;
+    QVector<QPointer<Toplevel>> m_occludedWindows;
+
+    /**
+     * Surfaces that have been painted in a frame which hasn't been presented yet.
+     */
+    struct PendingFrameCallbacks
+    {
+        QVector<QPointer<KWaylandServer::SurfaceInterface>> surfaces;
+        bool cursor = false;
+    };
+    QHash<RenderLoop *, PendingFrameCallbacks> m_pendingFrameCallbacks;
     Scene *m_scene = nullptr;
     RenderBackend *m_backend = nullptr;
     QMap<RenderLoop *, AbstractOutput *> m_renderLoops;
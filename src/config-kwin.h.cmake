@@ -23,6 +23,7 @@
 #cmakedefine01 HAVE_SYS_PROCCTL_H
 #cmakedefine01 HAVE_PROC_TRACE_CTL
 #cmakedefine01 HAVE_SYS_SYSMACROS_H
+#cmakedefine01 HAVE_SYS_TIMERFD_H
 #cmakedefine01 HAVE_BREEZE_DECO
 #cmakedefine01 HAVE_LIBCAP
 #cmakedefine01 HAVE_SCHED_RESET_ON_FORK
@@ -47,3 +48,4 @@
 #cmakedefine PipeWire_FOUND 1
 
 #cmakedefine HAVE_XWAYLAND_LISTENFD
+#cmakedefine HAVE_XWAYLAND_TERMINATE_DELAY
@@ -210,6 +210,11 @@ void Cursor::markAsRendered(std::chrono::milliseconds timestamp)
     Q_EMIT rendered(timestamp);
 }
 
+std::chrono::microseconds Cursor::lastMotionTimestamp() const
+{
+    return std::chrono::microseconds::zero();
+}
+
 xcb_cursor_t Cursor::x11Cursor(CursorShape shape)
 {
     return x11Cursor(shape.name());
@@ -167,6 +167,11 @@ public:
 
     void updateCursor(const QImage &image, const QPoint &hotspot);
     void markAsRendered(std::chrono::milliseconds timestamp);
+    /**
+     * The timestamp of the input event that last moved the cursor, in the clock domain of the
+     * input events. The base implementation returns zero, as the cursor isn't moved by input.
+     */
+    virtual std::chrono::microseconds lastMotionTimestamp() const;
 
 Q_SIGNALS:
     void posChanged(const QPoint& pos);
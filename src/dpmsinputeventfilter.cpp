@@ -29,6 +29,11 @@ DpmsInputEventFilter::DpmsInputEventFilter()
 
 DpmsInputEventFilter::~DpmsInputEventFilter() = default;
 
+InputEventTypes DpmsInputEventFilter::eventTypes() const
+{
+    return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+}
+
 bool DpmsInputEventFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(event)
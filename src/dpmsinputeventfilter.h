@@ -25,6 +25,7 @@ public:
     DpmsInputEventFilter();
     ~DpmsInputEventFilter() override;
 
+    InputEventTypes eventTypes() const override;
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override;
     bool wheelEvent(QWheelEvent *event) override;
     bool keyEvent(QKeyEvent *event) override;
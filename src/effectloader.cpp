@@ -14,6 +14,7 @@
 #include "plugin.h"
 #include "scripting/scriptedeffect.h"
 #include "utils/common.h"
+#include "utils/startupphase.h"
 // KDE
 #include <KConfigGroup>
 #include <KPackage/Package>
@@ -192,9 +193,15 @@ void ScriptedEffectLoader::clear()
     m_queue->clear();
 }
 
+static const QString s_defaultPluginSubDirectory = QStringLiteral("kwin/effects/plugins");
+
+// Plugin effect metadata that has been looked up ahead of time by prefetchEffects().
+static QFuture<QVector<KPluginMetaData>> s_prefetchedEffects;
+static bool s_hasPrefetchedEffects = false;
+
 PluginEffectLoader::PluginEffectLoader(QObject *parent)
     : AbstractEffectLoader(parent)
-    , m_pluginSubDirectory(QStringLiteral("kwin/effects/plugins"))
+    , m_pluginSubDirectory(s_defaultPluginSubDirectory)
 {
 }
 
@@ -327,9 +334,27 @@ bool PluginEffectLoader::loadEffect(const KPluginMetaData &info, LoadEffectFlags
     return true;
 }
 
+void PluginEffectLoader::prefetchEffects()
+{
+    s_prefetchedEffects = QtConcurrent::run([]() {
+        StartupPhase phase(QStringLiteral("effect metadata"));
+        return KPluginMetaData::findPlugins(s_defaultPluginSubDirectory);
+    });
+    s_hasPrefetchedEffects = true;
+}
+
 void PluginEffectLoader::queryAndLoadAll()
 {
-    const auto effects = findAllEffects();
+    QVector<KPluginMetaData> effects;
+    if (s_hasPrefetchedEffects && m_pluginSubDirectory == s_defaultPluginSubDirectory) {
+        effects = s_prefetchedEffects.result();
+    } else {
+        effects = findAllEffects();
+    }
+    // The prefetched list is only good for the first query, it may be stale afterwards.
+    s_prefetchedEffects = QFuture<QVector<KPluginMetaData>>();
+    s_hasPrefetchedEffects = false;
+
     for (const auto &effect : effects) {
         const LoadEffectFlags flags = readConfig(effect.pluginId(), effect.isEnabledByDefault());
         if (flags.testFlag(LoadEffectFlag::Load)) {
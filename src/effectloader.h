@@ -312,6 +312,13 @@ public:
 
     void setPluginSubDirectory(const QString &directory);
 
+    /**
+     * Starts looking up the metadata of all plugin effects in a worker thread. The first
+     * call to queryAndLoadAll() picks up the result instead of scanning the plugin
+     * directory on the main thread.
+     */
+    static void prefetchEffects();
+
 private:
     QVector<KPluginMetaData> findAllEffects() const;
     KPluginMetaData findEffect(const QString &name) const;
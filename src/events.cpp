@@ -483,7 +483,7 @@ bool X11Client::windowEvent(xcb_generic_event_t *e)
             updateShape();
         }
         if (eventType == Xcb::Extensions::self()->damageNotifyEvent() && reinterpret_cast<xcb_damage_notify_event_t*>(e)->drawable == frameId())
-            damageNotifyEvent();
+            damageNotifyEvent(reinterpret_cast<xcb_damage_notify_event_t*>(e));
         break;
     }
     return true; // eat all events
@@ -1244,7 +1244,7 @@ bool Unmanaged::windowEvent(xcb_generic_event_t *e)
             Q_EMIT geometryShapeChanged(this, frameGeometry());
         }
         if (eventType == Xcb::Extensions::self()->damageNotifyEvent())
-            damageNotifyEvent();
+            damageNotifyEvent(reinterpret_cast<xcb_damage_notify_event_t*>(e));
         break;
     }
     }
@@ -9,6 +9,7 @@
 #include "gestures.h"
 
 #include <QRect>
+#include <algorithm>
 #include <functional>
 #include <cmath>
 
@@ -62,6 +63,68 @@ bool SwipeGesture::minimumDeltaReached(const QSizeF &delta) const
     return minimumDeltaReachedProgress(delta) >= 1.0;
 }
 
+// the time span of samples which is used for estimating the velocity of a gesture
+static const std::chrono::milliseconds s_velocityWindow(40);
+// never extrapolate further than this, the gesture may change its direction at any time
+static const std::chrono::milliseconds s_maximumPrediction(25);
+
+GestureProgressResampler::GestureProgressResampler(QObject *parent)
+    : QObject(parent)
+{
+}
+
+GestureProgressResampler::~GestureProgressResampler() = default;
+
+void GestureProgressResampler::addSample(qreal progress, std::chrono::nanoseconds timestamp)
+{
+    m_samples.append(Sample{progress, timestamp});
+    // keep one sample older than the velocity window so that the window is covered entirely
+    while (m_samples.count() > 2 && timestamp - m_samples[1].timestamp > s_velocityWindow) {
+        m_samples.removeFirst();
+    }
+    m_pendingUpdate = true;
+}
+
+qreal GestureProgressResampler::predictedProgress(std::chrono::nanoseconds presentationTime) const
+{
+    if (m_samples.isEmpty()) {
+        return 0.0;
+    }
+    const Sample &last = m_samples.last();
+    const Sample &first = m_samples.first();
+    if (!m_predictionEnabled || presentationTime <= last.timestamp || last.timestamp <= first.timestamp) {
+        return last.progress;
+    }
+    const std::chrono::duration<qreal> span = last.timestamp - first.timestamp;
+    const std::chrono::duration<qreal> horizon = std::min<std::chrono::nanoseconds>(presentationTime - last.timestamp, s_maximumPrediction);
+    const qreal velocity = (last.progress - first.progress) / span.count();
+    return std::clamp(last.progress + velocity * horizon.count(), 0.0, 1.0);
+}
+
+void GestureProgressResampler::frame(std::chrono::nanoseconds presentationTime)
+{
+    if (!m_pendingUpdate) {
+        return;
+    }
+    m_pendingUpdate = false;
+    Q_EMIT progress(predictedProgress(presentationTime));
+}
+
+void GestureProgressResampler::flush()
+{
+    if (!m_pendingUpdate) {
+        return;
+    }
+    m_pendingUpdate = false;
+    Q_EMIT progress(m_samples.last().progress);
+}
+
+void GestureProgressResampler::reset()
+{
+    m_samples.clear();
+    m_pendingUpdate = false;
+}
+
 GestureRecognizer::GestureRecognizer(QObject *parent)
     : QObject(parent)
 {
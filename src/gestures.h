@@ -17,6 +17,8 @@
 #include <QMap>
 #include <QVector>
 
+#include <chrono>
+
 namespace KWin
 {
 
@@ -170,6 +172,67 @@ private:
     QSizeF m_minimumDelta;
 };
 
+/**
+ * Resamples the progress reported by a gesture to the frames of a render loop.
+ *
+ * Raw progress updates are collected together with their timestamps and at most one
+ * update is emitted per frame. The emitted progress is extrapolated from the recent
+ * velocity of the gesture to the time at which the frame is going to be presented,
+ * which hides the latency between the input event and the frame on screen.
+ */
+class KWIN_EXPORT GestureProgressResampler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GestureProgressResampler(QObject *parent = nullptr);
+    ~GestureProgressResampler() override;
+
+    bool isPredictionEnabled() const {
+        return m_predictionEnabled;
+    }
+    void setPredictionEnabled(bool enabled) {
+        m_predictionEnabled = enabled;
+    }
+
+    /**
+     * Adds a raw progress update which happened at @p timestamp.
+     */
+    void addSample(qreal progress, std::chrono::nanoseconds timestamp);
+    /**
+     * @returns whether there are updates which haven't been emitted yet
+     */
+    bool hasPendingUpdate() const {
+        return m_pendingUpdate;
+    }
+    /**
+     * @returns the progress predicted for @p presentationTime
+     */
+    qreal predictedProgress(std::chrono::nanoseconds presentationTime) const;
+    /**
+     * Emits the progress for a frame that is going to be presented at @p presentationTime,
+     * if the progress has been updated since the last frame.
+     */
+    void frame(std::chrono::nanoseconds presentationTime);
+    /**
+     * Emits the last raw progress without any prediction if it hasn't been emitted yet.
+     * This is meant to be used when the gesture ends.
+     */
+    void flush();
+    void reset();
+
+Q_SIGNALS:
+    void progress(qreal progress);
+
+private:
+    struct Sample {
+        qreal progress;
+        std::chrono::nanoseconds timestamp;
+    };
+    QVector<Sample> m_samples;
+    bool m_pendingUpdate = false;
+    bool m_predictionEnabled = true;
+};
+
 class KWIN_EXPORT GestureRecognizer : public QObject
 {
     Q_OBJECT
@@ -9,9 +9,13 @@
 // own
 #include "globalshortcuts.h"
 // kwin
+#include "abstract_output.h"
 #include "gestures.h"
 #include "kwinglobals.h"
 #include "main.h"
+#include "platform.h"
+#include "renderloop.h"
+#include "workspace.h"
 #include "utils/common.h"
 #include <config-kwin.h>
 // KDE
@@ -19,11 +23,21 @@
 #include <KGlobalAccel/private/kglobalacceld.h>
 // Qt
 #include <QAction>
+#include <QPointer>
 #include <variant>
 #include <signal.h>
 
 namespace KWin
 {
+
+static RenderLoop *gestureRenderLoop()
+{
+    if (AbstractOutput *output = workspace() ? workspace()->activeOutput() : nullptr) {
+        return output->renderLoop();
+    }
+    return kwinApp()->platform()->renderLoop();
+}
+
 GlobalShortcut::GlobalShortcut(Shortcut &&sc, QAction *action)
     : m_shortcut(sc)
     , m_action(action)
@@ -48,7 +62,43 @@ GlobalShortcut::GlobalShortcut(Shortcut &&sc, QAction *action)
         m_gesture->setMinimumFingerCount(4);
         QObject::connect(m_gesture.get(), &SwipeGesture::triggered, m_action, &QAction::trigger, Qt::QueuedConnection);
         QObject::connect(m_gesture.get(), &SwipeGesture::cancelled, m_action, &QAction::trigger, Qt::QueuedConnection);
-        QObject::connect(m_gesture.get(), &SwipeGesture::progress, [cb = rtSwipeGesture->progressCallback](qreal v) {
+
+        // deliver the progress at most once per frame of the output the gesture happens on,
+        // so that consumers don't re-layout for every single touchpad event
+        m_progressResampler.reset(new GestureProgressResampler);
+        GestureProgressResampler *resampler = m_progressResampler.get();
+        auto renderLoop = QSharedPointer<QPointer<RenderLoop>>::create();
+        QObject::connect(m_gesture.get(), &SwipeGesture::started, resampler, [resampler, renderLoop] {
+            resampler->reset();
+            if (*renderLoop) {
+                QObject::disconnect(*renderLoop, nullptr, resampler, nullptr);
+            }
+            *renderLoop = gestureRenderLoop();
+            if (*renderLoop) {
+                QObject::connect(*renderLoop, &RenderLoop::aboutToRequestFrame, resampler, [resampler](RenderLoop *loop) {
+                    resampler->frame(loop->nextPresentationTimestamp());
+                });
+            }
+        });
+        QObject::connect(m_gesture.get(), &SwipeGesture::progress, resampler, [resampler, renderLoop](qreal progress) {
+            resampler->addSample(progress, std::chrono::steady_clock::now().time_since_epoch());
+            if (*renderLoop) {
+                (*renderLoop)->scheduleRepaint();
+            } else {
+                resampler->flush();
+            }
+        });
+        // the final progress has to reach the consumer before the action is triggered
+        const auto finish = [resampler, renderLoop] {
+            resampler->flush();
+            if (*renderLoop) {
+                QObject::disconnect(*renderLoop, nullptr, resampler, nullptr);
+                *renderLoop = nullptr;
+            }
+        };
+        QObject::connect(m_gesture.get(), &SwipeGesture::triggered, resampler, finish);
+        QObject::connect(m_gesture.get(), &SwipeGesture::cancelled, resampler, finish);
+        QObject::connect(resampler, &GestureProgressResampler::progress, [cb = rtSwipeGesture->progressCallback](qreal v) {
             cb(v);
         });
     }
@@ -22,6 +22,7 @@ namespace KWin
 {
 class GlobalShortcut;
 class SwipeGesture;
+class GestureProgressResampler;
 class GestureRecognizer;
 
 /**
@@ -170,6 +171,7 @@ public:
 
 private:
     QSharedPointer<SwipeGesture> m_gesture;
+    QSharedPointer<GestureProgressResampler> m_progressResampler;
     Shortcut m_shortcut = {};
     QAction *m_action = nullptr;
 };
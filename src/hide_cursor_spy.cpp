@@ -15,6 +15,11 @@
 namespace KWin
 {
 
+InputEventTypes HideCursorSpy::eventTypes() const
+{
+    return PointerInputEvent | WheelInputEvent | TouchInputEvent | TabletToolInputEvent;
+}
+
 void HideCursorSpy::pointerEvent(MouseEvent *event)
 {
     Q_UNUSED(event)
@@ -15,6 +15,7 @@ namespace KWin
 class HideCursorSpy : public InputEventSpy
 {
 public:
+    InputEventTypes eventTypes() const override;
     void pointerEvent(KWin::MouseEvent *event) override;
     void wheelEvent(KWin::WheelEvent *event) override;
     void touchDown(qint32 id, const QPointF &pos, quint32 time) override;
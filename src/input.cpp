@@ -93,6 +93,11 @@ InputEventFilter::~InputEventFilter()
     }
 }
 
+InputEventTypes InputEventFilter::eventTypes() const
+{
+    return AllInputEvents;
+}
+
 bool InputEventFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(event)
@@ -295,6 +300,10 @@ bool InputEventFilter::passToInputMethod(QKeyEvent *event)
 
 class VirtualTerminalFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return KeyInputEvent;
+    }
+
     bool keyEvent(QKeyEvent *event) override {
         // really on press and not on release? X11 switches on press.
         if (event->type() == QEvent::KeyPress && !event->isAutoRepeat()) {
@@ -310,6 +319,10 @@ public:
 
 class TerminateServerFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return KeyInputEvent;
+    }
+
     bool keyEvent(QKeyEvent *event) override {
         if (event->type() == QEvent::KeyPress && !event->isAutoRepeat()) {
             if (event->nativeVirtualKey() == XKB_KEY_Terminate_Server) {
@@ -324,6 +337,11 @@ public:
 
 class LockScreenFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent
+            | PinchGestureInputEvent | SwipeGestureInputEvent | HoldGestureInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         if (!waylandServer()->isScreenLocked()) {
             return false;
@@ -521,6 +539,10 @@ private:
 
 class EffectsFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (!effects) {
@@ -565,6 +587,10 @@ public:
 
 class MoveResizeFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent | TabletToolInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         AbstractClient *c = workspace()->moveResizeClient();
@@ -673,6 +699,10 @@ private:
 
 class WindowSelectorFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (!m_active) {
@@ -843,6 +873,10 @@ public:
         delete m_powerDown;
     }
 
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | SwipeGestureInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton);
         if (event->type() == QEvent::MouseButtonPress) {
@@ -979,6 +1013,10 @@ std::pair<bool, bool> performClientWheelAction(QWheelEvent *event, AbstractClien
 }
 
 class InternalWindowEventFilter : public InputEventFilter {
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (!input()->pointer()->focus() || !input()->pointer()->focus()->isInternal()) {
@@ -1144,6 +1182,10 @@ private:
 
 class DecorationEventFilter : public InputEventFilter {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | TouchInputEvent | TabletToolInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         auto decoration = input()->pointer()->decoration();
@@ -1352,6 +1394,10 @@ private:
 class TabBoxInputFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 button) override {
         Q_UNUSED(button)
         if (!TabBox::TabBox::self() || !TabBox::TabBox::self()->isGrabbed()) {
@@ -1389,6 +1435,10 @@ public:
 class ScreenEdgeInputFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | TouchInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         ScreenEdges::self()->isEntered(event);
@@ -1444,6 +1494,10 @@ private:
 class WindowActionInputFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | TouchInputEvent | TabletToolInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         Q_UNUSED(nativeButton)
         if (event->type() != QEvent::MouseButtonPress) {
@@ -1512,6 +1566,11 @@ public:
 class InputKeyboardFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override
+    {
+        return KeyInputEvent;
+    }
+
     bool keyEvent(QKeyEvent *event) override
     {
         return passToInputMethod(event);
@@ -1524,6 +1583,11 @@ public:
 class ForwardInputFilter : public InputEventFilter
 {
 public:
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | WheelInputEvent | KeyInputEvent | TouchInputEvent
+            | PinchGestureInputEvent | SwipeGestureInputEvent | HoldGestureInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         auto seat = waylandServer()->seat();
         seat->setTimestamp(event->timestamp());
@@ -1865,6 +1929,11 @@ public:
         return tool;
     }
 
+    InputEventTypes eventTypes() const override
+    {
+        return TabletToolInputEvent | TabletPadInputEvent;
+    }
+
     bool tabletToolEvent(TabletEvent *event) override
     {
         if (!workspace()) {
@@ -2065,6 +2134,10 @@ public:
         connect(&m_raiseTimer, &QTimer::timeout, this, &DragAndDropInputFilter::raiseDragTarget);
     }
 
+    InputEventTypes eventTypes() const override {
+        return PointerInputEvent | TouchInputEvent;
+    }
+
     bool pointerEvent(QMouseEvent *event, quint32 nativeButton) override {
         auto seat = waylandServer()->seat();
         if (!seat->isDragPointer()) {
@@ -2253,27 +2326,62 @@ void InputRedirection::installInputEventFilter(InputEventFilter *filter)
 {
     Q_ASSERT(!m_filters.contains(filter));
     m_filters << filter;
+    updateFilterTables();
 }
 
 void InputRedirection::prependInputEventFilter(InputEventFilter *filter)
 {
     Q_ASSERT(!m_filters.contains(filter));
     m_filters.prepend(filter);
+    updateFilterTables();
 }
 
 void InputRedirection::uninstallInputEventFilter(InputEventFilter *filter)
 {
-    m_filters.removeOne(filter);
+    if (m_filters.removeOne(filter)) {
+        updateFilterTables();
+    }
+}
+
+void InputRedirection::updateFilterTables()
+{
+    for (int i = 0; i < s_eventTypeCount; ++i) {
+        const InputEventType type = InputEventType(1 << i);
+        QVector<InputEventFilter *> &filters = m_filtersByType[i];
+        filters.clear();
+        for (InputEventFilter *filter : qAsConst(m_filters)) {
+            if (filter->eventTypes().testFlag(type)) {
+                filters.append(filter);
+            }
+        }
+    }
 }
 
 void InputRedirection::installInputEventSpy(InputEventSpy *spy)
 {
     m_spies << spy;
+    updateSpyTables();
 }
 
 void InputRedirection::uninstallInputEventSpy(InputEventSpy *spy)
 {
-    m_spies.removeOne(spy);
+    if (m_spies.removeOne(spy)) {
+        updateSpyTables();
+    }
+}
+
+void InputRedirection::updateSpyTables()
+{
+    for (int i = 0; i < s_eventTypeCount; ++i) {
+        const InputEventType type = InputEventType(1 << i);
+        QVector<InputEventSpy *> &spies = m_spiesByType[i];
+        spies.clear();
+        for (InputEventSpy *spy : qAsConst(m_spies)) {
+            if (spy->eventTypes().testFlag(type)) {
+                spies.append(spy);
+            }
+        }
+    }
 }
 
 void InputRedirection::init()
@@ -2557,8 +2665,8 @@ void InputRedirection::handleInputDeviceAdded(InputDevice *device)
 
     auto handleSwitchEvent = [this] (SwitchEvent::State state, quint32 time, quint64 timeMicroseconds, InputDevice *device) {
         SwitchEvent event(state, time, timeMicroseconds, device);
-        processSpies(std::bind(&InputEventSpy::switchEvent, std::placeholders::_1, &event));
-        processFilters(std::bind(&InputEventFilter::switchEvent, std::placeholders::_1, &event));
+        processSpies(SwitchInputEvent, std::bind(&InputEventSpy::switchEvent, std::placeholders::_1, &event));
+        processFilters(SwitchInputEvent, std::bind(&InputEventFilter::switchEvent, std::placeholders::_1, &event));
     };
     connect(device, &InputDevice::switchToggledOn, this,
             std::bind(handleSwitchEvent, SwitchEvent::State::On, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -20,6 +20,7 @@
 #include <KConfigWatcher>
 #include <KSharedConfig>
 #include <QSet>
+#include <QtAlgorithms>
 
 #include <functional>
 
@@ -53,6 +54,24 @@ class DecoratedClientImpl;
 class InputBackend;
 class InputDevice;
 
+/**
+ * The kinds of input events that are dispatched to InputEventFilters and InputEventSpies.
+ */
+enum InputEventType : int {
+    PointerInputEvent = 1 << 0,
+    WheelInputEvent = 1 << 1,
+    KeyInputEvent = 1 << 2,
+    TouchInputEvent = 1 << 3,
+    PinchGestureInputEvent = 1 << 4,
+    SwipeGestureInputEvent = 1 << 5,
+    HoldGestureInputEvent = 1 << 6,
+    SwitchInputEvent = 1 << 7,
+    TabletToolInputEvent = 1 << 8,
+    TabletPadInputEvent = 1 << 9,
+    AllInputEvents = (1 << 10) - 1,
+};
+Q_DECLARE_FLAGS(InputEventTypes, InputEventType)
+
 /**
  * @brief This class is responsible for redirecting incoming input to the surface which currently
  * has input or send enter/leave events.
@@ -168,7 +187,7 @@ public:
     }
 
     /**
-     * Sends an event through all InputFilters.
+     * Sends an event of the given @p type through all InputFilters which handle it.
      * The method @p function is invoked on each input filter. Processing is stopped if
      * a filter returns @c true for @p function.
      *
@@ -182,12 +201,14 @@ public:
      * bind.
      */
     template <class UnaryPredicate>
-    void processFilters(UnaryPredicate function) {
-        std::any_of(m_filters.constBegin(), m_filters.constEnd(), function);
+    void processFilters(InputEventType type, UnaryPredicate function) {
+        // A shallow copy, filters can be installed or uninstalled during processing.
+        const QVector<InputEventFilter *> filters = m_filtersByType[eventTypeIndex(type)];
+        std::any_of(filters.constBegin(), filters.constEnd(), function);
     }
 
     /**
-     * Sends an event through all input event spies.
+     * Sends an event of the given @p type through all input event spies which handle it.
      * The @p function is invoked on each InputEventSpy.
      *
      * The UnaryFunction is defined like the UnaryFunction of std::for_each.
@@ -200,8 +221,9 @@ public:
      * bind.
      */
     template <class UnaryFunction>
-    void processSpies(UnaryFunction function) {
-        std::for_each(m_spies.constBegin(), m_spies.constEnd(), function);
+    void processSpies(InputEventType type, UnaryFunction function) {
+        const QVector<InputEventSpy *> spies = m_spiesByType[eventTypeIndex(type)];
+        std::for_each(spies.constBegin(), spies.constEnd(), function);
     }
 
     KeyboardInputRedirection *keyboard() const {
@@ -296,6 +318,11 @@ private:
     void setupWorkspace();
     void setupInputFilters();
     void installInputEventFilter(InputEventFilter *filter);
+    void updateFilterTables();
+    void updateSpyTables();
+    static int eventTypeIndex(InputEventType type) {
+        return qCountTrailingZeroBits(uint(type));
+    }
     void updateLeds(LEDs leds);
     void updateAvailableInputDevices();
     void addInputBackend(InputBackend *inputBackend);
@@ -314,6 +341,10 @@ private:
 
     QVector<InputEventFilter*> m_filters;
     QVector<InputEventSpy*> m_spies;
+    // m_filters and m_spies split by the event types they handle, in processing order
+    static const int s_eventTypeCount = 10;
+    QVector<InputEventFilter *> m_filtersByType[s_eventTypeCount];
+    QVector<InputEventSpy *> m_spiesByType[s_eventTypeCount];
     KConfigWatcher::Ptr m_inputConfigWatcher;
 
     LEDs m_leds;
@@ -356,6 +387,15 @@ public:
     InputEventFilter();
     virtual ~InputEventFilter();
 
+    /**
+     * Returns the types of events this filter handles. Events of other types are not
+     * passed to the filter at all. The returned value must not change after the filter
+     * has been installed.
+     *
+     * The default implementation returns AllInputEvents.
+     */
+    virtual InputEventTypes eventTypes() const;
+
     /**
      * Event filter for pointer events which can be described by a QMouseEvent.
      *
@@ -519,6 +559,7 @@ void InputRedirection::registerShortcut(const QKeySequence &shortcut, QAction *a
 } // namespace KWin
 
 Q_DECLARE_METATYPE(KWin::InputRedirection::KeyboardKeyState)
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWin::InputEventTypes)
 Q_DECLARE_METATYPE(KWin::InputRedirection::PointerButtonState)
 Q_DECLARE_METATYPE(KWin::InputRedirection::PointerAxis)
 Q_DECLARE_METATYPE(KWin::InputRedirection::PointerAxisSource)
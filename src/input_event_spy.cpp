@@ -24,6 +24,11 @@ InputEventSpy::~InputEventSpy()
     }
 }
 
+InputEventTypes InputEventSpy::eventTypes() const
+{
+    return AllInputEvents;
+}
+
 void InputEventSpy::pointerEvent(MouseEvent *event)
 {
     Q_UNUSED(event)
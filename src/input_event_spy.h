@@ -10,7 +10,7 @@
 #define KWIN_INPUT_EVENT_SPY_H
 #include <kwin_export.h>
 
-#include <QtGlobal>
+#include <QFlags>
 
 class QPointF;
 class QSizeF;
@@ -26,6 +26,9 @@ class TabletEvent;
 class TabletToolId;
 class TabletPadId;
 
+enum InputEventType : int;
+typedef QFlags<InputEventType> InputEventTypes;
+
 /**
  * Base class for spying on input events inside InputRedirection.
  *
@@ -42,6 +45,15 @@ public:
     InputEventSpy();
     virtual ~InputEventSpy();
 
+    /**
+     * Returns the types of events this spy wants to see. Events of other types are not
+     * passed to the spy at all. The returned value must not change after the spy has
+     * been installed.
+     *
+     * The default implementation returns AllInputEvents.
+     */
+    virtual InputEventTypes eventTypes() const;
+
     /**
      * Event spy for pointer events which can be described by a MouseEvent.
      *
@@ -21,14 +21,28 @@ Item::Item(Item *parent)
 {
     setParentItem(parent);
     connect(kwinApp()->platform(), &Platform::outputDisabled, this, &Item::removeRepaints);
+
+    // Schedule a full repaint of new items on every output. Each output clears only its own
+    // share when it takes the repaints of the item.
+    const QRect fullRect(QPoint(0, 0), screens()->size());
+    if (kwinApp()->platform()->isPerScreenRenderingEnabled()) {
+        const QVector<AbstractOutput *> outputs = kwinApp()->platform()->enabledOutputs();
+        for (AbstractOutput *output : outputs) {
+            addRepaints(output, fullRect);
+        }
+    } else {
+        addRepaints(nullptr, fullRect);
+    }
 }
 
 Item::~Item()
 {
     setParentItem(nullptr);
-    for (const auto &dirty : qAsConst(m_repaints)) {
-        if (!dirty.isEmpty()) {
-            Compositor::self()->scene()->addRepaint(dirty);
+    Scene *scene = Compositor::self()->scene();
+    for (const OutputRepaints &repaints : qAsConst(m_repaints)) {
+        scene->removeDirtyItem(this, repaints.output);
+        if (!repaints.region.isEmpty()) {
+            scene->addRepaint(repaints.region.toRegion());
         }
     }
 }
@@ -45,7 +59,8 @@ void Item::setZ(int z)
     }
     m_z = z;
     if (m_parentItem) {
-        m_parentItem->markSortedChildItemsDirty();
+        m_parentItem->removeSortedChildItem(this);
+        m_parentItem->insertSortedChildItem(this);
     }
     scheduleRepaint(boundingRect());
 }
@@ -75,7 +90,7 @@ void Item::addChild(Item *item)
     Q_ASSERT(!m_childItems.contains(item));
 
     m_childItems.append(item);
-    markSortedChildItemsDirty();
+    insertSortedChildItem(item);
 
     updateBoundingRect();
     scheduleRepaint(item->boundingRect().translated(item->position()));
@@ -87,7 +102,7 @@ void Item::removeChild(Item *item)
     scheduleRepaint(item->boundingRect().translated(item->position()));
 
     m_childItems.removeOne(item);
-    markSortedChildItemsDirty();
+    removeSortedChildItem(item);
 
     updateBoundingRect();
 }
@@ -255,22 +270,40 @@ void Item::scheduleRepaint(const QRegion &region)
 
 void Item::scheduleRepaintInternal(const QRegion &region)
 {
-    const QRegion globalRegion = mapToGlobal(region);
+    const DamageRegion globalRegion(mapToGlobal(region));
     if (kwinApp()->platform()->isPerScreenRenderingEnabled()) {
         const QVector<AbstractOutput *> outputs = kwinApp()->platform()->enabledOutputs();
         for (const auto &output : outputs) {
-            const QRegion dirtyRegion = globalRegion & output->geometry();
+            const DamageRegion dirtyRegion = globalRegion.intersected(output->geometry());
             if (!dirtyRegion.isEmpty()) {
-                m_repaints[output] += dirtyRegion;
+                addRepaints(output, dirtyRegion);
                 output->renderLoop()->scheduleRepaint(this);
             }
         }
     } else {
-        m_repaints[nullptr] += globalRegion;
+        addRepaints(nullptr, globalRegion);
         kwinApp()->platform()->renderLoop()->scheduleRepaint(this);
     }
 }
 
+void Item::addRepaints(AbstractOutput *output, const DamageRegion &region)
+{
+    if (region.isEmpty()) {
+        return;
+    }
+    for (OutputRepaints &repaints : m_repaints) {
+        if (repaints.output == output) {
+            if (repaints.region.isEmpty()) {
+                Compositor::self()->scene()->addDirtyItem(this, output);
+            }
+            repaints.region += region;
+            return;
+        }
+    }
+    m_repaints.append(OutputRepaints{output, region});
+    Compositor::self()->scene()->addDirtyItem(this, output);
+}
+
 void Item::scheduleFrame()
 {
     if (!isVisible()) {
@@ -311,19 +344,34 @@ WindowQuadList Item::quads() const
     return m_quads.value();
 }
 
-QRegion Item::repaints(AbstractOutput *output) const
+DamageRegion Item::repaints(AbstractOutput *output) const
 {
-    return m_repaints.value(output, QRect(QPoint(0, 0), screens()->size()));
+    for (const OutputRepaints &repaints : m_repaints) {
+        if (repaints.output == output) {
+            return repaints.region;
+        }
+    }
+    return DamageRegion();
 }
 
 void Item::resetRepaints(AbstractOutput *output)
 {
-    m_repaints.insert(output, QRegion());
+    for (OutputRepaints &repaints : m_repaints) {
+        if (repaints.output == output) {
+            repaints.region.clear();
+            return;
+        }
+    }
 }
 
 void Item::removeRepaints(AbstractOutput *output)
 {
-    m_repaints.remove(output);
+    for (int i = 0; i < m_repaints.count(); ++i) {
+        if (m_repaints[i].output == output) {
+            m_repaints.remove(i);
+            return;
+        }
+    }
 }
 
 bool Item::isVisible() const
@@ -379,4 +427,32 @@ void Item::markSortedChildItemsDirty()
     m_sortedChildItems.reset();
 }
 
+void Item::insertSortedChildItem(Item *item)
+{
+    if (!m_sortedChildItems.has_value()) {
+        return;
+    }
+
+    // Keep the order of sortedChildItems(): by z, and items with the same z in the order
+    // in which they are stacked in m_childItems.
+    QList<Item *> &items = m_sortedChildItems.value();
+    auto it = std::lower_bound(items.begin(), items.end(), item->z(), [](const Item *a, int z) {
+        return a->z() < z;
+    });
+    if (it != items.end() && (*it)->z() == item->z()) {
+        const int index = m_childItems.indexOf(item);
+        while (it != items.end() && (*it)->z() == item->z() && m_childItems.indexOf(*it) < index) {
+            ++it;
+        }
+    }
+    items.insert(it, item);
+}
+
+void Item::removeSortedChildItem(Item *item)
+{
+    if (m_sortedChildItems.has_value()) {
+        m_sortedChildItems->removeOne(item);
+    }
+}
+
 } // namespace KWin
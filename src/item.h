@@ -8,9 +8,11 @@
 
 #include "kwinglobals.h"
 #include "kwineffects.h"
+#include "utils/damageregion.h"
 
 #include <QMatrix4x4>
 #include <QObject>
+#include <QVarLengthArray>
 
 #include <optional>
 
@@ -87,7 +89,7 @@ public:
 
     void scheduleRepaint(const QRegion &region);
     void scheduleFrame();
-    QRegion repaints(AbstractOutput *output) const;
+    DamageRegion repaints(AbstractOutput *output) const;
     void resetRepaints(AbstractOutput *output);
 
     WindowQuadList quads() const;
@@ -119,10 +121,23 @@ private:
     void updateBoundingRect();
     void scheduleRepaintInternal(const QRegion &region);
     void markSortedChildItemsDirty();
+    void insertSortedChildItem(Item *item);
+    void removeSortedChildItem(Item *item);
 
     bool computeEffectiveVisibility() const;
     void updateEffectiveVisibility();
     void removeRepaints(AbstractOutput *output);
+    void addRepaints(AbstractOutput *output, const DamageRegion &region);
+
+    /**
+     * The repaints for one output. The item is in the scene's list of dirty items for
+     * the output as long as the region is not empty.
+     */
+    struct OutputRepaints
+    {
+        AbstractOutput *output;
+        DamageRegion region;
+    };
 
     QPointer<Item> m_parentItem;
     QList<Item *> m_childItems;
@@ -133,7 +148,7 @@ private:
     int m_z = 0;
     bool m_visible = true;
     bool m_effectiveVisible = true;
-    QMap<AbstractOutput *, QRegion> m_repaints;
+    QVarLengthArray<OutputRepaints, 2> m_repaints;
     mutable std::optional<WindowQuadList> m_quads;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
 };
@@ -56,6 +56,11 @@ public:
     {
     }
 
+    InputEventTypes eventTypes() const override
+    {
+        return KeyInputEvent;
+    }
+
     void keyEvent(KeyEvent *event) override
     {
         if (event->isAutoRepeat()) {
@@ -77,6 +82,11 @@ public:
     {
     }
 
+    InputEventTypes eventTypes() const override
+    {
+        return KeyInputEvent;
+    }
+
     void keyEvent(KeyEvent *event) override
     {
         if (event->isAutoRepeat()) {
@@ -240,12 +250,12 @@ void KeyboardInputRedirection::processKey(uint32_t key, InputRedirection::Keyboa
                    device);
     event.setModifiersRelevantForGlobalShortcuts(globalShortcutsModifiers);
 
-    m_input->processSpies(std::bind(&InputEventSpy::keyEvent, std::placeholders::_1, &event));
+    m_input->processSpies(KeyInputEvent, std::bind(&InputEventSpy::keyEvent, std::placeholders::_1, &event));
     if (!m_inited) {
         return;
     }
     input()->setLastInputHandler(this);
-    m_input->processFilters(std::bind(&InputEventFilter::keyEvent, std::placeholders::_1, &event));
+    m_input->processFilters(KeyInputEvent, std::bind(&InputEventFilter::keyEvent, std::placeholders::_1, &event));
 
     m_xkb->forwardModifiers();
     if (auto *inputmethod = InputMethod::self()) {
@@ -9,34 +9,159 @@
 #include "keyboard_repeat.h"
 #include "keyboard_input.h"
 #include "input_event.h"
+#include "utils/common.h"
 #include "wayland_server.h"
 
 #include <KWaylandServer/keyboard_interface.h>
 #include <KWaylandServer/seat_interface.h>
 
+#include <QSocketNotifier>
 #include <QTimer>
 
+#include <config-kwin.h>
+
+#if HAVE_SYS_TIMERFD_H
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+#include <cerrno>
+#include <ctime>
+
 namespace KWin
 {
 
+// repeats which are due for longer than this many intervals are dropped instead of being
+// delivered in a burst after the compositor was stalled
+static const int s_maxPendingRepeats = 3;
+
+static std::chrono::nanoseconds monotonicTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
 KeyboardRepeat::KeyboardRepeat(Xkb *xkb)
     : QObject()
-    , m_timer(new QTimer(this))
     , m_xkb(xkb)
 {
-    connect(m_timer, &QTimer::timeout, this, &KeyboardRepeat::handleKeyRepeat);
+#if HAVE_SYS_TIMERFD_H
+    m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (m_timerFd != -1) {
+        m_notifier = new QSocketNotifier(m_timerFd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &KeyboardRepeat::handleKeyRepeat);
+    } else {
+        qCWarning(KWIN_CORE) << "Failed to create key repeat timer:" << strerror(errno);
+    }
+#endif
+    if (m_timerFd == -1) {
+        m_timer = new QTimer(this);
+        m_timer->setSingleShot(true);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        connect(m_timer, &QTimer::timeout, this, &KeyboardRepeat::handleKeyRepeat);
+    }
 }
 
-KeyboardRepeat::~KeyboardRepeat() = default;
+KeyboardRepeat::~KeyboardRepeat()
+{
+#if HAVE_SYS_TIMERFD_H
+    if (m_timerFd != -1) {
+        delete m_notifier;
+        close(m_timerFd);
+    }
+#endif
+}
 
-void KeyboardRepeat::handleKeyRepeat()
+std::chrono::nanoseconds KeyboardRepeat::repeatInterval() const
 {
     // TODO: don't depend on WaylandServer
-    if (waylandServer()->seat()->keyboard()->keyRepeatRate() != 0) {
-        m_timer->setInterval(1000 / waylandServer()->seat()->keyboard()->keyRepeatRate());
+    const qint32 rate = waylandServer()->seat()->keyboard()->keyRepeatRate();
+    if (rate <= 0) {
+        return std::chrono::seconds(1);
+    }
+    return std::chrono::nanoseconds(std::chrono::seconds(1)) / rate;
+}
+
+void KeyboardRepeat::scheduleRepeat(std::chrono::nanoseconds deadline)
+{
+#if HAVE_SYS_TIMERFD_H
+    if (m_timerFd != -1) {
+        itimerspec spec = {};
+        if (deadline != std::chrono::nanoseconds::zero()) {
+            const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(deadline);
+            spec.it_value.tv_sec = seconds.count();
+            spec.it_value.tv_nsec = (deadline - seconds).count();
+        }
+        if (timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr) == -1) {
+            qCWarning(KWIN_CORE) << "Failed to arm key repeat timer:" << strerror(errno);
+        }
+        return;
     }
-    // TODO: better time
-    Q_EMIT keyRepeat(m_key, m_time);
+#endif
+    if (deadline == std::chrono::nanoseconds::zero()) {
+        m_timer->stop();
+        return;
+    }
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - monotonicTime());
+    m_timer->start(std::max<qint64>(0, remaining.count()));
+}
+
+void KeyboardRepeat::startRepeat(quint32 key, quint32 timestamp)
+{
+    const std::chrono::nanoseconds now = monotonicTime();
+    // libinput timestamps are CLOCK_MONOTONIC in milliseconds truncated to 32 bit, use them to
+    // anchor the schedule at the actual key press. Fall back to now for other clocks
+    const quint32 age = quint32(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()) - timestamp;
+    m_pressTime = age < 1000 ? now - std::chrono::milliseconds(age) : now;
+    m_pressTimestamp = timestamp;
+    m_key = key;
+    m_repeating = true;
+    // TODO: don't get these values from WaylandServer
+    m_nextRepeat = m_pressTime + std::chrono::milliseconds(waylandServer()->seat()->keyboard()->keyRepeatDelay());
+    scheduleRepeat(m_nextRepeat);
+}
+
+void KeyboardRepeat::stopRepeat()
+{
+    m_repeating = false;
+    scheduleRepeat(std::chrono::nanoseconds::zero());
+}
+
+void KeyboardRepeat::handleKeyRepeat()
+{
+#if HAVE_SYS_TIMERFD_H
+    if (m_timerFd != -1) {
+        uint64_t expirationCount;
+        if (read(m_timerFd, &expirationCount, sizeof(expirationCount)) != sizeof(expirationCount)) {
+            // EAGAIN if the timer has been re-armed since the notifier fired
+            if (errno != EAGAIN) {
+                qCWarning(KWIN_CORE) << "Failed to read key repeat timer:" << strerror(errno);
+            }
+            return;
+        }
+    }
+#endif
+    const std::chrono::nanoseconds now = monotonicTime();
+    const std::chrono::nanoseconds interval = repeatInterval();
+    if (now - m_nextRepeat > s_maxPendingRepeats * interval) {
+        m_nextRepeat += ((now - m_nextRepeat) / interval - s_maxPendingRepeats + 1) * interval;
+    }
+    // deliver every repeat that is due with the time it was due at, so that a late wake up
+    // neither shifts the following repeats nor loses any of them
+    const quint32 key = m_key;
+    while (m_repeating && m_key == key && m_nextRepeat <= now) {
+        const auto sincePress = std::chrono::duration_cast<std::chrono::milliseconds>(m_nextRepeat - m_pressTime);
+        m_nextRepeat += interval;
+        Q_EMIT keyRepeat(key, m_pressTimestamp + quint32(sincePress.count()));
+    }
+    if (m_repeating && m_key == key) {
+        scheduleRepeat(m_nextRepeat);
+    }
+}
+
+InputEventTypes KeyboardRepeat::eventTypes() const
+{
+    return KeyInputEvent;
 }
 
 void KeyboardRepeat::keyEvent(KeyEvent *event)
@@ -48,14 +173,11 @@ void KeyboardRepeat::keyEvent(KeyEvent *event)
     if (event->type() == QEvent::KeyPress) {
         // TODO: don't get these values from WaylandServer
         if (m_xkb->shouldKeyRepeat(key) && waylandServer()->seat()->keyboard()->keyRepeatDelay() != 0) {
-            m_timer->setInterval(waylandServer()->seat()->keyboard()->keyRepeatDelay());
-            m_key = key;
-            m_time = event->timestamp();
-            m_timer->start();
+            startRepeat(key, event->timestamp());
         }
     } else if (event->type() == QEvent::KeyRelease) {
         if (key == m_key) {
-            m_timer->stop();
+            stopRepeat();
         }
     }
 }
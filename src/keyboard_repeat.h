@@ -13,6 +13,9 @@
 
 #include <QObject>
 
+#include <chrono>
+
+class QSocketNotifier;
 class QTimer;
 
 namespace KWin
@@ -26,17 +29,34 @@ public:
     explicit KeyboardRepeat(Xkb *xkb);
     ~KeyboardRepeat() override;
 
+    InputEventTypes eventTypes() const override;
     void keyEvent(KeyEvent *event) override;
 
 Q_SIGNALS:
+    /**
+     * Emitted for every repeat of @p key. @p time is the point in time at which the repeat
+     * was due, in the same clock as the timestamp of the key press
+     */
     void keyRepeat(quint32 key, quint32 time);
 
 private:
     void handleKeyRepeat();
-    QTimer *m_timer;
+    void startRepeat(quint32 key, quint32 timestamp);
+    void stopRepeat();
+    void scheduleRepeat(std::chrono::nanoseconds deadline);
+    std::chrono::nanoseconds repeatInterval() const;
+
+    int m_timerFd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QTimer *m_timer = nullptr;
     Xkb *m_xkb;
-    quint32 m_time;
     quint32 m_key = 0;
+    bool m_repeating = false;
+    // the key press timestamp as reported by the input device
+    quint32 m_pressTimestamp = 0;
+    // the key press and the next repeat in CLOCK_MONOTONIC
+    std::chrono::nanoseconds m_pressTime = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds m_nextRepeat = std::chrono::nanoseconds::zero();
 };
 
 
@@ -8,15 +8,21 @@
 */
 #include "main_wayland.h"
 #include "composite.h"
+#include "effectloader.h"
 #include "inputmethod.h"
+#include "options.h"
 #include "workspace.h"
 #include <config-kwin.h>
 // kwin
 #include "platform.h"
+#include "scripting/scripting.h"
 #include "effects.h"
 #include "tabletmodemanager.h"
+#include "utils/common.h"
+#include "utils/startupphase.h"
 
 #include "wayland_server.h"
+#include "xkb.h"
 #include "xwl/xwayland.h"
 
 // KWayland
@@ -140,30 +146,62 @@ ApplicationWayland::~ApplicationWayland()
 
 void ApplicationWayland::performStartup()
 {
+    m_startupTimer.start();
     if (m_startXWayland) {
         setOperationMode(OperationModeXwayland);
     }
+
+    // The following work doesn't depend on the platform, so do it in worker threads while
+    // the main thread is busy with bringing up outputs and input devices.
+    Xkb::prefetchKeymap(kxkbConfig());
+    PluginEffectLoader::prefetchEffects();
+    Scripting::prefetchScripts();
+
     // first load options - done internally by a different thread
-    createOptions();
+    {
+        StartupPhase phase(QStringLiteral("options"));
+        createOptions();
+    }
 
-    if (!platform()->initialize()) {
-        std::exit(1);
+    {
+        StartupPhase phase(QStringLiteral("platform"));
+        if (!platform()->initialize()) {
+            std::exit(1);
+        }
     }
 
-    waylandServer()->initPlatform();
-    createColorManager();
+    {
+        StartupPhase phase(QStringLiteral("wayland globals"));
+        waylandServer()->initPlatform();
+        createColorManager();
+    }
 
     // try creating the Wayland Backend
-    createInput();
+    {
+        StartupPhase phase(QStringLiteral("input"));
+        createInput();
+    }
     // now libinput thread has been created, adjust scheduler to not leak into other processes
     gainRealTime(RealTimeFlags::ResetOnFork);
 
-    createInputMethod();
-    TabletModeManager::create(this);
-    createPlugins();
+    {
+        StartupPhase phase(QStringLiteral("input method"));
+        createInputMethod();
+        TabletModeManager::create(this);
+    }
+    {
+        StartupPhase phase(QStringLiteral("plugins"));
+        createPlugins();
+    }
 
-    createScreens();
-    WaylandCompositor::create();
+    {
+        StartupPhase phase(QStringLiteral("screens"));
+        createScreens();
+    }
+    {
+        StartupPhase phase(QStringLiteral("compositor"));
+        WaylandCompositor::create();
+    }
 
     connect(Compositor::self(), &Compositor::sceneCreated, platform(), &Platform::sceneInitialized);
     connect(Compositor::self(), &Compositor::sceneCreated, this, &ApplicationWayland::continueStartupWithScene);
@@ -174,10 +212,16 @@ void ApplicationWayland::continueStartupWithScene()
     disconnect(Compositor::self(), &Compositor::sceneCreated, this, &ApplicationWayland::continueStartupWithScene);
 
     // Note that we start accepting client connections after creating the Workspace.
-    createWorkspace();
+    {
+        StartupPhase phase(QStringLiteral("workspace"));
+        createWorkspace();
+    }
 
-    if (!waylandServer()->start()) {
-        qFatal("Failed to initialze the Wayland server, exiting now");
+    {
+        StartupPhase phase(QStringLiteral("wayland server"));
+        if (!waylandServer()->start()) {
+            qFatal("Failed to initialze the Wayland server, exiting now");
+        }
     }
 
     if (operationMode() == OperationModeWaylandOnly) {
@@ -189,8 +233,15 @@ void ApplicationWayland::continueStartupWithScene()
     m_xwayland->setListenFDs(m_xwaylandListenFds);
     m_xwayland->setDisplayName(m_xwaylandDisplay);
     m_xwayland->setXauthority(m_xwaylandXauthority);
+    if (options->xwaylandStartOnDemand()) {
+        // Nobody has to wait for Xwayland, it will be spawned by the first X11 client.
+        m_xwayland->start(Xwl::Xwayland::StartMode::OnDemand);
+        finalizeStartup();
+        return;
+    }
     connect(m_xwayland, &Xwl::Xwayland::errorOccurred, this, &ApplicationWayland::finalizeStartup);
     connect(m_xwayland, &Xwl::Xwayland::started, this, &ApplicationWayland::finalizeStartup);
+    m_xwaylandPhase.reset(new StartupPhase(QStringLiteral("xwayland")));
     m_xwayland->start();
 }
 
@@ -200,6 +251,9 @@ void ApplicationWayland::finalizeStartup()
         disconnect(m_xwayland, &Xwl::Xwayland::errorOccurred, this, &ApplicationWayland::finalizeStartup);
         disconnect(m_xwayland, &Xwl::Xwayland::started, this, &ApplicationWayland::finalizeStartup);
     }
+    m_xwaylandPhase.reset();
+    StartupPhase::report();
+    qCInfo(KWIN_CORE) << "Startup finished in" << m_startupTimer.elapsed() << "ms";
     startSession();
     notifyStarted();
 }
@@ -9,7 +9,9 @@
 #ifndef KWIN_MAIN_WAYLAND_H
 #define KWIN_MAIN_WAYLAND_H
 #include "main.h"
+#include "utils/startupphase.h"
 #include <KConfigWatcher>
+#include <QElapsedTimer>
 #include <QProcessEnvironment>
 #include <QTimer>
 
@@ -70,6 +72,8 @@ private:
     QString m_inputMethodServerToStart;
     QProcessEnvironment m_environment;
     QString m_sessionArgument;
+    QElapsedTimer m_startupTimer;
+    QScopedPointer<StartupPhase> m_xwaylandPhase;
 
     Xwl::Xwayland *m_xwayland = nullptr;
     QVector<int> m_xwaylandListenFds;
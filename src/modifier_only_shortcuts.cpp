@@ -29,6 +29,11 @@ ModifierOnlyShortcuts::ModifierOnlyShortcuts()
 
 ModifierOnlyShortcuts::~ModifierOnlyShortcuts() = default;
 
+InputEventTypes ModifierOnlyShortcuts::eventTypes() const
+{
+    return KeyInputEvent | PointerInputEvent | WheelInputEvent;
+}
+
 void ModifierOnlyShortcuts::keyEvent(KeyEvent *event)
 {
     if (event->isAutoRepeat()) {
@@ -25,6 +25,7 @@ public:
     explicit ModifierOnlyShortcuts();
     ~ModifierOnlyShortcuts() override;
 
+    InputEventTypes eventTypes() const override;
     void keyEvent(KeyEvent *event) override;
     void pointerEvent(MouseEvent *event) override;
     void wheelEvent(WheelEvent *event) override;
@@ -31,6 +31,7 @@ class OnScreenNotificationInputEventSpy : public InputEventSpy
 public:
     explicit OnScreenNotificationInputEventSpy(OnScreenNotification *parent);
 
+    InputEventTypes eventTypes() const override;
     void pointerEvent(MouseEvent *event) override;
 private:
     OnScreenNotification *m_parent;
@@ -41,6 +42,11 @@ OnScreenNotificationInputEventSpy::OnScreenNotificationInputEventSpy(OnScreenNot
 {
 }
 
+InputEventTypes OnScreenNotificationInputEventSpy::eventTypes() const
+{
+    return PointerInputEvent;
+}
+
 void OnScreenNotificationInputEventSpy::pointerEvent(MouseEvent *event)
 {
     if (event->type() != QEvent::MouseMove) {
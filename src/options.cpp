@@ -54,6 +54,8 @@ Options::Options(QObject *parent)
     , m_hideUtilityWindowsForInactive(false)
     , m_xwaylandCrashPolicy(Options::defaultXwaylandCrashPolicy())
     , m_xwaylandMaxCrashCount(Options::defaultXwaylandMaxCrashCount())
+    , m_xwaylandStartOnDemand(Options::defaultXwaylandStartOnDemand())
+    , m_xwaylandIdleTimeout(Options::defaultXwaylandIdleTimeout())
     , m_latencyPolicy(Options::defaultLatencyPolicy())
     , m_renderTimeEstimator(Options::defaultRenderTimeEstimator())
     , m_compositingMode(Options::defaultCompositingMode())
@@ -145,6 +147,24 @@ void Options::setXwaylandMaxCrashCount(int maxCrashCount)
     Q_EMIT xwaylandMaxCrashCountChanged();
 }
 
+void Options::setXwaylandStartOnDemand(bool startOnDemand)
+{
+    if (m_xwaylandStartOnDemand == startOnDemand) {
+        return;
+    }
+    m_xwaylandStartOnDemand = startOnDemand;
+    Q_EMIT xwaylandStartOnDemandChanged();
+}
+
+void Options::setXwaylandIdleTimeout(int idleTimeout)
+{
+    if (m_xwaylandIdleTimeout == idleTimeout) {
+        return;
+    }
+    m_xwaylandIdleTimeout = idleTimeout;
+    Q_EMIT xwaylandIdleTimeoutChanged();
+}
+
 void Options::setClickRaise(bool clickRaise)
 {
     if (m_autoRaise) {
@@ -765,6 +785,8 @@ void Options::syncFromKcfgc()
     setFocusStealingPreventionLevel(m_settings->focusStealingPreventionLevel());
     setXwaylandCrashPolicy(m_settings->xwaylandCrashPolicy());
     setXwaylandMaxCrashCount(m_settings->xwaylandMaxCrashCount());
+    setXwaylandStartOnDemand(m_settings->xwaylandStartOnDemand());
+    setXwaylandIdleTimeout(m_settings->xwaylandIdleTimeout());
 
 #ifdef KWIN_BUILD_DECORATIONS
     setPlacement(m_settings->placement());
@@ -73,6 +73,8 @@ class KWIN_EXPORT Options : public QObject
     Q_PROPERTY(FocusPolicy focusPolicy READ focusPolicy WRITE setFocusPolicy NOTIFY focusPolicyChanged)
     Q_PROPERTY(XwaylandCrashPolicy xwaylandCrashPolicy READ xwaylandCrashPolicy WRITE setXwaylandCrashPolicy NOTIFY xwaylandCrashPolicyChanged)
     Q_PROPERTY(int xwaylandMaxCrashCount READ xwaylandMaxCrashCount WRITE setXwaylandMaxCrashCount NOTIFY xwaylandMaxCrashCountChanged)
+    Q_PROPERTY(bool xwaylandStartOnDemand READ xwaylandStartOnDemand WRITE setXwaylandStartOnDemand NOTIFY xwaylandStartOnDemandChanged)
+    Q_PROPERTY(int xwaylandIdleTimeout READ xwaylandIdleTimeout WRITE setXwaylandIdleTimeout NOTIFY xwaylandIdleTimeoutChanged)
     Q_PROPERTY(bool nextFocusPrefersMouse READ isNextFocusPrefersMouse WRITE setNextFocusPrefersMouse NOTIFY nextFocusPrefersMouseChanged)
     /**
      * Whether clicking on a window raises it in FocusFollowsMouse
@@ -251,6 +253,19 @@ public:
     int xwaylandMaxCrashCount() const {
         return m_xwaylandMaxCrashCount;
     }
+    /**
+     * Whether the Xwayland server is only started when the first X11 client connects.
+     */
+    bool xwaylandStartOnDemand() const {
+        return m_xwaylandStartOnDemand;
+    }
+    /**
+     * The number of seconds after which an on-demand Xwayland server without any X11 clients
+     * is shut down, or @c 0 if it should keep running.
+     */
+    int xwaylandIdleTimeout() const {
+        return m_xwaylandIdleTimeout;
+    }
 
     /**
      * Whether clicking on a window raises it in FocusFollowsMouse
@@ -605,6 +620,8 @@ public:
     void setFocusPolicy(FocusPolicy focusPolicy);
     void setXwaylandCrashPolicy(XwaylandCrashPolicy crashPolicy);
     void setXwaylandMaxCrashCount(int maxCrashCount);
+    void setXwaylandStartOnDemand(bool startOnDemand);
+    void setXwaylandIdleTimeout(int idleTimeout);
     void setNextFocusPrefersMouse(bool nextFocusPrefersMouse);
     void setClickRaise(bool clickRaise);
     void setAutoRaise(bool autoRaise);
@@ -750,6 +767,12 @@ public:
     static int defaultXwaylandMaxCrashCount() {
         return 3;
     }
+    static bool defaultXwaylandStartOnDemand() {
+        return false;
+    }
+    static int defaultXwaylandIdleTimeout() {
+        return 0;
+    }
     static LatencyPolicy defaultLatencyPolicy() {
         return LatencyMedium;
     }
@@ -773,6 +796,8 @@ Q_SIGNALS:
     void focusPolicyIsResonableChanged();
     void xwaylandCrashPolicyChanged();
     void xwaylandMaxCrashCountChanged();
+    void xwaylandStartOnDemandChanged();
+    void xwaylandIdleTimeoutChanged();
     void nextFocusPrefersMouseChanged();
     void clickRaiseChanged();
     void autoRaiseChanged();
@@ -855,6 +880,8 @@ private:
     bool m_hideUtilityWindowsForInactive;
     XwaylandCrashPolicy m_xwaylandCrashPolicy;
     int m_xwaylandMaxCrashCount;
+    bool m_xwaylandStartOnDemand;
+    int m_xwaylandIdleTimeout;
     LatencyPolicy m_latencyPolicy;
     RenderTimeEstimator m_renderTimeEstimator;
 
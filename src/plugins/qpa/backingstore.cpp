@@ -8,6 +8,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "backingstore.h"
+#include "imagepool.h"
 #include "window.h"
 
 #include "internal_client.h"
@@ -19,6 +20,9 @@ namespace KWin
 namespace QPA
 {
 
+// Usually one front buffer is shown by the compositor while the other one is painted.
+static const int s_maxFrontBuffers = 3;
+
 BackingStore::BackingStore(QWindow *window)
     : QPlatformBackingStore(window)
 {
@@ -35,18 +39,40 @@ void BackingStore::resize(const QSize &size, const QRegion &staticContents)
 {
     Q_UNUSED(staticContents)
 
-    if (m_backBuffer.size() == size) {
+    if (m_size == size) {
         return;
     }
 
     const QPlatformWindow *platformWindow = static_cast<QPlatformWindow *>(window()->handle());
     const qreal devicePixelRatio = platformWindow->devicePixelRatio();
 
-    m_backBuffer = QImage(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
-    m_backBuffer.setDevicePixelRatio(devicePixelRatio);
+    m_size = size;
+    m_backBuffer = ImagePool::self()->allocate(size * devicePixelRatio, devicePixelRatio);
+
+    // Front buffers that are still referenced by the compositor return to the pool once
+    // it is done with them.
+    m_frontBuffers.clear();
+}
+
+BackingStore::FrontBuffer *BackingStore::acquireFrontBuffer()
+{
+    // A front buffer can be painted again only after the compositor has dropped its last
+    // reference to it, otherwise QPainter would make a copy of it.
+    for (FrontBuffer &buffer : m_frontBuffers) {
+        if (buffer.image.isDetached()) {
+            return &buffer;
+        }
+    }
+
+    if (m_frontBuffers.count() < s_maxFrontBuffers) {
+        FrontBuffer buffer;
+        buffer.image = ImagePool::self()->allocate(m_backBuffer.size(), m_backBuffer.devicePixelRatio());
+        buffer.damage = QRect(QPoint(0, 0), m_size);
+        m_frontBuffers.append(buffer);
+        return &m_frontBuffers.last();
+    }
 
-    m_frontBuffer = QImage(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
-    m_frontBuffer.setDevicePixelRatio(devicePixelRatio);
+    return &m_frontBuffers.first();
 }
 
 static QRect scaledRect(const QRect &rect, qreal devicePixelRatio)
@@ -72,9 +98,16 @@ void BackingStore::flush(QWindow *window, const QRegion &region, const QPoint &o
         return;
     }
 
-    blitImage(m_backBuffer, m_frontBuffer, region);
+    for (FrontBuffer &buffer : m_frontBuffers) {
+        buffer.damage += region;
+    }
+
+    // Only the parts that changed since the front buffer was presented last time are copied.
+    FrontBuffer *frontBuffer = acquireFrontBuffer();
+    blitImage(m_backBuffer, frontBuffer->image, frontBuffer->damage);
+    frontBuffer->damage = QRegion();
 
-    client->present(m_frontBuffer, region);
+    client->present(frontBuffer->image, region);
 }
 
 }
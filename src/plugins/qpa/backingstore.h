@@ -12,6 +12,8 @@
 
 #include <epoxy/egl.h>
 
+#include <QImage>
+#include <QVector>
 #include <qpa/qplatformbackingstore.h>
 
 namespace KWin
@@ -30,8 +32,17 @@ public:
     void resize(const QSize &size, const QRegion &staticContents) override;
 
 private:
+    struct FrontBuffer
+    {
+        QImage image;
+        QRegion damage;
+    };
+
+    FrontBuffer *acquireFrontBuffer();
+
     QImage m_backBuffer;
-    QImage m_frontBuffer;
+    QVector<FrontBuffer> m_frontBuffers;
+    QSize m_size;
 };
 
 }
@@ -0,0 +1,126 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "imagepool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace KWin
+{
+namespace QPA
+{
+
+// The amount of unused memory that the pool may hold on to.
+static const size_t s_maxFreeSize = 32 * 1024 * 1024;
+
+Q_GLOBAL_STATIC(ImagePool, s_pool)
+
+ImagePool::~ImagePool()
+{
+    for (Chunk *chunk : m_freeOrder) {
+        std::free(chunk->data);
+        delete chunk;
+    }
+}
+
+ImagePool *ImagePool::self()
+{
+    return s_pool;
+}
+
+size_t ImagePool::bucketSize(size_t size)
+{
+    // There are four buckets per power of two, so at most a quarter of a chunk is wasted.
+    static const size_t minimumSize = 4096;
+    if (size <= minimumSize) {
+        return minimumSize;
+    }
+    size_t powerOfTwo = minimumSize;
+    while (powerOfTwo * 2 < size) {
+        powerOfTwo *= 2;
+    }
+    const size_t step = powerOfTwo / 4;
+    return (size + step - 1) / step * step;
+}
+
+QImage ImagePool::allocate(const QSize &size, qreal devicePixelRatio)
+{
+    const qsizetype bytesPerLine = size.width() * 4;
+    const size_t bucket = bucketSize(std::max<size_t>(bytesPerLine * size.height(), 1));
+
+    Chunk *chunk = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        chunk = m_freeChunks.take(bucket);
+        if (chunk) {
+            m_freeOrder.erase(std::find(m_freeOrder.begin(), m_freeOrder.end(), chunk));
+            m_freeSize -= chunk->size;
+            m_reuseCount++;
+        } else {
+            m_allocationCount++;
+        }
+    }
+
+    if (!chunk) {
+        // QImage requires the scanlines to be 32 bit aligned, malloc gives us more than that.
+        uchar *data = static_cast<uchar *>(std::malloc(bucket));
+        if (!data) {
+            return QImage();
+        }
+        chunk = new Chunk{data, bucket};
+    }
+
+    QImage image(chunk->data, size.width(), size.height(), bytesPerLine,
+                 QImage::Format_ARGB32_Premultiplied, &ImagePool::recycleChunk, chunk);
+    image.setDevicePixelRatio(devicePixelRatio);
+    return image;
+}
+
+void ImagePool::recycleChunk(void *info)
+{
+    Chunk *chunk = static_cast<Chunk *>(info);
+    if (s_pool.isDestroyed()) {
+        std::free(chunk->data);
+        delete chunk;
+        return;
+    }
+    s_pool->recycle(chunk);
+}
+
+void ImagePool::recycle(Chunk *chunk)
+{
+    QMutexLocker locker(&m_mutex);
+    m_freeChunks.insert(chunk->size, chunk);
+    m_freeOrder.push_back(chunk);
+    m_freeSize += chunk->size;
+
+    while (m_freeSize > s_maxFreeSize) {
+        Chunk *oldest = m_freeOrder.front();
+        m_freeOrder.pop_front();
+        m_freeChunks.remove(oldest->size, oldest);
+        m_freeSize -= oldest->size;
+        std::free(oldest->data);
+        delete oldest;
+    }
+}
+
+quint64 ImagePool::allocationCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_allocationCount;
+}
+
+quint64 ImagePool::reuseCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_reuseCount;
+}
+
+}
+}
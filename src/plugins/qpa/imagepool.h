@@ -0,0 +1,77 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef KWIN_QPA_IMAGEPOOL_H
+#define KWIN_QPA_IMAGEPOOL_H
+
+#include <QImage>
+#include <QMultiHash>
+#include <QMutex>
+
+#include <deque>
+
+namespace KWin
+{
+namespace QPA
+{
+
+/**
+ * The ImagePool class recycles the memory of the images used by backing stores.
+ *
+ * Internal windows such as on-screen displays are shown and hidden over and over again,
+ * usually with the same size. Instead of freeing the memory of an image when the last
+ * QImage referencing it goes away, the memory is kept in the pool and handed out again
+ * for the next image with a similar size. Sizes are rounded up to buckets, so a chunk of
+ * memory can be reused after a small resize.
+ */
+class ImagePool
+{
+public:
+    ~ImagePool();
+
+    static ImagePool *self();
+
+    /**
+     * Returns an image with the specified @p size in device pixels, the format is always
+     * QImage::Format_ARGB32_Premultiplied. The contents of the image are undefined.
+     */
+    QImage allocate(const QSize &size, qreal devicePixelRatio);
+
+    /**
+     * Returns the number of times the pool had to allocate new memory.
+     */
+    quint64 allocationCount() const;
+
+    /**
+     * Returns the number of times memory has been handed out again from the pool.
+     */
+    quint64 reuseCount() const;
+
+private:
+    struct Chunk
+    {
+        uchar *data;
+        size_t size;
+    };
+
+    static size_t bucketSize(size_t size);
+    static void recycleChunk(void *info);
+    void recycle(Chunk *chunk);
+
+    mutable QMutex m_mutex;
+    QMultiHash<size_t, Chunk *> m_freeChunks;
+    std::deque<Chunk *> m_freeOrder;
+    size_t m_freeSize = 0;
+    quint64 m_allocationCount = 0;
+    quint64 m_reuseCount = 0;
+};
+
+}
+}
+
+#endif
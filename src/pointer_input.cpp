@@ -267,6 +267,7 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QS
     }
 
     PositionUpdateBlocker blocker(this);
+    m_lastMotionTimestamp = std::chrono::microseconds(timeUsec);
     updatePosition(pos);
     MouseEvent event(QEvent::MouseMove, m_pos, Qt::NoButton, m_qtButtons,
                      input()->keyboardModifiers(), time,
@@ -274,8 +275,8 @@ void PointerInputRedirection::processMotionInternal(const QPointF &pos, const QS
     event.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
 
     update();
-    input()->processSpies(std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
-    input()->processFilters(std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, 0));
+    input()->processSpies(PointerInputEvent, std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
+    input()->processFilters(PointerInputEvent, std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, 0));
 }
 
 void PointerInputRedirection::processButton(uint32_t button, InputRedirection::PointerButtonState state, uint32_t time, InputDevice *device)
@@ -302,13 +303,13 @@ void PointerInputRedirection::processButton(uint32_t button, InputRedirection::P
     event.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
     event.setNativeButton(button);
 
-    input()->processSpies(std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
+    input()->processSpies(PointerInputEvent, std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
 
     if (!inited()) {
         return;
     }
 
-    input()->processFilters(std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, button));
+    input()->processFilters(PointerInputEvent, std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, button));
 
     if (state == InputRedirection::PointerButtonReleased) {
         update();
@@ -328,12 +329,12 @@ void PointerInputRedirection::processAxis(InputRedirection::PointerAxis axis, qr
                            m_qtButtons, input()->keyboardModifiers(), source, time, device);
     wheelEvent.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
 
-    input()->processSpies(std::bind(&InputEventSpy::wheelEvent, std::placeholders::_1, &wheelEvent));
+    input()->processSpies(WheelInputEvent, std::bind(&InputEventSpy::wheelEvent, std::placeholders::_1, &wheelEvent));
 
     if (!inited()) {
         return;
     }
-    input()->processFilters(std::bind(&InputEventFilter::wheelEvent, std::placeholders::_1, &wheelEvent));
+    input()->processFilters(WheelInputEvent, std::bind(&InputEventFilter::wheelEvent, std::placeholders::_1, &wheelEvent));
 }
 
 void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, quint32 time, KWin::InputDevice *device)
@@ -344,8 +345,8 @@ void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, quint32
         return;
     }
 
-    input()->processSpies(std::bind(&InputEventSpy::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processSpies(SwipeGestureInputEvent, std::bind(&InputEventSpy::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(SwipeGestureInputEvent, std::bind(&InputEventFilter::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processSwipeGestureUpdate(const QSizeF &delta, quint32 time, KWin::InputDevice *device)
@@ -357,8 +358,8 @@ void PointerInputRedirection::processSwipeGestureUpdate(const QSizeF &delta, qui
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::swipeGestureUpdate, std::placeholders::_1, delta, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureUpdate, std::placeholders::_1, delta, time));
+    input()->processSpies(SwipeGestureInputEvent, std::bind(&InputEventSpy::swipeGestureUpdate, std::placeholders::_1, delta, time));
+    input()->processFilters(SwipeGestureInputEvent, std::bind(&InputEventFilter::swipeGestureUpdate, std::placeholders::_1, delta, time));
 }
 
 void PointerInputRedirection::processSwipeGestureEnd(quint32 time, KWin::InputDevice *device)
@@ -370,8 +371,8 @@ void PointerInputRedirection::processSwipeGestureEnd(quint32 time, KWin::InputDe
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::swipeGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureEnd, std::placeholders::_1, time));
+    input()->processSpies(SwipeGestureInputEvent, std::bind(&InputEventSpy::swipeGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(SwipeGestureInputEvent, std::bind(&InputEventFilter::swipeGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processSwipeGestureCancelled(quint32 time, KWin::InputDevice *device)
@@ -383,8 +384,8 @@ void PointerInputRedirection::processSwipeGestureCancelled(quint32 time, KWin::I
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::swipeGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::swipeGestureCancelled, std::placeholders::_1, time));
+    input()->processSpies(SwipeGestureInputEvent, std::bind(&InputEventSpy::swipeGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(SwipeGestureInputEvent, std::bind(&InputEventFilter::swipeGestureCancelled, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processPinchGestureBegin(int fingerCount, quint32 time, KWin::InputDevice *device)
@@ -396,8 +397,8 @@ void PointerInputRedirection::processPinchGestureBegin(int fingerCount, quint32
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processSpies(PinchGestureInputEvent, std::bind(&InputEventSpy::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(PinchGestureInputEvent, std::bind(&InputEventFilter::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angleDelta, const QSizeF &delta, quint32 time, KWin::InputDevice *device)
@@ -409,8 +410,8 @@ void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angle
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
+    input()->processSpies(PinchGestureInputEvent, std::bind(&InputEventSpy::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
+    input()->processFilters(PinchGestureInputEvent, std::bind(&InputEventFilter::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
 }
 
 void PointerInputRedirection::processPinchGestureEnd(quint32 time, KWin::InputDevice *device)
@@ -422,8 +423,8 @@ void PointerInputRedirection::processPinchGestureEnd(quint32 time, KWin::InputDe
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::pinchGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureEnd, std::placeholders::_1, time));
+    input()->processSpies(PinchGestureInputEvent, std::bind(&InputEventSpy::pinchGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(PinchGestureInputEvent, std::bind(&InputEventFilter::pinchGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processPinchGestureCancelled(quint32 time, KWin::InputDevice *device)
@@ -435,8 +436,8 @@ void PointerInputRedirection::processPinchGestureCancelled(quint32 time, KWin::I
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::pinchGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::pinchGestureCancelled, std::placeholders::_1, time));
+    input()->processSpies(PinchGestureInputEvent, std::bind(&InputEventSpy::pinchGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(PinchGestureInputEvent, std::bind(&InputEventFilter::pinchGestureCancelled, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processHoldGestureBegin(int fingerCount, quint32 time, KWin::InputDevice *device)
@@ -447,8 +448,8 @@ void PointerInputRedirection::processHoldGestureBegin(int fingerCount, quint32 t
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::holdGestureBegin, std::placeholders::_1, fingerCount, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processSpies(HoldGestureInputEvent, std::bind(&InputEventSpy::holdGestureBegin, std::placeholders::_1, fingerCount, time));
+    input()->processFilters(HoldGestureInputEvent, std::bind(&InputEventFilter::holdGestureBegin, std::placeholders::_1, fingerCount, time));
 }
 
 void PointerInputRedirection::processHoldGestureEnd(quint32 time, KWin::InputDevice *device)
@@ -459,8 +460,8 @@ void PointerInputRedirection::processHoldGestureEnd(quint32 time, KWin::InputDev
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::holdGestureEnd, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureEnd, std::placeholders::_1, time));
+    input()->processSpies(HoldGestureInputEvent, std::bind(&InputEventSpy::holdGestureEnd, std::placeholders::_1, time));
+    input()->processFilters(HoldGestureInputEvent, std::bind(&InputEventFilter::holdGestureEnd, std::placeholders::_1, time));
 }
 
 void PointerInputRedirection::processHoldGestureCancelled(quint32 time, KWin::InputDevice *device)
@@ -471,8 +472,8 @@ void PointerInputRedirection::processHoldGestureCancelled(quint32 time, KWin::In
     }
     update();
 
-    input()->processSpies(std::bind(&InputEventSpy::holdGestureCancelled, std::placeholders::_1, time));
-    input()->processFilters(std::bind(&InputEventFilter::holdGestureCancelled, std::placeholders::_1, time));
+    input()->processSpies(HoldGestureInputEvent, std::bind(&InputEventSpy::holdGestureCancelled, std::placeholders::_1, time));
+    input()->processFilters(HoldGestureInputEvent, std::bind(&InputEventFilter::holdGestureCancelled, std::placeholders::_1, time));
 }
 
 bool PointerInputRedirection::areButtonsPressed() const
@@ -1442,6 +1443,11 @@ InputRedirectionCursor::~InputRedirectionCursor()
 {
 }
 
+std::chrono::microseconds InputRedirectionCursor::lastMotionTimestamp() const
+{
+    return input()->pointer()->lastMotionTimestamp();
+}
+
 void InputRedirectionCursor::doSetPos()
 {
     if (input()->supportsPointerWarping()) {
@@ -20,6 +20,8 @@
 #include <QPointer>
 #include <QPointF>
 
+#include <chrono>
+
 class QWindow;
 
 namespace KWaylandServer
@@ -62,6 +64,12 @@ public:
         return m_qtButtons;
     }
     bool areButtonsPressed() const;
+    /**
+     * The timestamp of the last pointer motion event, in the clock domain of the input events
+     */
+    std::chrono::microseconds lastMotionTimestamp() const {
+        return m_lastMotionTimestamp;
+    }
 
     void setEffectsOverrideCursor(Qt::CursorShape shape);
     void removeEffectsOverrideCursor();
@@ -159,6 +167,7 @@ private:
     void breakPointerConstraints(KWaylandServer::SurfaceInterface *surface);
     CursorImage *m_cursor;
     QPointF m_pos;
+    std::chrono::microseconds m_lastMotionTimestamp = std::chrono::microseconds::zero();
     QHash<uint32_t, InputRedirection::PointerButtonState> m_buttons;
     Qt::MouseButtons m_qtButtons;
     QMetaObject::Connection m_focusGeometryConnection;
@@ -276,6 +285,7 @@ class InputRedirectionCursor : public KWin::Cursor
 public:
     explicit InputRedirectionCursor(QObject *parent);
     ~InputRedirectionCursor() override;
+    std::chrono::microseconds lastMotionTimestamp() const override;
 protected:
     void doSetPos() override;
     void doStartCursorTracking() override;
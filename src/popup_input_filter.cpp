@@ -41,6 +41,11 @@ void PopupInputFilter::handleClientRemoved(Toplevel *client)
 {
     m_popupClients.removeOne(client);
 }
+InputEventTypes PopupInputFilter::eventTypes() const
+{
+    return PointerInputEvent | KeyInputEvent | TouchInputEvent;
+}
+
 bool PopupInputFilter::pointerEvent(QMouseEvent *event, quint32 nativeButton)
 {
     Q_UNUSED(nativeButton)
@@ -117,13 +117,24 @@ void RenderLoopPrivate::notifyFrameFailed()
     if (!inhibitCount) {
         maybeScheduleRepaint();
     }
+
+    Q_EMIT q->frameFailed(q);
 }
 
-void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp)
+void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::optional<uint64_t> sequence)
 {
     Q_ASSERT(pendingFrameCount > 0);
     pendingFrameCount--;
 
+    // Backends that can't tell the hardware vblank counter get a software one. Don't mix
+    // the two, the hardware counter is a different clock and may wrap around.
+    if (sequence) {
+        lastPresentationSequence = *sequence;
+        hasHardwareSequence = true;
+    } else if (!hasHardwareSequence) {
+        lastPresentationSequence++;
+    }
+
     if (lastPresentationTimestamp <= timestamp) {
         lastPresentationTimestamp = timestamp;
     } else {
@@ -147,6 +158,7 @@ void RenderLoopPrivate::dispatch()
     // the Compositor starts repainting.
     pendingRepaint = true;
 
+    Q_EMIT q->aboutToRequestFrame(q);
     Q_EMIT q->frameRequested(q);
 
     // The Compositor may decide to not repaint when the frameRequested() signal is
@@ -233,6 +245,11 @@ std::chrono::nanoseconds RenderLoop::lastPresentationTimestamp() const
     return d->lastPresentationTimestamp;
 }
 
+uint64_t RenderLoop::lastPresentationSequence() const
+{
+    return d->lastPresentationSequence;
+}
+
 std::chrono::nanoseconds RenderLoop::nextPresentationTimestamp() const
 {
     return d->nextPresentationTimestamp;
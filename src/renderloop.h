@@ -79,6 +79,13 @@ public:
      */
     std::chrono::nanoseconds lastPresentationTimestamp() const;
 
+    /**
+     * Returns the vblank sequence number of the last frame that has been presented on the
+     * screen. If the backend doesn't provide the hardware counter, the presented frames are
+     * counted instead.
+     */
+    uint64_t lastPresentationSequence() const;
+
     /**
      * If a repaint has been scheduled, this function returns the expected time when
      * the next frame will be presented on the screen. The returned timestamp is sourced
@@ -119,6 +126,16 @@ Q_SIGNALS:
      * @a timestamp indicates the time when it took place.
      */
     void framePresented(RenderLoop *loop, std::chrono::nanoseconds timestamp);
+    /**
+     * This signal is emitted when a frame has been submitted but failed to be presented.
+     */
+    void frameFailed(RenderLoop *loop);
+
+    /**
+     * This signal is emitted right before frameRequested(). It can be used to update state
+     * that is driven by input, e.g. gesture progress, in time for the upcoming frame.
+     */
+    void aboutToRequestFrame(RenderLoop *loop);
 
     /**
      * This signal is emitted when the render loop wants a new frame to be composited.
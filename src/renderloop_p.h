@@ -11,6 +11,8 @@
 
 #include <QTimer>
 
+#include <optional>
+
 namespace KWin
 {
 
@@ -28,10 +30,13 @@ public:
     void maybeScheduleRepaint();
 
     void notifyFrameFailed();
-    void notifyFrameCompleted(std::chrono::nanoseconds timestamp);
+    void notifyFrameCompleted(std::chrono::nanoseconds timestamp, std::optional<uint64_t> sequence = std::nullopt);
 
     RenderLoop *q;
     std::chrono::nanoseconds lastPresentationTimestamp = std::chrono::nanoseconds::zero();
+    uint64_t lastPresentationSequence = 0;
+    // whether the backend provides the hardware vblank counter
+    bool hasHardwareSequence = false;
     std::chrono::nanoseconds nextPresentationTimestamp = std::chrono::nanoseconds::zero();
     QTimer compositeTimer;
     RenderJournal renderJournal;
@@ -18,6 +18,8 @@
 #include <QDebug>
 #include <QDir>
 
+#include <algorithm>
+
 #ifndef KCMRULES
 #include "x11client.h"
 #include "client_machine.h"
@@ -176,6 +178,24 @@ void Rules::readFromSettings(const RuleSettings *settings)
     READ_SET_RULE(shortcut);
     READ_FORCE_RULE(disableglobalshortcuts,);
     READ_SET_RULE(desktopfile);
+
+    compileMatchers();
+}
+
+void Rules::compileMatchers()
+{
+    auto compile = [](QRegularExpression &regExp, StringMatch match, const QString &pattern) {
+        if (match == RegExpMatch) {
+            regExp.setPattern(pattern);
+            regExp.optimize();
+        } else {
+            regExp = QRegularExpression();
+        }
+    };
+    compile(wmclassRegExp, wmclassmatch, QString::fromUtf8(wmclass));
+    compile(windowroleRegExp, windowrolematch, QString::fromUtf8(windowrole));
+    compile(titleRegExp, titlematch, title);
+    compile(clientmachineRegExp, clientmachinematch, QString::fromUtf8(clientmachine));
 }
 
 #undef READ_MATCH_STRING
@@ -335,10 +355,9 @@ bool Rules::matchType(NET::WindowType match_type) const
 bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_name) const
 {
     if (wmclassmatch != UnimportantMatch) {
-        // TODO optimize?
         QByteArray cwmclass = wmclasscomplete
                               ? match_name + ' ' + match_class : match_class;
-        if (wmclassmatch == RegExpMatch && !QRegularExpression(QString::fromUtf8(wmclass)).match(QString::fromUtf8(cwmclass)).hasMatch())
+        if (wmclassmatch == RegExpMatch && !wmclassRegExp.match(QString::fromUtf8(cwmclass)).hasMatch())
             return false;
         if (wmclassmatch == ExactMatch && wmclass != cwmclass)
             return false;
@@ -351,7 +370,7 @@ bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_
 bool Rules::matchRole(const QByteArray& match_role) const
 {
     if (windowrolematch != UnimportantMatch) {
-        if (windowrolematch == RegExpMatch && !QRegularExpression(QString::fromUtf8(windowrole)).match(QString::fromUtf8(match_role)).hasMatch())
+        if (windowrolematch == RegExpMatch && !windowroleRegExp.match(QString::fromUtf8(match_role)).hasMatch())
             return false;
         if (windowrolematch == ExactMatch && windowrole != match_role)
             return false;
@@ -364,7 +383,7 @@ bool Rules::matchRole(const QByteArray& match_role) const
 bool Rules::matchTitle(const QString& match_title) const
 {
     if (titlematch != UnimportantMatch) {
-        if (titlematch == RegExpMatch && !QRegularExpression(title).match(match_title).hasMatch())
+        if (titlematch == RegExpMatch && !titleRegExp.match(match_title).hasMatch())
             return false;
         if (titlematch == ExactMatch && title != match_title)
             return false;
@@ -382,7 +401,7 @@ bool Rules::matchClientMachine(const QByteArray& match_machine, bool local) cons
                 && matchClientMachine("localhost", true))
             return true;
         if (clientmachinematch == RegExpMatch
-                && !QRegularExpression(QString::fromUtf8(clientmachine)).match(QString::fromUtf8(match_machine)).hasMatch())
+                && !clientmachineRegExp.match(QString::fromUtf8(match_machine)).hasMatch())
             return false;
         if (clientmachinematch == ExactMatch
                 && clientmachine != match_machine)
@@ -396,6 +415,11 @@ bool Rules::matchClientMachine(const QByteArray& match_machine, bool local) cons
 
 #ifndef KCMRULES
 bool Rules::match(const AbstractClient* c) const
+{
+    return matchProperties(c) && matchCaption(c);
+}
+
+bool Rules::matchProperties(const AbstractClient* c) const
 {
     if (!matchType(c->windowType(true)))
         return false;
@@ -405,6 +429,11 @@ bool Rules::match(const AbstractClient* c) const
         return false;
     if (!matchClientMachine(c->clientMachine()->hostName(), c->clientMachine()->isLocal()))
         return false;
+    return true;
+}
+
+bool Rules::matchCaption(const AbstractClient* c) const
+{
     if (titlematch != UnimportantMatch) // track title changes to rematch rules
         QObject::connect(c, &AbstractClient::captionChanged, c, &AbstractClient::evaluateWindowRules,
                          // QueuedConnection, because title may change before
@@ -415,6 +444,18 @@ bool Rules::match(const AbstractClient* c) const
     return true;
 }
 
+QByteArray Rules::exactWindowClass() const
+{
+    if (wmclassmatch != ExactMatch)
+        return QByteArray();
+    return wmclass;
+}
+
+bool Rules::isWindowClassComplete() const
+{
+    return wmclasscomplete;
+}
+
 #define NOW_REMEMBER(_T_, _V_) ((selection & _T_) && (_V_##rule == (SetRule)Remember))
 
 bool Rules::update(AbstractClient* c, int selection)
@@ -969,29 +1010,112 @@ void RuleBook::deleteAll()
 {
     qDeleteAll(m_rules);
     m_rules.clear();
+    invalidateMatches();
+}
+
+bool RuleBook::MatchKey::operator==(const MatchKey &other) const
+{
+    return windowType == other.windowType
+        && resourceClass == other.resourceClass
+        && resourceName == other.resourceName
+        && windowRole == other.windowRole
+        && hostName == other.hostName
+        && isLocal == other.isLocal;
+}
+
+void RuleBook::invalidateMatches()
+{
+    // Cached matches refer to rules by pointer, they must never be used after m_rules changes.
+    ++m_generation;
+    m_indexDirty = true;
+}
+
+void RuleBook::rebuildIndex()
+{
+    m_windowClassIndex.clear();
+    m_completeWindowClassIndex.clear();
+    m_unindexedRules.clear();
+
+    for (int i = 0; i < m_rules.count(); ++i) {
+        const Rules *rule = m_rules.at(i);
+        const QByteArray windowClass = rule->exactWindowClass();
+        if (windowClass.isEmpty()) {
+            m_unindexedRules.append(i);
+        } else if (rule->isWindowClassComplete()) {
+            m_completeWindowClassIndex[windowClass].append(i);
+        } else {
+            m_windowClassIndex[windowClass].append(i);
+        }
+    }
+
+    m_indexDirty = false;
+}
+
+QVector<Rules *> RuleBook::candidateRules(const AbstractClient *c)
+{
+    const MatchKey key{
+        c->windowType(true),
+        c->resourceClass(),
+        c->resourceName(),
+        c->windowRole(),
+        c->clientMachine()->hostName(),
+        c->clientMachine()->isLocal(),
+    };
+
+    auto it = m_matchCache.find(c);
+    if (it == m_matchCache.end()) {
+        connect(c, &QObject::destroyed, this, [this, c]() {
+            m_matchCache.remove(c);
+        });
+        it = m_matchCache.insert(c, MatchCache());
+    } else if (it->generation == m_generation && it->key == key) {
+        return it->candidates;
+    }
+
+    if (m_indexDirty) {
+        rebuildIndex();
+    }
+
+    // Only rules that can possibly match the window class need to be checked, but they
+    // must be visited in the order of m_rules because that's their priority order.
+    QVector<int> indices = m_unindexedRules;
+    indices += m_windowClassIndex.value(key.resourceClass);
+    indices += m_completeWindowClassIndex.value(key.resourceName + ' ' + key.resourceClass);
+    std::sort(indices.begin(), indices.end());
+
+    it->key = key;
+    it->generation = m_generation;
+    it->candidates.clear();
+    for (int index : qAsConst(indices)) {
+        Rules *rule = m_rules.at(index);
+        if (rule->matchProperties(c)) {
+            it->candidates.append(rule);
+        }
+    }
+
+    return it->candidates;
 }
 
 WindowRules RuleBook::find(const AbstractClient* c, bool ignore_temporary)
 {
     QVector< Rules* > ret;
-    for (QList< Rules* >::Iterator it = m_rules.begin();
-            it != m_rules.end();
-       ) {
-        if (ignore_temporary && (*it)->isTemporary()) {
-            ++it;
+    bool consumedTemporary = false;
+    const QVector<Rules *> candidates = candidateRules(c);
+    for (Rules *rule : candidates) {
+        if (ignore_temporary && rule->isTemporary()) {
             continue;
         }
-        if ((*it)->match(c)) {
-            Rules* rule = *it;
+        if (rule->matchCaption(c)) {
             qCDebug(KWIN_CORE) << "Rule found:" << rule << ":" << c;
-            if (rule->isTemporary())
-                it = m_rules.erase(it);
-            else
-                ++it;
+            if (rule->isTemporary()) {
+                m_rules.removeOne(rule);
+                consumedTemporary = true;
+            }
             ret.append(rule);
-            continue;
         }
-        ++it;
+    }
+    if (consumedTemporary) {
+        invalidateMatches();
     }
     return WindowRules(ret);
 }
@@ -1059,6 +1183,7 @@ void RuleBook::temporaryRulesMessage(const QString& message)
             was_temporary = true;
     Rules* rule = new Rules(message, true);
     m_rules.prepend(rule);   // highest priority first
+    invalidateMatches();
     if (!was_temporary)
         QTimer::singleShot(60000, this, &RuleBook::cleanupTemporaryRules);
 }
@@ -1071,6 +1196,7 @@ void RuleBook::cleanupTemporaryRules()
        ) {
         if ((*it)->discardTemporary(false)) { // deletes (*it)
             it = m_rules.erase(it);
+            invalidateMatches();
         } else {
             if ((*it)->isTemporary())
                 has_temporary = true;
@@ -1096,6 +1222,7 @@ void RuleBook::discardUsed(AbstractClient* c, bool withdrawn)
                 Rules* r = *it;
                 it = m_rules.erase(it);
                 delete r;
+                invalidateMatches();
                 continue;
             }
         }
@@ -12,7 +12,9 @@
 
 
 #include <netwm_def.h>
+#include <QHash>
 #include <QRect>
+#include <QRegularExpression>
 #include <QVector>
 
 #include "placement.h"
@@ -134,6 +136,21 @@ public:
 #ifndef KCMRULES
     bool discardUsed(bool withdrawn);
     bool match(const AbstractClient* c) const;
+    /**
+     * Matches all properties except the caption. The result only depends on the window type,
+     * the window class, the window role and the client machine of @p c.
+     */
+    bool matchProperties(const AbstractClient* c) const;
+    /**
+     * Matches the caption of @p c, and starts tracking caption changes if needed.
+     */
+    bool matchCaption(const AbstractClient* c) const;
+    /**
+     * Returns the window class that a window must have for this rule to match, or an empty
+     * QByteArray if the rule doesn't match the window class exactly.
+     */
+    QByteArray exactWindowClass() const;
+    bool isWindowClassComplete() const;
     bool update(AbstractClient*, int selection);
     bool isTemporary() const;
     bool discardTemporary(bool force);   // removes if temporary and forced or too old
@@ -186,6 +203,7 @@ private:
 private:
 #endif
     void readFromSettings(const RuleSettings *settings);
+    void compileMatchers();
     static ForceRule convertForceRule(int v);
     static QString getDecoColor(const QString &themeName);
 #ifndef KCMRULES
@@ -205,6 +223,11 @@ private:
     StringMatch titlematch;
     QByteArray clientmachine;
     StringMatch clientmachinematch;
+    // compiled once when the rule is loaded, used only with RegExpMatch
+    QRegularExpression wmclassRegExp;
+    QRegularExpression windowroleRegExp;
+    QRegularExpression titleRegExp;
+    QRegularExpression clientmachineRegExp;
     NET::WindowTypes types; // types for matching
     Placement::Policy placement;
     ForceRule placementrule;
@@ -305,12 +328,38 @@ private Q_SLOTS:
     void save();
 
 private:
+    struct MatchKey {
+        NET::WindowType windowType;
+        QByteArray resourceClass;
+        QByteArray resourceName;
+        QByteArray windowRole;
+        QByteArray hostName;
+        bool isLocal;
+
+        bool operator==(const MatchKey &other) const;
+    };
+    struct MatchCache {
+        MatchKey key;
+        quint64 generation = 0;
+        QVector<Rules *> candidates;
+    };
+
     void deleteAll();
     void initializeX11();
     void cleanupX11();
+    void invalidateMatches();
+    void rebuildIndex();
+    QVector<Rules *> candidateRules(const AbstractClient *c);
     QTimer *m_updateTimer;
     bool m_updatesDisabled;
     QList<Rules*> m_rules;
+    // rules with an exact window class match, indexed by the window class
+    QHash<QByteArray, QVector<int>> m_windowClassIndex;
+    QHash<QByteArray, QVector<int>> m_completeWindowClassIndex;
+    QVector<int> m_unindexedRules;
+    bool m_indexDirty = true;
+    quint64 m_generation = 0;
+    QHash<const AbstractClient *, MatchCache> m_matchCache;
     QScopedPointer<KXMessages> m_temporaryRulesMessages;
     KSharedConfig::Ptr m_config;
 
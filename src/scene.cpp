@@ -64,6 +64,8 @@
 #include "workspace.h"
 #include "x11client.h"
 
+#include <KWaylandServer/clientbuffer.h>
+
 #include <QQuickWindow>
 #include <QVector2D>
 
@@ -74,6 +76,7 @@
 #include "shadow.h"
 #include "wayland_server.h"
 #include "composite.h"
+#include "ftrace.h"
 #include <QtMath>
 
 namespace KWin
@@ -144,9 +147,10 @@ void Scene::addRepaint(const QRect &rect)
 void Scene::addRepaint(const QRegion &region)
 {
     if (kwinApp()->platform()->isPerScreenRenderingEnabled()) {
+        const DamageRegion damage(region);
         const QVector<AbstractOutput *> outputs = kwinApp()->platform()->enabledOutputs();
         for (const auto &output : outputs) {
-            const QRegion dirtyRegion = region & output->geometry();
+            const DamageRegion dirtyRegion = damage.intersected(output->geometry());
             if (!dirtyRegion.isEmpty()) {
                 m_repaints[output] += dirtyRegion;
                 output->renderLoop()->scheduleRepaint();
@@ -173,17 +177,74 @@ void Scene::setGeometry(const QRect &rect)
 
 QRegion Scene::repaints(AbstractOutput *output) const
 {
-    return m_repaints.value(output, infiniteRegion());
+    const auto it = m_repaints.constFind(output);
+    if (it == m_repaints.constEnd()) {
+        return infiniteRegion();
+    }
+    return it->toRegion();
 }
 
 void Scene::resetRepaints(AbstractOutput *output)
 {
-    m_repaints.insert(output, QRegion());
+    m_repaints[output].clear();
 }
 
 void Scene::removeRepaints(AbstractOutput *output)
 {
     m_repaints.remove(output);
+    m_dirtyItems.remove(output);
+}
+
+void Scene::addDirtyItem(Item *item, AbstractOutput *output)
+{
+    m_dirtyItems[output].append(item);
+}
+
+void Scene::removeDirtyItem(Item *item, AbstractOutput *output)
+{
+    auto it = m_dirtyItems.find(output);
+    if (it != m_dirtyItems.end()) {
+        it->removeAll(item);
+    }
+}
+
+/**
+ * Takes the repaints of all items that have scheduled repaints on the given @a output. The
+ * repaints are grouped by the top-level item, usually the WindowItem of a Scene::Window.
+ *
+ * Only dirty items are visited, so idle windows don't add to the cost of a frame. Items that
+ * don't belong to a window in the current stacking order keep their repaints, they are taken
+ * once their window gets painted again.
+ */
+QHash<Item *, DamageRegion> Scene::takeItemRepaints(AbstractOutput *output)
+{
+    QHash<Item *, DamageRegion> repaints;
+
+    const QVector<Item *> dirtyItems = m_dirtyItems.take(output);
+    if (dirtyItems.isEmpty()) {
+        return repaints;
+    }
+
+    QSet<Item *> windowItems;
+    windowItems.reserve(stacking_order.count());
+    for (const Window *window : qAsConst(stacking_order)) {
+        windowItems.insert(window->windowItem());
+    }
+
+    for (Item *item : dirtyItems) {
+        Item *rootItem = item;
+        while (Item *parentItem = rootItem->parentItem()) {
+            rootItem = parentItem;
+        }
+        if (!windowItems.contains(rootItem)) {
+            m_dirtyItems[output].append(item);
+            continue;
+        }
+        repaints[rootItem] += item->repaints(output);
+        item->resetRepaints(output);
+    }
+
+    return repaints;
 }
 
 
@@ -225,6 +286,12 @@ void Scene::paintScreen(AbstractOutput *output, const QList<Toplevel *> &topleve
     paintScreen(geo, repaint, &update, &valid, output->renderLoop(), createProjectionMatrix(output->geometry()));
     clearStackingOrder();
 }
+
+bool Scene::isWindowOccluded(Toplevel *toplevel, AbstractOutput *output) const
+{
+    const Window *window = m_windows.value(toplevel);
+    return window && window->isOccluded(output);
+}
 // returns mask and possibly modified region
 void Scene::paintScreen(const QRegion &damage, const QRegion &repaint,
                         QRegion *updateRegion, QRegion *validRegion, RenderLoop *renderLoop,
@@ -307,28 +374,18 @@ void Scene::finalPaintScreen(int mask, const QRegion &region, ScreenPaintData& d
         paintSimpleScreen(mask, region);
 }
 
-static void resetRepaintsHelper(Item *item, AbstractOutput *output)
-{
-    item->resetRepaints(output);
-
-    const auto childItems = item->childItems();
-    for (Item *childItem : childItems) {
-        resetRepaintsHelper(childItem, output);
-    }
-}
-
 // The generic painting code that can handle even transformations.
 // It simply paints bottom-to-top.
 void Scene::paintGenericScreen(int orig_mask, const ScreenPaintData &)
 {
+    // Reset the repaint_region.
+    // This has to be done before calling prePaintWindow because many effects schedule
+    // a repaint for the next frame within Effects::prePaintWindow.
+    takeItemRepaints(painted_screen);
+
     QVector<Phase2Data> phase2;
     phase2.reserve(stacking_order.size());
     for (Window * w : qAsConst(stacking_order)) { // bottom to top
-        // Reset the repaint_region.
-        // This has to be done here because many effects schedule a repaint for
-        // the next frame within Effects::prePaintWindow.
-        resetRepaintsHelper(w->windowItem(), painted_screen);
-
         WindowPrePaintData data;
         data.mask = orig_mask | (w->isOpaque() ? PAINT_WINDOW_OPAQUE : PAINT_WINDOW_TRANSLUCENT);
         w->resetPaintingEnabled();
@@ -336,6 +393,8 @@ void Scene::paintGenericScreen(int orig_mask, const ScreenPaintData &)
         data.clip = QRegion();
         // preparation step
         effects->prePaintWindow(effectWindow(w), data, m_expectedPresentTimestamp);
+        // with transformed windows there is no occlusion culling, so consider every painted window visible
+        w->setOccluded(painted_screen, !w->isPaintingEnabled());
         if (!w->isPaintingEnabled()) {
             continue;
         }
@@ -359,17 +418,6 @@ void Scene::paintGenericScreen(int orig_mask, const ScreenPaintData &)
     }
 }
 
-static void accumulateRepaints(Item *item, AbstractOutput *output, QRegion *repaints)
-{
-    *repaints += item->repaints(output);
-    item->resetRepaints(output);
-
-    const auto childItems = item->childItems();
-    for (Item *childItem : childItems) {
-        accumulateRepaints(childItem, output, repaints);
-    }
-}
-
 // The optimized case without any transformations at all.
 // It can paint only the requested region and can use clipping
 // to reduce painting and improve performance.
@@ -380,6 +428,8 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
     QVector<Phase2Data> phase2data;
     phase2data.reserve(stacking_order.size());
 
+    const QHash<Item *, DamageRegion> itemRepaints = takeItemRepaints(painted_screen);
+
     QRegion dirtyArea = region;
     bool opaqueFullscreen = false;
 
@@ -391,7 +441,10 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
         data.mask = orig_mask | (window->isOpaque() ? PAINT_WINDOW_OPAQUE : PAINT_WINDOW_TRANSLUCENT);
         window->resetPaintingEnabled();
         data.paint = region;
-        accumulateRepaints(window->windowItem(), painted_screen, &data.paint);
+        const auto repaints = itemRepaints.constFind(window->windowItem());
+        if (repaints != itemRepaints.constEnd()) {
+            data.paint += repaints->toRegion();
+        }
 
         // Clip out the decoration for opaque windows; the decoration is drawn in the second pass
         opaqueFullscreen = false; // TODO: do we care about unmanged windows here (maybe input windows?)
@@ -426,6 +479,7 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
 
         // preparation step
         effects->prePaintWindow(effectWindow(window), data, m_expectedPresentTimestamp);
+        window->setOccluded(painted_screen, true);
         if (!window->isPaintingEnabled()) {
             continue;
         }
@@ -460,6 +514,14 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
             data->region |= upperTranslucentDamage;
         }
 
+        // the window is visible if opaque windows above it leave any part of its contents uncovered
+        const Item *contentItem = data->window->surfaceItem();
+        if (!contentItem) {
+            contentItem = data->window->windowItem();
+        }
+        const QRegion visibleRegion = (displayRegion & contentItem->mapToGlobal(contentItem->boundingRect())) - allclips;
+        data->window->setOccluded(painted_screen, visibleRegion.isEmpty());
+
         // subtract the parts which will possibly been drawn as part of
         // a higher opaque window
         data->region -= allclips;
@@ -621,6 +683,25 @@ bool Scene::supportsNativeFence() const
     return false;
 }
 
+bool Scene::canReleaseClientBuffersEarly() const
+{
+    return false;
+}
+
+void Scene::releaseClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime)
+{
+    unrefClientBuffer(buffer, attachTime);
+}
+
+void Scene::unrefClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime)
+{
+    buffer->unref();
+
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    const auto holdTime = std::chrono::duration_cast<std::chrono::microseconds>(now - attachTime);
+    fTrace("client buffer hold usec=", holdTime.count());
+}
+
 QMatrix4x4 Scene::screenProjectionMatrix() const
 {
     return QMatrix4x4();
@@ -745,6 +826,20 @@ bool Scene::Window::isVisible() const
     return true; // Unmanaged is always visible
 }
 
+bool Scene::Window::isOccluded(AbstractOutput *output) const
+{
+    return m_occludedOutputs.contains(output);
+}
+
+void Scene::Window::setOccluded(AbstractOutput *output, bool occluded)
+{
+    if (occluded) {
+        m_occludedOutputs.insert(output);
+    } else {
+        m_occludedOutputs.remove(output);
+    }
+}
+
 bool Scene::Window::isOpaque() const
 {
     return toplevel->opacity() == 1.0 && !toplevel->hasAlpha();
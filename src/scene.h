@@ -12,11 +12,19 @@
 
 #include "toplevel.h"
 #include "utils/common.h"
+#include "utils/damageregion.h"
 #include "kwineffects.h"
 
 #include <QElapsedTimer>
 #include <QMatrix4x4>
 
+#include <chrono>
+
+namespace KWaylandServer
+{
+class ClientBuffer;
+}
+
 namespace KWin
 {
 
@@ -71,6 +79,12 @@ public:
     QRegion repaints(AbstractOutput *output) const;
     void resetRepaints(AbstractOutput *output);
 
+    /**
+     * Adds the @a item to the list of items that have repaints on the given @a output.
+     */
+    void addDirtyItem(Item *item, AbstractOutput *output);
+    void removeDirtyItem(Item *item, AbstractOutput *output);
+
     // Returns true if the ctor failed to properly initialize.
     virtual bool initFailed() const = 0;
 
@@ -84,6 +98,12 @@ public:
 
     void paintScreen(AbstractOutput *output, const QList<Toplevel *> &toplevels);
 
+    /**
+     * Returns @c true if none of the pixels of @a toplevel ended up on @a output in the
+     * last frame painted on it, e.g. because it's entirely covered by opaque windows above it.
+     */
+    bool isWindowOccluded(Toplevel *toplevel, AbstractOutput *output) const;
+
     /**
      * Adds the Toplevel to the Scene.
      *
@@ -189,6 +209,23 @@ public:
 
     virtual void paintDesktop(int desktop, int mask, const QRegion &region, ScreenPaintData &data);
 
+    /**
+     * Returns @c true if client buffers that have been replaced by newer ones can be released
+     * as soon as the client commits, rather than when the next frame is prepared.
+     *
+     * Default implementation returns @c false.
+     */
+    virtual bool canReleaseClientBuffersEarly() const;
+
+    /**
+     * Drops the reference to the client @p buffer once the GPU no longer reads it. The
+     * @p attachTime is the monotonic time at which the buffer has been attached, it is used
+     * to report how long client buffers are held by the compositor.
+     *
+     * Default implementation drops the reference immediately.
+     */
+    virtual void releaseClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime);
+
     static QMatrix4x4 createProjectionMatrix(const QRect &rect);
 
 Q_SIGNALS:
@@ -199,6 +236,7 @@ public Q_SLOTS:
     void windowClosed(KWin::Toplevel* c, KWin::Deleted* deleted);
 protected:
     virtual Window *createWindow(Toplevel *toplevel) = 0;
+    void unrefClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime);
     void createStackingOrder(const QList<Toplevel *> &toplevels);
     void clearStackingOrder();
     // shared implementation, starts painting the screen
@@ -261,10 +299,12 @@ protected:
 private:
     void removeRepaints(AbstractOutput *output);
     void addCursorRepaints();
+    QHash<Item *, DamageRegion> takeItemRepaints(AbstractOutput *output);
 
     std::chrono::milliseconds m_expectedPresentTimestamp = std::chrono::milliseconds::zero();
     QHash< Toplevel*, Window* > m_windows;
-    QMap<AbstractOutput *, QRegion> m_repaints;
+    QMap<AbstractOutput *, DamageRegion> m_repaints;
+    QHash<AbstractOutput *, QVector<Item *>> m_dirtyItems;
     QRect m_geometry;
     // how many times finalPaintScreen() has been called
     int m_paintScreenCount = 0;
@@ -312,6 +352,9 @@ public:
     void disablePainting(int reason);
     // is the window visible at all
     bool isVisible() const;
+    // did the window contribute no pixels to the last frame painted on the output
+    bool isOccluded(AbstractOutput *output) const;
+    void setOccluded(AbstractOutput *output, bool occluded);
     // is the window fully opaque
     bool isOpaque() const;
     QRegion decorationShape() const;
@@ -331,6 +374,7 @@ private:
     void updateWindowPosition();
 
     int disable_painting;
+    QSet<AbstractOutput *> m_occludedOutputs;
     QScopedPointer<WindowItem> m_windowItem;
     Q_DISABLE_COPY(Window)
 };
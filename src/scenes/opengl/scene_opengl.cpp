@@ -12,6 +12,7 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "scene_opengl.h"
+#include "eglnativefence.h"
 #include "openglsurfacetexture.h"
 
 #include "platform.h"
@@ -37,6 +38,7 @@
 
 #include <cmath>
 #include <cstddef>
+#include <poll.h>
 
 #include <QGraphicsScale>
 #include <QPainter>
@@ -75,7 +77,15 @@ SceneOpenGL::~SceneOpenGL()
 {
     if (init_ok) {
         makeOpenGLContextCurrent();
+        glFinish();
     }
+    for (const QSharedPointer<FrameFence> &frameFence : qAsConst(m_pendingFrameFences)) {
+        for (const auto &buffer : qAsConst(frameFence->buffers)) {
+            unrefClientBuffer(buffer.first, buffer.second);
+        }
+    }
+    m_pendingFrameFences.clear();
+    m_frameFence.reset();
     if (m_lanczosFilter) {
         delete m_lanczosFilter;
         m_lanczosFilter = nullptr;
@@ -184,6 +194,57 @@ static SurfaceItem *findTopMostSurface(SurfaceItem *item)
     }
 }
 
+static QRect globalBoundingRect(const Scene::Window *window)
+{
+    const WindowItem *item = window->windowItem();
+    return item->mapToGlobal(item->boundingRect());
+}
+
+SurfaceItem *SceneOpenGL::findScanoutCandidate(AbstractOutput *output) const
+{
+    const QRect geo = output->geometry();
+    for (int i = stacking_order.count() - 1; i >= 0; i--) {
+        Window *window = stacking_order[i];
+        Toplevel *toplevel = window->window();
+        if (!toplevel->isOnOutput(output) || !window->isVisible() || toplevel->opacity() <= 0) {
+            continue;
+        }
+        if (!window->surfaceItem()) {
+            return nullptr;
+        }
+        SurfaceItem *topMost = findTopMostSurface(window->surfaceItem());
+        auto pixmap = topMost->pixmap();
+        if (!pixmap) {
+            return nullptr;
+        }
+        pixmap->update();
+        // the surface has to be completely opaque
+        if (!window->isOpaque() && !topMost->opaque().contains(topMost->rect())) {
+            return nullptr;
+        }
+        const QRect surfaceRect = topMost->mapToGlobal(topMost->rect());
+        if (surfaceRect.contains(geo)) {
+            return topMost;
+        }
+        // If the surface doesn't cover the output, e.g. with letterboxing, the plane only covers
+        // a part of the crtc and the rest is black. That's only correct if nothing else would be
+        // painted there, neither by the same window nor by any window below it.
+        const QRegion uncovered = QRegion(geo) - surfaceRect;
+        if (uncovered.intersects(globalBoundingRect(window))) {
+            return nullptr;
+        }
+        for (int j = i - 1; j >= 0; j--) {
+            Window *below = stacking_order[j];
+            if (below->window()->isOnOutput(output) && below->isVisible() && below->window()->opacity() > 0
+                && uncovered.intersects(globalBoundingRect(below))) {
+                return nullptr;
+            }
+        }
+        return topMost;
+    }
+    return nullptr;
+}
+
 void SceneOpenGL::paint(AbstractOutput *output, const QRegion &damage, const QList<Toplevel *> &toplevels,
                         RenderLoop *renderLoop)
 {
@@ -207,42 +268,27 @@ void SceneOpenGL::paint(AbstractOutput *output, const QRegion &damage, const QLi
     renderLoop->beginFrame();
 
     SurfaceItem *fullscreenSurface = nullptr;
-    for (int i = stacking_order.count() - 1; i >=0; i--) {
-        Window *window = stacking_order[i];
-        Toplevel *toplevel = window->window();
-        if (output && toplevel->isOnOutput(output) && window->isVisible() && toplevel->opacity() > 0) {
-            AbstractClient *c = dynamic_cast<AbstractClient*>(toplevel);
-            if (!c || !c->isFullScreen()) {
-                break;
-            }
-            if (!window->surfaceItem()) {
-                break;
-            }
-            SurfaceItem *topMost = findTopMostSurface(window->surfaceItem());
-            auto pixmap = topMost->pixmap();
-            if (!pixmap) {
-                break;
-            }
-            pixmap->update();
-            // the subsurface has to be able to cover the whole window
-            if (topMost->position() != QPoint(0, 0)) {
-                break;
-            }
-            // and it has to be completely opaque
-            if (!window->isOpaque() && !topMost->opaque().contains(QRect(0, 0, window->width(), window->height()))) {
-                break;
-            }
-            fullscreenSurface = topMost;
-            break;
+    SurfaceItem *scanoutCandidate = output ? findScanoutCandidate(output) : nullptr;
+    if (scanoutCandidate) {
+        const AbstractClient *c = dynamic_cast<AbstractClient *>(scanoutCandidate->window());
+        if (c && c->isFullScreen()) {
+            fullscreenSurface = scanoutCandidate;
         }
     }
     renderLoop->setFullscreenSurface(fullscreenSurface);
 
     bool directScanout = false;
     if (m_backend->directScanoutAllowed(output) && !static_cast<EffectsHandlerImpl*>(effects)->blocksDirectScanout()) {
-        directScanout = m_backend->scanout(output, fullscreenSurface);
+        directScanout = m_backend->scanout(output, scanoutCandidate);
     }
     if (directScanout) {
+        // paintScreen() doesn't run, so the occlusion state of the last composited frame
+        // would be kept and throttle the frame callbacks of windows that are visible now
+        for (Window *window : qAsConst(stacking_order)) {
+            if (window->window()->isOnOutput(output)) {
+                window->setOccluded(output, false);
+            }
+        }
         renderLoop->endFrame();
     } else {
         // prepare rendering makescontext current on the output
@@ -261,6 +307,7 @@ void SceneOpenGL::paint(AbstractOutput *output, const QRegion &damage, const QLi
         paintCursor(output, valid);
 
         renderLoop->endFrame();
+        insertFrameFence();
 
         GLVertexBuffer::streamingBuffer()->endOfFrame();
         m_backend->endFrame(output, valid, update);
@@ -391,6 +438,77 @@ bool SceneOpenGL::supportsNativeFence() const
     return m_backend->supportsNativeFence();
 }
 
+bool SceneOpenGL::canReleaseClientBuffersEarly() const
+{
+    // Without fences, there is no way to tell when the GPU is done with a buffer.
+    return supportsNativeFence();
+}
+
+static bool isFenceSignaled(int fileDescriptor)
+{
+    pollfd pfd = {
+        .fd = fileDescriptor,
+        .events = POLLIN,
+        .revents = 0,
+    };
+    return poll(&pfd, 1, 0) == 1;
+}
+
+void SceneOpenGL::insertFrameFence()
+{
+    if (!supportsNativeFence()) {
+        return;
+    }
+
+    // Client buffers that are replaced from now on have been sampled at most by this frame.
+    QSharedPointer<FrameFence> frameFence(new FrameFence);
+    frameFence->fence.reset(new EGLNativeFence(kwinApp()->platform()->sceneEglDisplay()));
+    if (frameFence->fence->isValid()) {
+        m_frameFence = frameFence;
+    } else {
+        qCWarning(KWIN_OPENGL) << "Failed to create a native EGL fence";
+        m_frameFence.reset();
+    }
+}
+
+void SceneOpenGL::releaseClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime)
+{
+    if (!m_frameFence || isFenceSignaled(m_frameFence->fence->fileDescriptor())) {
+        unrefClientBuffer(buffer, attachTime);
+        return;
+    }
+
+    if (!m_frameFence->notifier) {
+        FrameFence *frameFence = m_frameFence.data();
+        frameFence->notifier.reset(new QSocketNotifier(frameFence->fence->fileDescriptor(), QSocketNotifier::Read));
+        connect(frameFence->notifier.data(), &QSocketNotifier::activated, this, [this, frameFence]() {
+            handleFrameFenceSignaled(frameFence);
+        });
+        m_pendingFrameFences.append(m_frameFence);
+    }
+    m_frameFence->buffers.append(qMakePair(buffer, attachTime));
+}
+
+void SceneOpenGL::handleFrameFenceSignaled(FrameFence *frameFence)
+{
+    for (const auto &buffer : qAsConst(frameFence->buffers)) {
+        unrefClientBuffer(buffer.first, buffer.second);
+    }
+    frameFence->buffers.clear();
+
+    // The notifier can't be destroyed while it's emitting the activated signal.
+    frameFence->notifier->setEnabled(false);
+    frameFence->notifier.take()->deleteLater();
+
+    auto it = std::find_if(m_pendingFrameFences.begin(), m_pendingFrameFences.end(),
+                           [frameFence](const QSharedPointer<FrameFence> &pending) {
+                               return pending.data() == frameFence;
+                           });
+    if (it != m_pendingFrameFences.end()) {
+        m_pendingFrameFences.erase(it);
+    }
+}
+
 Scene::EffectFrame *SceneOpenGL::createEffectFrame(EffectFrameImpl *frame)
 {
     return new SceneOpenGL::EffectFrame(frame, this);
@@ -19,8 +19,11 @@
 
 #include "kwinglutils.h"
 
+#include <QSocketNotifier>
+
 namespace KWin
 {
+class EGLNativeFence;
 class LanczosFilter;
 class OpenGLBackend;
 
@@ -40,6 +43,8 @@ public:
     bool makeOpenGLContextCurrent() override;
     void doneOpenGLContextCurrent() override;
     bool supportsNativeFence() const override;
+    bool canReleaseClientBuffersEarly() const override;
+    void releaseClientBuffer(KWaylandServer::ClientBuffer *buffer, std::chrono::nanoseconds attachTime) override;
     DecorationRenderer *createDecorationRenderer(Decoration::DecoratedClientImpl *impl) override;
     bool animationsSupported() const override;
     SurfaceTexture *createSurfaceTextureInternal(SurfacePixmapInternal *pixmap) override;
@@ -74,9 +79,27 @@ protected:
     void paintCursor(AbstractOutput *output, const QRegion &region) override;
 
 private:
+    /**
+     * The FrameFence struct tracks the client buffers that can be released once the GPU
+     * has finished a frame.
+     */
+    struct FrameFence
+    {
+        QScopedPointer<EGLNativeFence> fence;
+        QScopedPointer<QSocketNotifier> notifier;
+        QVector<QPair<KWaylandServer::ClientBuffer *, std::chrono::nanoseconds>> buffers;
+    };
+
+    /**
+     * Returns the surface that is the only visible content on the @a output, if there is one.
+     * The surface either covers the whole output or only black would be painted around it.
+     */
+    SurfaceItem *findScanoutCandidate(AbstractOutput *output) const;
     void doPaintBackground(const QVector< float >& vertices);
     void updateProjectionMatrix(const QRect &geometry);
     void performPaintWindow(EffectWindowImpl* w, int mask, const QRegion &region, WindowPaintData& data);
+    void insertFrameFence();
+    void handleFrameFenceSignaled(FrameFence *frameFence);
 
     bool init_ok = true;
     OpenGLBackend *m_backend;
@@ -86,6 +109,8 @@ private:
     QMatrix4x4 m_projectionMatrix;
     QMatrix4x4 m_screenProjectionMatrix;
     GLuint vao = 0;
+    QSharedPointer<FrameFence> m_frameFence;
+    QVector<QSharedPointer<FrameFence>> m_pendingFrameFences;
 };
 
 class OpenGLWindow final : public Scene::Window
@@ -8,6 +8,7 @@
 */
 #include "scene_qpainter.h"
 #include "qpaintersurfacetexture.h"
+#include "tiledrenderer.h"
 // KWin
 #include "abstract_client.h"
 #include "composite.h"
@@ -47,6 +48,7 @@ SceneQPainter::SceneQPainter(QPainterBackend *backend, QObject *parent)
     : Scene(parent)
     , m_backend(backend)
     , m_painter(new QPainter())
+    , m_renderer(new TiledRenderer())
 {
 }
 
@@ -84,11 +86,14 @@ void SceneQPainter::paint(AbstractOutput *output, const QRegion &damage, const Q
         renderLoop->beginFrame();
         m_painter->begin(buffer);
         m_painter->setWindow(geometry);
+        m_renderer->begin(buffer);
 
         QRegion updateRegion, validRegion;
         paintScreen(damage.intersected(geometry), repaint, &updateRegion, &validRegion, renderLoop);
+        m_renderer->flush();
         paintCursor(output, updateRegion);
 
+        m_renderer->begin(nullptr);
         m_painter->end();
         renderLoop->endFrame();
         m_backend->endFrame(output, validRegion, updateRegion);
@@ -100,8 +105,9 @@ void SceneQPainter::paint(AbstractOutput *output, const QRegion &damage, const Q
 
 void SceneQPainter::paintBackground(const QRegion &region)
 {
+    const QTransform transform = m_painter->combinedTransform();
     for (const QRect &rect : region) {
-        m_painter->fillRect(rect, Qt::black);
+        m_renderer->fillRect(transform, rect, Qt::black);
     }
 }
 
@@ -148,8 +154,17 @@ Shadow *SceneQPainter::createShadow(Toplevel *toplevel)
     return new SceneQPainterShadow(toplevel);
 }
 
+QPainter *SceneQPainter::scenePainter() const
+{
+    // Everything that has been recorded so far has to end up in the buffer before anyone
+    // else paints into it.
+    m_renderer->flush();
+    return m_painter.data();
+}
+
 QImage *SceneQPainter::qpainterRenderBuffer(AbstractOutput *output) const
 {
+    m_renderer->flush();
     return m_backend->bufferForScreen(output);
 }
 
@@ -177,11 +192,21 @@ void SceneQPainter::Window::performPaint(int mask, const QRegion &_region, const
     if (region.isEmpty())
         return;
 
-    QPainter *scenePainter = m_scene->scenePainter();
-    QPainter *painter = scenePainter;
+    // The scene painter is only used to keep track of the transform, the actual painting
+    // is done by the tiled renderer.
+    QPainter *painter = m_scene->m_painter.data();
+    TiledRenderer *renderer = m_scene->m_renderer.data();
+
+    // Limit the region to the buffer first, it can be infinite.
+    const QTransform deviceTransform = painter->combinedTransform();
+    const QRect deviceRect(0, 0, painter->device()->width(), painter->device()->height());
+    const QRegion deviceClip = deviceTransform.map(region & deviceTransform.inverted().mapRect(deviceRect));
+    if (deviceClip.isEmpty()) {
+        return;
+    }
+
     painter->save();
-    painter->setClipRegion(region);
-    painter->setClipping(true);
+    renderer->setClipRegion(deviceClip);
 
     if (mask & PAINT_WINDOW_TRANSFORMED) {
         painter->translate(data.xTranslation(), data.yTranslation());
@@ -189,31 +214,17 @@ void SceneQPainter::Window::performPaint(int mask, const QRegion &_region, const
     }
 
     const bool opaque = qFuzzyCompare(1.0, data.opacity());
-    QImage tempImage;
-    QPainter tempPainter;
     if (!opaque) {
-        // need a temp render target which we later on blit to the screen
-        tempImage = QImage(boundingRect.size(), QImage::Format_ARGB32_Premultiplied);
-        tempImage.fill(Qt::transparent);
-        tempPainter.begin(&tempImage);
-        tempPainter.save();
-        tempPainter.translate(-boundingRect.topLeft());
-        painter = &tempPainter;
+        renderer->beginLayer(data.opacity());
     }
 
     renderItem(painter, windowItem());
 
     if (!opaque) {
-        tempPainter.restore();
-        tempPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-        QColor translucent(Qt::transparent);
-        translucent.setAlphaF(data.opacity());
-        tempPainter.fillRect(QRect(QPoint(0, 0), boundingRect.size()), translucent);
-        tempPainter.end();
-        painter = scenePainter;
-        painter->drawImage(boundingRect.topLeft(), tempImage);
+        renderer->endLayer();
     }
 
+    renderer->setClipRegion(QRegion());
     painter->restore();
 }
 
@@ -274,8 +285,8 @@ void SceneQPainter::Window::renderSurfaceItem(QPainter *painter, SurfaceItem *su
         const QPointF bufferTopLeft = matrix.map(rect.topLeft());
         const QPointF bufferBottomRight = matrix.map(rect.bottomRight());
 
-        painter->drawImage(rect, platformSurfaceTexture->image(),
-                           QRectF(bufferTopLeft, bufferBottomRight));
+        m_scene->m_renderer->drawImage(painter->combinedTransform(), rect, platformSurfaceTexture->image(),
+                                       QRectF(bufferTopLeft, bufferBottomRight));
     }
 }
 
@@ -291,10 +302,15 @@ void SceneQPainter::Window::renderDecorationItem(QPainter *painter, DecorationIt
         return;
     }
 
-    painter->drawImage(dtr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top));
-    painter->drawImage(dlr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left));
-    painter->drawImage(drr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right));
-    painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
+    const QTransform transform = painter->combinedTransform();
+    const auto drawPart = [&](const QRect &rect, SceneQPainterDecorationRenderer::DecorationPart part) {
+        const QImage image = renderer->image(part);
+        m_scene->m_renderer->drawImage(transform, rect, image, image.rect());
+    };
+    drawPart(dtr, SceneQPainterDecorationRenderer::DecorationPart::Top);
+    drawPart(dlr, SceneQPainterDecorationRenderer::DecorationPart::Left);
+    drawPart(drr, SceneQPainterDecorationRenderer::DecorationPart::Right);
+    drawPart(dbr, SceneQPainterDecorationRenderer::DecorationPart::Bottom);
 }
 
 DecorationRenderer *SceneQPainter::createDecorationRenderer(Decoration::DecoratedClientImpl *impl)
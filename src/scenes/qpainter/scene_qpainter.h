@@ -17,6 +17,8 @@
 
 namespace KWin {
 
+class TiledRenderer;
+
 class KWIN_EXPORT SceneQPainter : public Scene
 {
     Q_OBJECT
@@ -37,6 +39,11 @@ public:
         return false;
     }
 
+    // surface textures hold a copy of the client buffer contents
+    bool canReleaseClientBuffersEarly() const override {
+        return true;
+    }
+
     QPainter *scenePainter() const override;
     QImage *qpainterRenderBuffer(AbstractOutput *output) const override;
 
@@ -56,6 +63,7 @@ private:
     explicit SceneQPainter(QPainterBackend *backend, QObject *parent = nullptr);
     QPainterBackend *m_backend;
     QScopedPointer<QPainter> m_painter;
+    QScopedPointer<TiledRenderer> m_renderer;
     class Window;
 };
 
@@ -122,12 +130,6 @@ private:
     QImage m_images[int(DecorationPart::Count)];
 };
 
-inline
-QPainter* SceneQPainter::scenePainter() const
-{
-    return m_painter.data();
-}
-
 } // KWin
 
 #endif // KWIN_SCENEQPAINTER_H
@@ -0,0 +1,313 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "tiledrenderer.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace KWin
+{
+
+// Multiplies a color channel with a factor in the range [0, 255] and divides by 255.
+static inline uint multiplyChannel(uint channel, uint factor)
+{
+    const uint t = channel * factor + 0x80;
+    return (t + (t >> 8)) >> 8;
+}
+
+#if defined(__SSE2__)
+// Does the same as multiplyChannel() for eight 16 bit channels.
+static inline __m128i multiplyChannels(__m128i channels, __m128i factors)
+{
+    const __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, factors), _mm_set1_epi16(0x80));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+// Returns the inverted alpha of two unpacked pixels, repeated for every channel.
+static inline __m128i invertedAlpha(__m128i pixels)
+{
+    const __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    return _mm_sub_epi16(_mm_set1_epi16(0xff), alpha);
+}
+#endif
+
+/**
+ * Blends @a length premultiplied pixels from @a src over @a dst, the source pixels are
+ * multiplied with the given @a opacity in the range [0, 255] first.
+ */
+static void blendSourceOver(uint *dst, const uint *src, int length, uint opacity)
+{
+    int x = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i factor = _mm_set1_epi16(opacity);
+    for (; x + 4 <= length; x += 4) {
+        const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x));
+        const __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + x));
+
+        const __m128i sourceLo = multiplyChannels(_mm_unpacklo_epi8(source, zero), factor);
+        const __m128i sourceHi = multiplyChannels(_mm_unpackhi_epi8(source, zero), factor);
+        const __m128i destinationLo = multiplyChannels(_mm_unpacklo_epi8(destination, zero), invertedAlpha(sourceLo));
+        const __m128i destinationHi = multiplyChannels(_mm_unpackhi_epi8(destination, zero), invertedAlpha(sourceHi));
+
+        const __m128i result = _mm_packus_epi16(_mm_add_epi16(sourceLo, destinationLo),
+                                                _mm_add_epi16(sourceHi, destinationHi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), result);
+    }
+#endif
+    for (; x < length; ++x) {
+        const uint source = src[x];
+        const uint alpha = multiplyChannel(qAlpha(source), opacity);
+        const uint inverted = 0xff - alpha;
+        const uint destination = dst[x];
+        dst[x] = qRgba(multiplyChannel(qRed(source), opacity) + multiplyChannel(qRed(destination), inverted),
+                       multiplyChannel(qGreen(source), opacity) + multiplyChannel(qGreen(destination), inverted),
+                       multiplyChannel(qBlue(source), opacity) + multiplyChannel(qBlue(destination), inverted),
+                       alpha + multiplyChannel(qAlpha(destination), inverted));
+    }
+}
+
+static bool canBlendDirectly(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+void TiledRenderer::begin(QImage *buffer)
+{
+    m_buffer = buffer;
+    m_bits = nullptr;
+    m_commands.clear();
+    m_clip = QRegion();
+    m_layerIndex = -1;
+}
+
+bool TiledRenderer::isActive() const
+{
+    return m_buffer;
+}
+
+void TiledRenderer::setClipRegion(const QRegion &region)
+{
+    m_clip = region;
+}
+
+void TiledRenderer::record(Command &&command)
+{
+    command.clip = m_clip;
+    command.bounds = command.transform.mapRect(command.target).toAlignedRect();
+    if (!m_clip.isEmpty()) {
+        command.bounds &= m_clip.boundingRect();
+    }
+    if (command.bounds.isEmpty()) {
+        return;
+    }
+    if (m_layerIndex != -1) {
+        m_commands[m_layerIndex].bounds |= command.bounds;
+    }
+    m_commands.append(std::move(command));
+}
+
+void TiledRenderer::drawImage(const QTransform &transform, const QRectF &target, const QImage &image, const QRectF &source)
+{
+    if (image.isNull()) {
+        return;
+    }
+    Command command;
+    command.type = CommandType::Image;
+    command.transform = transform;
+    command.target = target;
+    command.image = image;
+    command.source = source;
+    record(std::move(command));
+}
+
+void TiledRenderer::fillRect(const QTransform &transform, const QRectF &target, const QColor &color)
+{
+    Command command;
+    command.type = CommandType::Fill;
+    command.transform = transform;
+    command.target = target;
+    command.color = color;
+    record(std::move(command));
+}
+
+void TiledRenderer::beginLayer(qreal opacity)
+{
+    Q_ASSERT(m_layerIndex == -1);
+    Command command;
+    command.type = CommandType::BeginLayer;
+    command.opacity = opacity;
+    m_layerIndex = m_commands.count();
+    m_commands.append(command);
+}
+
+void TiledRenderer::endLayer()
+{
+    Q_ASSERT(m_layerIndex != -1);
+    if (m_layerIndex == m_commands.count() - 1) {
+        // nothing has been painted in the layer
+        m_commands.removeLast();
+    } else {
+        Command command;
+        command.type = CommandType::EndLayer;
+        m_commands.append(command);
+    }
+    m_layerIndex = -1;
+}
+
+uchar *TiledRenderer::pixelAddress(int x, int y) const
+{
+    return m_bits + y * m_buffer->bytesPerLine() + x * (m_buffer->depth() / 8);
+}
+
+void TiledRenderer::flush()
+{
+    if (!m_buffer || m_commands.isEmpty()) {
+        return;
+    }
+    Q_ASSERT(m_layerIndex == -1);
+
+    // Detach the buffer here so the tiles can write to it without any synchronization.
+    m_bits = m_buffer->bits();
+
+    const QRect bufferRect = m_buffer->rect();
+    const int columns = (bufferRect.width() + tileSize - 1) / tileSize;
+    const int rows = (bufferRect.height() + tileSize - 1) / tileSize;
+    QVector<bool> touched(columns * rows, false);
+    for (const Command &command : qAsConst(m_commands)) {
+        const QRect bounds = command.bounds & bufferRect;
+        if (bounds.isEmpty()) {
+            continue;
+        }
+        for (int row = bounds.top() / tileSize; row <= bounds.bottom() / tileSize; ++row) {
+            for (int column = bounds.left() / tileSize; column <= bounds.right() / tileSize; ++column) {
+                touched[row * columns + column] = true;
+            }
+        }
+    }
+
+    QVector<QRect> tiles;
+    for (int row = 0; row < rows; ++row) {
+        for (int column = 0; column < columns; ++column) {
+            if (touched[row * columns + column]) {
+                tiles.append(QRect(column * tileSize, row * tileSize, tileSize, tileSize) & bufferRect);
+            }
+        }
+    }
+
+    if (tiles.count() == 1) {
+        renderTile(tiles.constFirst());
+    } else {
+        QtConcurrent::blockingMap(tiles, [this](const QRect &tileRect) {
+            renderTile(tileRect);
+        });
+    }
+
+    // Drop the references to the images, so that the textures can be updated in place.
+    m_commands.clear();
+}
+
+void TiledRenderer::renderTile(const QRect &tileRect) const
+{
+    const QImage::Format format = m_buffer->format();
+    QImage tile(pixelAddress(tileRect.x(), tileRect.y()), tileRect.width(), tileRect.height(),
+                m_buffer->bytesPerLine(), format);
+    QPainter tilePainter(&tile);
+
+    // The layer is reused for all tiles painted by the current thread.
+    static thread_local QImage layer;
+    QPainter layerPainter;
+    QRect layerRect;
+    qreal layerOpacity = 1.0;
+    bool skipLayer = false;
+
+    QPainter *painter = &tilePainter;
+    for (const Command &command : m_commands) {
+        switch (command.type) {
+        case CommandType::BeginLayer:
+            layerRect = command.bounds & tileRect;
+            skipLayer = layerRect.isEmpty();
+            if (!skipLayer) {
+                if (layer.width() < tileSize || layer.height() < tileSize) {
+                    layer = QImage(tileSize, tileSize, QImage::Format_ARGB32_Premultiplied);
+                }
+                layerOpacity = command.opacity;
+                layerPainter.begin(&layer);
+                layerPainter.setCompositionMode(QPainter::CompositionMode_Source);
+                layerPainter.fillRect(layerRect.translated(-tileRect.topLeft()), Qt::transparent);
+                layerPainter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+                painter = &layerPainter;
+            }
+            break;
+        case CommandType::EndLayer:
+            if (!skipLayer) {
+                layerPainter.end();
+                painter = &tilePainter;
+                if (canBlendDirectly(format)) {
+                    blendLayer(layer, layerRect, tileRect, layerOpacity);
+                } else {
+                    tilePainter.resetTransform();
+                    tilePainter.setClipping(false);
+                    tilePainter.setOpacity(layerOpacity);
+                    const QRect source = layerRect.translated(-tileRect.topLeft());
+                    tilePainter.drawImage(source.topLeft(), layer, source);
+                    tilePainter.setOpacity(1.0);
+                }
+            }
+            skipLayer = false;
+            break;
+        default:
+            if (!skipLayer && command.bounds.intersects(tileRect)) {
+                renderCommand(painter, command, tileRect);
+            }
+            break;
+        }
+    }
+}
+
+void TiledRenderer::renderCommand(QPainter *painter, const Command &command, const QRect &tileRect) const
+{
+    const QRegion clip = command.clip.isEmpty() ? QRegion(tileRect) : command.clip & tileRect;
+    if (clip.isEmpty()) {
+        return;
+    }
+
+    painter->resetTransform();
+    painter->setClipRegion(clip.translated(-tileRect.topLeft()));
+    painter->setTransform(command.transform * QTransform::fromTranslate(-tileRect.x(), -tileRect.y()));
+
+    switch (command.type) {
+    case CommandType::Image:
+        painter->drawImage(command.target, command.image, command.source);
+        break;
+    case CommandType::Fill:
+        painter->fillRect(command.target, command.color);
+        break;
+    default:
+        Q_UNREACHABLE();
+    }
+}
+
+void TiledRenderer::blendLayer(const QImage &layer, const QRect &rect, const QRect &tileRect, qreal opacity) const
+{
+    const uint alpha = qBound(0, qRound(opacity * 255), 255);
+    const int x = rect.x() - tileRect.x();
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        const uint *src = reinterpret_cast<const uint *>(layer.constScanLine(y - tileRect.y())) + x;
+        uint *dst = reinterpret_cast<uint *>(pixelAddress(rect.x(), y));
+        blendSourceOver(dst, src, rect.width(), alpha);
+    }
+}
+
+} // namespace KWin
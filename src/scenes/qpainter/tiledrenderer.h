@@ -0,0 +1,101 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QColor>
+#include <QImage>
+#include <QRegion>
+#include <QTransform>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * The TiledRenderer class composites a frame for the QPainter scene in tiles.
+ *
+ * The scene doesn't paint windows right away. Instead, the draw operations are recorded
+ * together with the device transform and the clip region at the time they were issued.
+ * When the frame is flushed, the area touched by the recorded operations is split into
+ * tiles and the tiles are painted in parallel on the global thread pool. Every tile is
+ * painted with its own QPainter, so the output is the same as if the operations were
+ * executed by a single QPainter.
+ *
+ * Translucent windows are painted into a layer. The layer is only as big as a tile and
+ * is blended into the tile with the window opacity, no window sized temporary image is
+ * needed.
+ */
+class TiledRenderer
+{
+public:
+    /**
+     * Starts recording a frame that will be painted into the @a buffer.
+     */
+    void begin(QImage *buffer);
+    /**
+     * Paints all recorded operations and clears the list of operations. This must be
+     * called before anything else paints into or reads from the buffer.
+     */
+    void flush();
+    bool isActive() const;
+
+    /**
+     * Sets the clip region in device coordinates for the following operations. An empty
+     * region disables clipping.
+     */
+    void setClipRegion(const QRegion &region);
+
+    void drawImage(const QTransform &transform, const QRectF &target, const QImage &image, const QRectF &source);
+    void fillRect(const QTransform &transform, const QRectF &target, const QColor &color);
+
+    /**
+     * All operations between beginLayer() and endLayer() are painted with the given
+     * @a opacity as a whole. Layers cannot be nested.
+     */
+    void beginLayer(qreal opacity);
+    void endLayer();
+
+    static constexpr int tileSize = 128;
+
+private:
+    enum class CommandType {
+        Image,
+        Fill,
+        BeginLayer,
+        EndLayer,
+    };
+
+    struct Command
+    {
+        CommandType type;
+        QTransform transform;
+        QRegion clip;
+        QRect bounds;
+        QRectF target;
+        QImage image;
+        QRectF source;
+        QColor color;
+        qreal opacity = 1.0;
+    };
+
+    void record(Command &&command);
+    void renderTile(const QRect &tileRect) const;
+    void renderCommand(QPainter *painter, const Command &command, const QRect &tileRect) const;
+    void blendLayer(const QImage &layer, const QRect &rect, const QRect &tileRect, qreal opacity) const;
+    uchar *pixelAddress(int x, int y) const;
+
+    QImage *m_buffer = nullptr;
+    uchar *m_bits = nullptr;
+    QVector<Command> m_commands;
+    QRegion m_clip;
+    int m_layerIndex = -1;
+};
+
+} // namespace KWin
@@ -24,6 +24,7 @@
 #include "v3/virtualdesktopmodel.h"
 
 #include "input.h"
+#include "utils/startupphase.h"
 #include "options.h"
 #include "screenedge.h"
 #include "virtualdesktops.h"
@@ -37,6 +38,7 @@
 #include <QDBusConnection>
 #include <QDBusPendingCallWatcher>
 #include <QDebug>
+#include <QFile>
 #include <QFutureWatcher>
 #include <QSettings>
 #include <QtConcurrentRun>
@@ -700,6 +702,59 @@ void KWin::Scripting::start()
 #endif
 }
 
+static QList<KPluginMetaData> findAllScripts()
+{
+    const QString scriptFolder = QStringLiteral(KWIN_NAME "/scripts/");
+    return KPackage::PackageLoader::self()->listPackages(QStringLiteral("KWin/Script"), scriptFolder);
+}
+
+static QString locateMainScript(const KPluginMetaData &service)
+{
+    const QString scriptFolder = QStringLiteral(KWIN_NAME "/scripts/");
+    const QString scriptName = service.value(QStringLiteral("X-Plasma-MainScript"));
+    return QStandardPaths::locate(QStandardPaths::GenericDataLocation, scriptFolder + service.pluginId() + QLatin1String("/contents/") + scriptName);
+}
+
+/**
+ * Scripts that have been looked up ahead of time by prefetchScripts().
+ */
+struct PrefetchedScripts
+{
+    QList<KPluginMetaData> offers;
+    // the main script file of every package, by plugin id
+    QFuture<QHash<QString, QString>> mainScripts;
+};
+
+static PrefetchedScripts *s_prefetchedScripts = nullptr;
+
+void KWin::Scripting::prefetchScripts()
+{
+    if (s_prefetchedScripts) {
+        return;
+    }
+    // KPackage is not thread safe, so the packages are listed here and only the file system
+    // lookups and reads happen in the worker thread.
+    const QList<KPluginMetaData> offers = findAllScripts();
+    s_prefetchedScripts = new PrefetchedScripts{offers, QFuture<QHash<QString, QString>>()};
+    s_prefetchedScripts->mainScripts = QtConcurrent::run([offers]() {
+        StartupPhase phase(QStringLiteral("script discovery"));
+        QHash<QString, QString> mainScripts;
+        for (const KPluginMetaData &service : offers) {
+            const QString file = locateMainScript(service);
+            if (file.isNull()) {
+                continue;
+            }
+            // Read the file once, so it's in the page cache when the script gets loaded.
+            QFile script(file);
+            if (script.open(QIODevice::ReadOnly)) {
+                script.readAll();
+            }
+            mainScripts.insert(service.pluginId(), file);
+        }
+        return mainScripts;
+    });
+}
+
 LoadScriptList KWin::Scripting::queryScriptsToLoad()
 {
     KSharedConfig::Ptr _config = kwinApp()->config();
@@ -710,8 +765,18 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
         s_started = true;
     }
     QMap<QString,QString> pluginStates = KConfigGroup(_config, "Plugins").entryMap();
-    const QString scriptFolder = QStringLiteral(KWIN_NAME "/scripts/");
-    const auto offers = KPackage::PackageLoader::self()->listPackages(QStringLiteral("KWin/Script"), scriptFolder);
+    QList<KPluginMetaData> offers;
+    QHash<QString, QString> mainScripts;
+    const bool prefetched = s_prefetchedScripts;
+    if (prefetched) {
+        offers = s_prefetchedScripts->offers;
+        mainScripts = s_prefetchedScripts->mainScripts.result();
+        // The prefetched scripts are only good for the first query, they may be stale afterwards.
+        delete s_prefetchedScripts;
+        s_prefetchedScripts = nullptr;
+    } else {
+        offers = findAllScripts();
+    }
 
     LoadScriptList scriptsToLoad;
 
@@ -732,8 +797,7 @@ LoadScriptList KWin::Scripting::queryScriptsToLoad()
             continue;
         }
         const QString pluginName = service.pluginId();
-        const QString scriptName = service.value(QStringLiteral("X-Plasma-MainScript"));
-        const QString file = QStandardPaths::locate(QStandardPaths::GenericDataLocation, scriptFolder + pluginName + QLatin1String("/contents/") + scriptName);
+        const QString file = prefetched ? mainScripts.value(pluginName) : locateMainScript(service);
         if (file.isNull()) {
             qCDebug(KWIN_SCRIPTING) << "Could not find script file for " << pluginName;
             continue;
@@ -347,6 +347,12 @@ public:
     static Scripting *self();
     static Scripting *create(QObject *parent);
 
+    /**
+     * Lists the installed scripts and starts looking up and reading their main script files
+     * in a worker thread. The first call to start() picks up the result.
+     */
+    static void prefetchScripts();
+
 public Q_SLOTS:
     void scriptDestroyed(QObject *object);
     Q_SCRIPTABLE void start();
@@ -58,12 +58,12 @@ void SurfaceItem::addDamage(const QRegion &region)
 
 void SurfaceItem::resetDamage()
 {
-    m_damage = QRegion();
+    m_damage.clear();
 }
 
 QRegion SurfaceItem::damage() const
 {
-    return m_damage;
+    return m_damage.toRegion();
 }
 
 SurfacePixmap *SurfaceItem::pixmap() const
@@ -54,7 +54,7 @@ protected:
     void handleWindowClosed(Toplevel *original, Deleted *deleted);
 
     Toplevel *m_window;
-    QRegion m_damage;
+    DamageRegion m_damage;
     QScopedPointer<SurfacePixmap> m_pixmap;
     QScopedPointer<SurfacePixmap> m_previousPixmap;
     QMatrix4x4 m_surfaceToBufferMatrix;
@@ -89,6 +89,16 @@ void SurfaceItemWayland::handleSurfaceCommitted()
     if (m_surface->hasFrameCallbacks()) {
         scheduleFrame();
     }
+
+    // The previous buffer is not going to be painted anymore, so give it back to the client
+    // now rather than when the next frame is prepared. The client can then reuse it for the
+    // next frame instead of having to allocate an extra buffer.
+    if (m_pixmap && m_pixmap->isValid() && m_surface->buffer()) {
+        Scene *scene = Compositor::self()->scene();
+        if (scene && scene->canReleaseClientBuffersEarly()) {
+            m_pixmap->update();
+        }
+    }
 }
 
 SurfaceItemWayland *SurfaceItemWayland::getOrCreateSubSurfaceItem(KWaylandServer::SubSurfaceInterface *child)
@@ -104,23 +114,63 @@ SurfaceItemWayland *SurfaceItemWayland::getOrCreateSubSurfaceItem(KWaylandServer
 
 void SurfaceItemWayland::handleChildSubSurfaceRemoved(KWaylandServer::SubSurfaceInterface *child)
 {
+    // A new subsurface may reuse the address, it must not be mistaken for the old one. Only the
+    // cached entries whose z doesn't depend on the removed subsurface stay valid, the others
+    // have to be re-stacked with the next change.
+    const int belowIndex = m_below.indexOf(child);
+    if (belowIndex != -1) {
+        m_below = m_below.mid(belowIndex + 1);
+    }
+    const int aboveIndex = m_above.indexOf(child);
+    if (aboveIndex != -1) {
+        m_above = m_above.mid(0, aboveIndex);
+    }
     delete m_subsurfaces.take(child);
 }
 
+template<typename T>
+static int commonPrefixLength(const QList<T> &a, const QList<T> &b)
+{
+    const int count = std::min(a.count(), b.count());
+    int i = 0;
+    while (i < count && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+template<typename T>
+static int commonSuffixLength(const QList<T> &a, const QList<T> &b)
+{
+    const int count = std::min(a.count(), b.count());
+    int i = 0;
+    while (i < count && a[a.count() - i - 1] == b[b.count() - i - 1]) {
+        ++i;
+    }
+    return i;
+}
+
 void SurfaceItemWayland::handleChildSubSurfacesChanged()
 {
     const QList<KWaylandServer::SubSurfaceInterface *> below = m_surface->below();
     const QList<KWaylandServer::SubSurfaceInterface *> above = m_surface->above();
 
-    for (int i = 0; i < below.count(); ++i) {
+    // The z of a subsurface below is its distance from the parent, so the subsurfaces closest
+    // to the parent that haven't changed keep their z. Likewise, the z of a subsurface above is
+    // its index, so only the subsurfaces after the first change need to be updated.
+    const int belowUnchanged = commonSuffixLength(below, m_below);
+    for (int i = 0; i < below.count() - belowUnchanged; ++i) {
         SurfaceItemWayland *subsurfaceItem = getOrCreateSubSurfaceItem(below[i]);
         subsurfaceItem->setZ(i - below.count());
     }
 
-    for (int i = 0; i < above.count(); ++i) {
+    for (int i = commonPrefixLength(above, m_above); i < above.count(); ++i) {
         SurfaceItemWayland *subsurfaceItem = getOrCreateSubSurfaceItem(above[i]);
         subsurfaceItem->setZ(i);
     }
+
+    m_below = below;
+    m_above = above;
 }
 
 void SurfaceItemWayland::handleSubSurfacePositionChanged()
@@ -188,11 +238,18 @@ void SurfacePixmapWayland::setBuffer(KWaylandServer::ClientBuffer *buffer)
         return;
     }
     if (m_buffer) {
-        m_buffer->unref();
+        Scene *scene = Compositor::self() ? Compositor::self()->scene() : nullptr;
+        if (scene) {
+            // the GPU may still be reading the buffer
+            scene->releaseClientBuffer(m_buffer, m_attachTime);
+        } else {
+            m_buffer->unref();
+        }
     }
     m_buffer = buffer;
     if (m_buffer) {
         m_buffer->ref();
+        m_attachTime = std::chrono::steady_clock::now().time_since_epoch();
         m_hasAlphaChannel = m_buffer->hasAlphaChannel();
     }
 }
@@ -8,6 +8,8 @@
 
 #include "surfaceitem.h"
 
+#include <chrono>
+
 namespace KWaylandServer
 {
 class ClientBuffer;
@@ -52,6 +54,9 @@ private:
 
     QPointer<KWaylandServer::SurfaceInterface> m_surface;
     QHash<KWaylandServer::SubSurfaceInterface *, SurfaceItemWayland *> m_subsurfaces;
+    // the subsurface stacking order the child items were last updated for
+    QList<KWaylandServer::SubSurfaceInterface *> m_below;
+    QList<KWaylandServer::SubSurfaceInterface *> m_above;
 };
 
 class KWIN_EXPORT SurfacePixmapWayland final : public SurfacePixmap
@@ -75,6 +80,7 @@ private:
 
     SurfaceItemWayland *m_item;
     KWaylandServer::ClientBuffer *m_buffer = nullptr;
+    std::chrono::nanoseconds m_attachTime = std::chrono::nanoseconds::zero();
 };
 
 /**
@@ -20,9 +20,11 @@ SurfaceItemX11::SurfaceItemX11(Toplevel *window, Item *parent)
     connect(window, &Toplevel::geometryShapeChanged,
             this, &SurfaceItemX11::discardQuads);
 
+    // The bounding box report level provides the damaged area with the events, so the
+    // damage region doesn't have to be fetched, which would require a round-trip.
     m_damageHandle = xcb_generate_id(kwinApp()->x11Connection());
     xcb_damage_create(kwinApp()->x11Connection(), m_damageHandle, window->frameId(),
-                      XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+                      XCB_DAMAGE_REPORT_LEVEL_BOUNDING_BOX);
 
     setSize(window->bufferGeometry().size());
 }
@@ -43,8 +45,9 @@ void SurfaceItemX11::preprocess()
     SurfaceItem::preprocess();
 }
 
-void SurfaceItemX11::processDamage()
+void SurfaceItemX11::processDamage(const QRect &area)
 {
+    m_pendingDamage += area;
     m_isDamaged = true;
     scheduleFrame();
 }
@@ -57,56 +60,21 @@ bool SurfaceItemX11::fetchDamage()
     m_isDamaged = false;
 
     if (m_damageHandle == XCB_NONE) {
+        m_pendingDamage = QRegion();
         return true;
     }
 
-    xcb_xfixes_region_t region = xcb_generate_id(kwinApp()->x11Connection());
-    xcb_xfixes_create_region(kwinApp()->x11Connection(), region, 0, nullptr);
-    xcb_damage_subtract(kwinApp()->x11Connection(), m_damageHandle, 0, region);
+    // Reset the damage object so that further damage generates new events. If the window
+    // is damaged before the server processes this request, the events have been sent
+    // already and the damage will be picked up in the next frame.
+    xcb_damage_subtract(kwinApp()->x11Connection(), m_damageHandle, XCB_NONE, XCB_NONE);
 
-    m_damageCookie = xcb_xfixes_fetch_region_unchecked(kwinApp()->x11Connection(), region);
-    xcb_xfixes_destroy_region(kwinApp()->x11Connection(), region);
-
-    m_havePendingDamageRegion = true;
+    addDamage(m_pendingDamage);
+    m_pendingDamage = QRegion();
 
     return true;
 }
 
-void SurfaceItemX11::waitForDamage()
-{
-    if (!m_havePendingDamageRegion) {
-        return;
-    }
-    m_havePendingDamageRegion = false;
-
-    xcb_xfixes_fetch_region_reply_t *reply =
-            xcb_xfixes_fetch_region_reply(kwinApp()->x11Connection(), m_damageCookie, nullptr);
-    if (!reply) {
-        qCDebug(KWIN_CORE) << "Failed to check damage region";
-        return;
-    }
-
-    const int rectCount = xcb_xfixes_fetch_region_rectangles_length(reply);
-    QRegion region;
-
-    if (rectCount > 1 && rectCount < 16) {
-        xcb_rectangle_t *rects = xcb_xfixes_fetch_region_rectangles(reply);
-
-        QVector<QRect> qtRects;
-        qtRects.reserve(rectCount);
-
-        for (int i = 0; i < rectCount; ++i) {
-            qtRects << QRect(rects[i].x, rects[i].y, rects[i].width, rects[i].height);
-        }
-        region.setRects(qtRects.constData(), rectCount);
-    } else {
-        region = QRect(reply->extents.x, reply->extents.y, reply->extents.width, reply->extents.height);
-    }
-    free(reply);
-
-    addDamage(region);
-}
-
 void SurfaceItemX11::destroyDamage()
 {
     if (m_damageHandle != XCB_NONE) {
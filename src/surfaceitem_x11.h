@@ -9,7 +9,6 @@
 #include "surfaceitem.h"
 
 #include <xcb/damage.h>
-#include <xcb/xfixes.h>
 
 namespace KWin
 {
@@ -27,9 +26,16 @@ public:
 
     void preprocess() override;
 
-    void processDamage();
+    /**
+     * Accumulates the @a area reported by a DamageNotify event. The area is in the
+     * coordinates of the frame window.
+     */
+    void processDamage(const QRect &area);
+    /**
+     * Moves the accumulated damage to the item and resets the damage object. Returns
+     * @c true if the item has been damaged since the last call.
+     */
     bool fetchDamage();
-    void waitForDamage();
     void destroyDamage();
 
     QRegion shape() const override;
@@ -43,9 +49,8 @@ protected:
 
 private:
     xcb_damage_damage_t m_damageHandle = XCB_NONE;
-    xcb_xfixes_fetch_region_cookie_t m_damageCookie;
+    QRegion m_pendingDamage;
     bool m_isDamaged = false;
-    bool m_havePendingDamageRegion = false;
 };
 
 class KWIN_EXPORT SurfacePixmapX11 final : public SurfacePixmap
@@ -80,8 +80,8 @@ void TabletInputRedirection::tabletToolEvent(KWin::InputRedirection::TabletEvent
                     Qt::NoModifier, tabletToolId.m_uniqueId, button, button, tabletToolId);
 
     ev.setTimestamp(time);
-    input()->processSpies(std::bind(&InputEventSpy::tabletToolEvent, std::placeholders::_1, &ev));
-    input()->processFilters(
+    input()->processSpies(TabletToolInputEvent, std::bind(&InputEventSpy::tabletToolEvent, std::placeholders::_1, &ev));
+    input()->processFilters(TabletToolInputEvent,
         std::bind(&InputEventFilter::tabletToolEvent, std::placeholders::_1, &ev));
 
     m_tipDown = tipDown;
@@ -91,9 +91,9 @@ void TabletInputRedirection::tabletToolEvent(KWin::InputRedirection::TabletEvent
 void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPressed,
                                                          const TabletToolId &tabletToolId)
 {
-    input()->processSpies(std::bind(&InputEventSpy::tabletToolButtonEvent,
+    input()->processSpies(TabletToolInputEvent, std::bind(&InputEventSpy::tabletToolButtonEvent,
                                     std::placeholders::_1, button, isPressed, tabletToolId));
-    input()->processFilters(std::bind( &InputEventFilter::tabletToolButtonEvent,
+    input()->processFilters(TabletToolInputEvent, std::bind( &InputEventFilter::tabletToolButtonEvent,
                                       std::placeholders::_1, button, isPressed, tabletToolId));
     input()->setLastInputHandler(this);
 }
@@ -101,9 +101,9 @@ void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPre
 void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPressed,
                                                         const TabletPadId &tabletPadId)
 {
-    input()->processSpies(std::bind( &InputEventSpy::tabletPadButtonEvent,
+    input()->processSpies(TabletPadInputEvent, std::bind( &InputEventSpy::tabletPadButtonEvent,
                                      std::placeholders::_1, button, isPressed, tabletPadId));
-    input()->processFilters(std::bind( &InputEventFilter::tabletPadButtonEvent,
+    input()->processFilters(TabletPadInputEvent, std::bind( &InputEventFilter::tabletPadButtonEvent,
                                        std::placeholders::_1, button, isPressed, tabletPadId));
     input()->setLastInputHandler(this);
 }
@@ -111,9 +111,9 @@ void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPres
 void KWin::TabletInputRedirection::tabletPadStripEvent(int number, int position, bool isFinger,
                                                        const TabletPadId &tabletPadId)
 {
-    input()->processSpies(std::bind( &InputEventSpy::tabletPadStripEvent,
+    input()->processSpies(TabletPadInputEvent, std::bind( &InputEventSpy::tabletPadStripEvent,
                                      std::placeholders::_1, number, position, isFinger, tabletPadId));
-    input()->processFilters(std::bind( &InputEventFilter::tabletPadStripEvent,
+    input()->processFilters(TabletPadInputEvent, std::bind( &InputEventFilter::tabletPadStripEvent,
                                        std::placeholders::_1, number, position, isFinger, tabletPadId));
     input()->setLastInputHandler(this);
 }
@@ -121,9 +121,9 @@ void KWin::TabletInputRedirection::tabletPadStripEvent(int number, int position,
 void KWin::TabletInputRedirection::tabletPadRingEvent(int number, int position, bool isFinger,
                                                       const TabletPadId &tabletPadId)
 {
-    input()->processSpies(std::bind( &InputEventSpy::tabletPadRingEvent,
+    input()->processSpies(TabletPadInputEvent, std::bind( &InputEventSpy::tabletPadRingEvent,
                                      std::placeholders::_1, number, position, isFinger, tabletPadId));
-    input()->processFilters(std::bind( &InputEventFilter::tabletPadRingEvent,
+    input()->processFilters(TabletPadInputEvent, std::bind( &InputEventFilter::tabletPadRingEvent,
                                        std::placeholders::_1, number, position, isFinger, tabletPadId));
     input()->setLastInputHandler(this);
 }
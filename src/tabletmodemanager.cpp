@@ -27,6 +27,11 @@ public:
     {
     }
 
+    InputEventTypes eventTypes() const override
+    {
+        return SwitchInputEvent;
+    }
+
     void switchEvent(SwitchEvent *event) override
     {
         if (!event->device()->isTabletModeSwitch()) {
@@ -139,8 +139,8 @@ void TouchInputRedirection::processDown(qint32 id, const QPointF &pos, quint32 t
         update();
     }
     input()->setLastInputHandler(this);
-    input()->processSpies(std::bind(&InputEventSpy::touchDown, std::placeholders::_1, id, pos, time));
-    input()->processFilters(std::bind(&InputEventFilter::touchDown, std::placeholders::_1, id, pos, time));
+    input()->processSpies(TouchInputEvent, std::bind(&InputEventSpy::touchDown, std::placeholders::_1, id, pos, time));
+    input()->processFilters(TouchInputEvent, std::bind(&InputEventFilter::touchDown, std::placeholders::_1, id, pos, time));
     m_windowUpdatedInCycle = false;
 }
 
@@ -155,8 +155,8 @@ void TouchInputRedirection::processUp(qint32 id, quint32 time, InputDevice *devi
     }
     input()->setLastInputHandler(this);
     m_windowUpdatedInCycle = false;
-    input()->processSpies(std::bind(&InputEventSpy::touchUp, std::placeholders::_1, id, time));
-    input()->processFilters(std::bind(&InputEventFilter::touchUp, std::placeholders::_1, id, time));
+    input()->processSpies(TouchInputEvent, std::bind(&InputEventSpy::touchUp, std::placeholders::_1, id, time));
+    input()->processFilters(TouchInputEvent, std::bind(&InputEventFilter::touchUp, std::placeholders::_1, id, time));
     m_windowUpdatedInCycle = false;
     if (m_activeTouchPoints.count() == 0) {
         update();
@@ -175,8 +175,8 @@ void TouchInputRedirection::processMotion(qint32 id, const QPointF &pos, quint32
     input()->setLastInputHandler(this);
     m_lastPosition = pos;
     m_windowUpdatedInCycle = false;
-    input()->processSpies(std::bind(&InputEventSpy::touchMotion, std::placeholders::_1, id, pos, time));
-    input()->processFilters(std::bind(&InputEventFilter::touchMotion, std::placeholders::_1, id, pos, time));
+    input()->processSpies(TouchInputEvent, std::bind(&InputEventSpy::touchMotion, std::placeholders::_1, id, pos, time));
+    input()->processFilters(TouchInputEvent, std::bind(&InputEventFilter::touchMotion, std::placeholders::_1, id, pos, time));
     m_windowUpdatedInCycle = false;
 }
 
@@ -206,12 +206,12 @@ QWindow *Unmanaged::findInternalWindow() const
     return nullptr;
 }
 
-void Unmanaged::damageNotifyEvent()
+void Unmanaged::damageNotifyEvent(xcb_damage_notify_event_t *e)
 {
     Q_ASSERT(kwinApp()->operationMode() == Application::OperationModeX11);
     SurfaceItemX11 *item = static_cast<SurfaceItemX11 *>(surfaceItem());
     if (item) {
-        item->processDamage();
+        item->processDamage(QRect(e->area.x, e->area.y, e->area.width, e->area.height));
     }
 }
 
@@ -14,6 +14,8 @@
 
 #include "toplevel.h"
 
+#include <xcb/damage.h>
+
 namespace KWin
 {
 
@@ -43,7 +45,7 @@ private:
     ~Unmanaged() override; // use release()
     // handlers for X11 events
     void configureNotifyEvent(xcb_configure_notify_event_t *e);
-    void damageNotifyEvent();
+    void damageNotifyEvent(xcb_damage_notify_event_t *e);
     QWindow *findInternalWindow() const;
     void associate();
     void initialize();
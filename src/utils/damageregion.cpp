@@ -0,0 +1,299 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "damageregion.h"
+
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace KWin
+{
+
+int DamageRegion::defaultMaxRectCount()
+{
+    static const int count = [] {
+        bool ok = false;
+        const int count = qEnvironmentVariableIntValue("KWIN_DAMAGE_MAX_RECTS", &ok);
+        return ok && count > 0 ? count : 16;
+    }();
+    return count;
+}
+
+DamageRegion::DamageRegion()
+    : m_maxRectCount(defaultMaxRectCount())
+{
+}
+
+DamageRegion::DamageRegion(int maxRectCount)
+    : m_maxRectCount(std::max(1, maxRectCount))
+{
+}
+
+DamageRegion::DamageRegion(const QRect &rect)
+    : DamageRegion()
+{
+    add(rect);
+}
+
+DamageRegion::DamageRegion(const QRegion &region)
+    : DamageRegion()
+{
+    add(region);
+}
+
+DamageRegion::Box DamageRegion::toBox(const QRect &rect)
+{
+    return Box{rect.x(), rect.y(), rect.x() + rect.width(), rect.y() + rect.height()};
+}
+
+QRect DamageRegion::toRect(const Box &box)
+{
+    return QRect(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1);
+}
+
+static inline bool isBoxEmpty(int x1, int y1, int x2, int y2)
+{
+    return x1 >= x2 || y1 >= y2;
+}
+
+static inline qint64 boxArea(int x1, int y1, int x2, int y2)
+{
+    return qint64(x2 - x1) * qint64(y2 - y1);
+}
+
+/**
+ * Returns @c true if the @a outer box contains the @a inner box. Both pointers point to
+ * four ints, x1, y1, x2, y2, in that order.
+ */
+static inline bool boxContains(const int *outer, const int *inner)
+{
+#if defined(__SSE2__)
+    // Compare (outer.x1, outer.y1, inner.x2, inner.y2) <= (inner.x1, inner.y1, outer.x2, outer.y2)
+    // in one go.
+    const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i *>(outer));
+    const __m128i i = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inner));
+    const __m128i lhs = _mm_unpacklo_epi64(o, _mm_srli_si128(i, 8));
+    const __m128i rhs = _mm_unpacklo_epi64(i, _mm_srli_si128(o, 8));
+    return _mm_movemask_epi8(_mm_cmpgt_epi32(lhs, rhs)) == 0;
+#else
+    return outer[0] <= inner[0] && outer[1] <= inner[1] && inner[2] <= outer[2] && inner[3] <= outer[3];
+#endif
+}
+
+bool DamageRegion::isEmpty() const
+{
+    return m_boxes.isEmpty();
+}
+
+int DamageRegion::rectCount() const
+{
+    return m_boxes.count();
+}
+
+QRect DamageRegion::boundingRect() const
+{
+    if (m_boxes.isEmpty()) {
+        return QRect();
+    }
+    return toRect(m_bounds);
+}
+
+QVector<QRect> DamageRegion::rects() const
+{
+    QVector<QRect> rects;
+    rects.reserve(m_boxes.count());
+    for (const Box &box : m_boxes) {
+        rects.append(toRect(box));
+    }
+    return rects;
+}
+
+int DamageRegion::maxRectCount() const
+{
+    return m_maxRectCount;
+}
+
+void DamageRegion::setMaxRectCount(int count)
+{
+    m_maxRectCount = std::max(1, count);
+    if (m_boxes.count() > m_maxRectCount) {
+        simplify();
+    }
+}
+
+void DamageRegion::add(const QRect &rect)
+{
+    insert(toBox(rect));
+}
+
+void DamageRegion::add(const QRegion &region)
+{
+    for (const QRect &rect : region) {
+        insert(toBox(rect));
+    }
+}
+
+void DamageRegion::add(const DamageRegion &other)
+{
+    for (const Box &box : other.m_boxes) {
+        insert(box);
+    }
+}
+
+void DamageRegion::clear()
+{
+    m_boxes.clear();
+    m_bounds = Box{0, 0, 0, 0};
+}
+
+void DamageRegion::insert(const Box &input)
+{
+    Box box = input;
+    if (isBoxEmpty(box.x1, box.y1, box.x2, box.y2)) {
+        return;
+    }
+
+    for (int i = 0; i < m_boxes.count();) {
+        const Box &existing = m_boxes[i];
+        if (boxContains(&existing.x1, &box.x1)) {
+            return;
+        }
+        if (boxContains(&box.x1, &existing.x1)) {
+            m_boxes.remove(i);
+            continue;
+        }
+
+        // Two boxes that share a full edge and touch or overlap form a box without any waste.
+        const bool sameColumn = existing.x1 == box.x1 && existing.x2 == box.x2
+            && existing.y1 <= box.y2 && box.y1 <= existing.y2;
+        const bool sameRow = existing.y1 == box.y1 && existing.y2 == box.y2
+            && existing.x1 <= box.x2 && box.x1 <= existing.x2;
+        if (sameColumn || sameRow) {
+            box = Box{std::min(box.x1, existing.x1), std::min(box.y1, existing.y1),
+                      std::max(box.x2, existing.x2), std::max(box.y2, existing.y2)};
+            m_boxes.remove(i);
+            // the merged box may contain or touch boxes that have been checked already
+            i = 0;
+            continue;
+        }
+        ++i;
+    }
+
+    if (m_boxes.isEmpty()) {
+        m_bounds = box;
+    } else {
+        m_bounds = Box{std::min(m_bounds.x1, box.x1), std::min(m_bounds.y1, box.y1),
+                       std::max(m_bounds.x2, box.x2), std::max(m_bounds.y2, box.y2)};
+    }
+    m_boxes.append(box);
+
+    if (m_boxes.count() > m_maxRectCount) {
+        simplify();
+    }
+}
+
+void DamageRegion::simplify()
+{
+    while (m_boxes.count() > m_maxRectCount) {
+        int bestFirst = 0;
+        int bestSecond = 1;
+        qint64 bestWaste = std::numeric_limits<qint64>::max();
+
+        for (int i = 0; i < m_boxes.count(); ++i) {
+            const Box &a = m_boxes[i];
+            const qint64 areaA = boxArea(a.x1, a.y1, a.x2, a.y2);
+            for (int j = i + 1; j < m_boxes.count(); ++j) {
+                const Box &b = m_boxes[j];
+                const qint64 waste = boxArea(std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+                                             std::max(a.x2, b.x2), std::max(a.y2, b.y2))
+                    - areaA - boxArea(b.x1, b.y1, b.x2, b.y2);
+                if (waste < bestWaste) {
+                    bestWaste = waste;
+                    bestFirst = i;
+                    bestSecond = j;
+                }
+            }
+        }
+
+        const Box a = m_boxes[bestFirst];
+        const Box b = m_boxes[bestSecond];
+        const Box merged{std::min(a.x1, b.x1), std::min(a.y1, b.y1),
+                         std::max(a.x2, b.x2), std::max(a.y2, b.y2)};
+
+        // the merged box may swallow other boxes as well
+        for (int i = m_boxes.count() - 1; i >= 0; --i) {
+            if (boxContains(&merged.x1, &m_boxes[i].x1)) {
+                m_boxes.remove(i);
+            }
+        }
+        m_boxes.append(merged);
+    }
+}
+
+DamageRegion DamageRegion::intersected(const QRect &rect) const
+{
+    DamageRegion result(m_maxRectCount);
+    const Box clip = toBox(rect);
+    for (const Box &box : m_boxes) {
+        result.insert(Box{std::max(box.x1, clip.x1), std::max(box.y1, clip.y1),
+                          std::min(box.x2, clip.x2), std::min(box.y2, clip.y2)});
+    }
+    return result;
+}
+
+DamageRegion DamageRegion::translated(const QPoint &offset) const
+{
+    DamageRegion result = *this;
+    for (Box &box : result.m_boxes) {
+        box = Box{box.x1 + offset.x(), box.y1 + offset.y(), box.x2 + offset.x(), box.y2 + offset.y()};
+    }
+    if (!result.isEmpty()) {
+        result.m_bounds = Box{m_bounds.x1 + offset.x(), m_bounds.y1 + offset.y(),
+                              m_bounds.x2 + offset.x(), m_bounds.y2 + offset.y()};
+    }
+    return result;
+}
+
+QRegion DamageRegion::toRegion() const
+{
+    if (m_boxes.count() == 1) {
+        return QRegion(toRect(m_boxes.first()));
+    }
+    QRegion region;
+    for (const Box &box : m_boxes) {
+        region += toRect(box);
+    }
+    return region;
+}
+
+DamageRegion &DamageRegion::operator+=(const QRect &rect)
+{
+    add(rect);
+    return *this;
+}
+
+DamageRegion &DamageRegion::operator+=(const QRegion &region)
+{
+    add(region);
+    return *this;
+}
+
+DamageRegion &DamageRegion::operator+=(const DamageRegion &other)
+{
+    add(other);
+    return *this;
+}
+
+} // namespace KWin
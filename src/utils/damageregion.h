@@ -0,0 +1,93 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <kwin_export.h>
+
+#include <QRect>
+#include <QRegion>
+#include <QVarLengthArray>
+
+namespace KWin
+{
+
+/**
+ * The DamageRegion class accumulates damage, i.e. the areas that need to be repainted.
+ *
+ * Unlike QRegion, the DamageRegion doesn't split rectangles into bands, its rectangles
+ * may overlap and it may cover a bigger area than the one that has been added. When the
+ * number of rectangles exceeds the limit, the two rectangles whose union wastes the least
+ * area are merged. This keeps the cost of adding damage low and bounded, e.g. when a
+ * terminal scrolls or a spinner is animated, at the expense of repainting a little more.
+ *
+ * The first few rectangles are stored inline, so no memory is allocated for typical damage.
+ */
+class KWIN_EXPORT DamageRegion
+{
+public:
+    /**
+     * Constructs an empty damage region that holds at most defaultMaxRectCount() rectangles.
+     */
+    DamageRegion();
+    explicit DamageRegion(int maxRectCount);
+    DamageRegion(const QRect &rect);
+    DamageRegion(const QRegion &region);
+
+    bool isEmpty() const;
+    int rectCount() const;
+    QRect boundingRect() const;
+    QVector<QRect> rects() const;
+
+    int maxRectCount() const;
+    void setMaxRectCount(int count);
+
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+    void add(const DamageRegion &other);
+    void clear();
+
+    /**
+     * Returns the part of the damage region that lies inside the given @a rect.
+     */
+    DamageRegion intersected(const QRect &rect) const;
+    DamageRegion translated(const QPoint &offset) const;
+
+    QRegion toRegion() const;
+
+    DamageRegion &operator+=(const QRect &rect);
+    DamageRegion &operator+=(const QRegion &region);
+    DamageRegion &operator+=(const DamageRegion &other);
+
+    /**
+     * Returns the default maximum number of rectangles, 16 unless overridden with the
+     * KWIN_DAMAGE_MAX_RECTS environment variable.
+     */
+    static int defaultMaxRectCount();
+
+private:
+    struct Box
+    {
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    static Box toBox(const QRect &rect);
+    static QRect toRect(const Box &box);
+    void insert(const Box &box);
+    void simplify();
+
+    QVarLengthArray<Box, 16> m_boxes;
+    Box m_bounds = {0, 0, 0, 0};
+    int m_maxRectCount;
+};
+
+} // namespace KWin
@@ -0,0 +1,89 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "startupphase.h"
+#include "common.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+struct StartupPhaseRecord
+{
+    QString name;
+    bool mainThread;
+    qint64 start;
+    qint64 end;
+};
+
+struct StartupPhaseRecorder
+{
+    StartupPhaseRecorder()
+    {
+        timer.start();
+    }
+
+    QMutex mutex;
+    QElapsedTimer timer;
+    QVector<StartupPhaseRecord> records;
+};
+
+Q_GLOBAL_STATIC(StartupPhaseRecorder, s_recorder)
+
+StartupPhase::StartupPhase(const QString &name)
+    : m_name(name)
+    , m_start(s_recorder->timer.nsecsElapsed())
+{
+}
+
+StartupPhase::~StartupPhase()
+{
+    const qint64 end = s_recorder->timer.nsecsElapsed();
+    const bool mainThread = QThread::currentThread() == QCoreApplication::instance()->thread();
+
+    QMutexLocker locker(&s_recorder->mutex);
+    s_recorder->records.append(StartupPhaseRecord{m_name, mainThread, m_start, end});
+}
+
+void StartupPhase::report()
+{
+    QVector<StartupPhaseRecord> records;
+    {
+        QMutexLocker locker(&s_recorder->mutex);
+        records.swap(s_recorder->records);
+    }
+    if (records.isEmpty()) {
+        return;
+    }
+
+    std::sort(records.begin(), records.end(), [](const StartupPhaseRecord &a, const StartupPhaseRecord &b) {
+        return a.start < b.start;
+    });
+
+    const qint64 origin = records.first().start;
+    qint64 end = origin;
+    for (const StartupPhaseRecord &record : qAsConst(records)) {
+        qCInfo(KWIN_CORE, "Startup phase %-24s started at %8.2f ms, took %8.2f ms (%s)",
+               qPrintable(record.name),
+               (record.start - origin) / 1000000.0,
+               (record.end - record.start) / 1000000.0,
+               record.mainThread ? "main thread" : "worker thread");
+        end = std::max(end, record.end);
+    }
+    qCInfo(KWIN_CORE, "Startup phases finished after %.2f ms", (end - origin) / 1000000.0);
+}
+
+} // namespace KWin
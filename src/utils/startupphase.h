@@ -0,0 +1,45 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <kwin_export.h>
+
+#include <QString>
+
+namespace KWin
+{
+
+/**
+ * The StartupPhase class measures how long a step of the compositor startup takes.
+ *
+ * The phase begins when the object is constructed and ends when it is destroyed. Phases
+ * can be recorded from any thread, which makes it possible to see how well the work that
+ * runs in worker threads overlaps with the main thread.
+ */
+class KWIN_EXPORT StartupPhase
+{
+public:
+    explicit StartupPhase(const QString &name);
+    ~StartupPhase();
+
+    /**
+     * Prints the start time and the duration of all finished phases, relative to the
+     * first phase, and forgets about them.
+     */
+    static void report();
+
+private:
+    QString m_name;
+    qint64 m_start;
+
+    Q_DISABLE_COPY(StartupPhase)
+};
+
+} // namespace KWin
@@ -4699,7 +4699,7 @@ bool X11Client::supportsWindowRules() const
     return true;
 }
 
-void X11Client::damageNotifyEvent()
+void X11Client::damageNotifyEvent(xcb_damage_notify_event_t *e)
 {
     Q_ASSERT(kwinApp()->operationMode() == Application::OperationModeX11);
 
@@ -4712,7 +4712,7 @@ void X11Client::damageNotifyEvent()
 
     SurfaceItemX11 *item = static_cast<SurfaceItemX11 *>(surfaceItem());
     if (item) {
-        item->processDamage();
+        item->processDamage(QRect(e->area.x, e->area.y, e->area.width, e->area.height));
     }
 }
 
@@ -13,6 +13,7 @@
 #include "renderbackend.h"
 #include "scene.h"
 #include "utils/common.h"
+#include "ftrace.h"
 
 #include "kwinglplatform.h"
 
@@ -64,6 +65,7 @@ void X11SyncObject::trigger()
 
     xcb_sync_trigger_fence(kwinApp()->x11Connection(), m_fence);
     m_state = TriggerSent;
+    m_triggerTime = std::chrono::steady_clock::now();
 }
 
 void X11SyncObject::wait()
@@ -137,6 +139,37 @@ void X11SyncObject::finishResetting()
     m_state = Ready;
 }
 
+bool X11SyncObject::pollFinished()
+{
+    if (m_state == Done) {
+        return true;
+    }
+    Q_ASSERT(m_state == TriggerSent || m_state == Waiting);
+
+    GLint value;
+    glGetSynciv(m_sync, GL_SYNC_STATUS, 1, nullptr, &value);
+    if (value != GL_SIGNALED) {
+        return false;
+    }
+    m_state = Done;
+    return true;
+}
+
+bool X11SyncObject::pollResetting()
+{
+    Q_ASSERT(m_state == Resetting);
+
+    void *reply = nullptr;
+    xcb_generic_error_t *error = nullptr;
+    if (!xcb_poll_for_reply(kwinApp()->x11Connection(), m_reset_cookie.sequence, &reply, &error)) {
+        return false;
+    }
+    free(reply);
+    free(error);
+    m_state = Ready;
+    return true;
+}
+
 X11SyncManager *X11SyncManager::create()
 {
     if (kwinApp()->operationMode() != Application::OperationModeX11) {
@@ -167,7 +200,7 @@ X11SyncManager *X11SyncManager::create()
 
 X11SyncManager::X11SyncManager()
 {
-    for (int i = 0; i < MaxFences; ++i) {
+    for (int i = 0; i < MinFences; ++i) {
         m_fences.append(new X11SyncObject);
     }
 }
@@ -178,15 +211,22 @@ X11SyncManager::~X11SyncManager()
     qDeleteAll(m_fences);
 }
 
-bool X11SyncManager::endFrame()
+bool X11SyncManager::isRecentFence(X11SyncObject *fence) const
 {
-    if (!m_currentFence) {
-        return true;
-    }
+    return fence == m_currentFence || fence == m_previousFence;
+}
 
-    for (int i = 0; i < std::min(2, m_fences.count() - 1); i++) {
-        const int index = (m_next + i) % m_fences.count();
-        X11SyncObject *fence = m_fences[index];
+void X11SyncManager::pollFences()
+{
+    int inFlight = 0;
+
+    for (X11SyncObject *fence : qAsConst(m_fences)) {
+        if (isRecentFence(fence)) {
+            if (fence->state() != X11SyncObject::Ready) {
+                inFlight++;
+            }
+            continue;
+        }
 
         switch (fence->state()) {
         case X11SyncObject::Ready:
@@ -194,32 +234,133 @@ bool X11SyncManager::endFrame()
 
         case X11SyncObject::TriggerSent:
         case X11SyncObject::Waiting:
-            if (!fence->finish()) {
-                return false;
+            if (fence->pollFinished()) {
+                fence->reset();
             }
-            fence->reset();
+            inFlight++;
             break;
 
         // Should not happen in practice since we always reset the fence after finishing it
         case X11SyncObject::Done:
             fence->reset();
+            inFlight++;
             break;
 
         case X11SyncObject::Resetting:
-            fence->finishResetting();
+            if (!fence->pollResetting()) {
+                inFlight++;
+            }
             break;
         }
     }
 
-    m_currentFence = nullptr;
+    m_maxInFlight = std::max(m_maxInFlight, inFlight);
+}
+
+bool X11SyncManager::waitForFence(X11SyncObject *fence)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    switch (fence->state()) {
+    case X11SyncObject::Ready:
+        return true;
+    case X11SyncObject::TriggerSent:
+    case X11SyncObject::Waiting:
+        if (!fence->finish()) {
+            return false;
+        }
+        fence->reset();
+        fence->finishResetting();
+        break;
+    case X11SyncObject::Done:
+        fence->reset();
+        fence->finishResetting();
+        break;
+    case X11SyncObject::Resetting:
+        fence->finishResetting();
+        break;
+    }
+
+    const std::chrono::nanoseconds blocked = std::chrono::steady_clock::now() - start;
+    fTrace("X11 fence blocking wait usec=", std::chrono::duration_cast<std::chrono::microseconds>(blocked).count());
     return true;
 }
 
+void X11SyncManager::shrink(int count)
+{
+    for (int i = m_fences.count() - 1; i >= 0 && m_fences.count() > count; --i) {
+        X11SyncObject *fence = m_fences[i];
+        if (fence == m_currentFence || fence->state() != X11SyncObject::Ready) {
+            continue;
+        }
+        delete fence;
+        m_fences.remove(i);
+        if (i < m_next) {
+            m_next--;
+        }
+    }
+    m_next %= m_fences.count();
+}
+
+bool X11SyncManager::endFrame()
+{
+    if (!m_currentFence) {
+        return !m_failed;
+    }
+
+    pollFences();
+
+    // The fences are normally signaled within a frame, if a fence has been pending for
+    // a long time, wait for it so that a hung X server or GPU is detected.
+    const auto now = std::chrono::steady_clock::now();
+    for (X11SyncObject *fence : qAsConst(m_fences)) {
+        if (isRecentFence(fence)) {
+            continue;
+        }
+        const X11SyncObject::State state = fence->state();
+        if ((state == X11SyncObject::TriggerSent || state == X11SyncObject::Waiting)
+            && now - fence->triggerTime() > std::chrono::seconds(1)) {
+            if (!waitForFence(fence)) {
+                return false;
+            }
+        }
+    }
+
+    m_previousFence = m_currentFence;
+    m_currentFence = nullptr;
+
+    if (++m_frameCount == 1000) {
+        // Give back the fences that haven't been needed.
+        shrink(std::max<int>(MinFences, m_maxInFlight + 2));
+        m_maxInFlight = 0;
+        m_frameCount = 0;
+    }
+
+    return !m_failed;
+}
+
 void X11SyncManager::triggerFence()
 {
-    m_currentFence = m_fences[m_next];
+    pollFences();
+
+    X11SyncObject *fence = m_fences[m_next];
+    if (fence->state() != X11SyncObject::Ready) {
+        if (m_fences.count() < MaxFences) {
+            // All fences are still in use, add another one instead of waiting. It's inserted
+            // at the current position so the other fences keep their order.
+            fence = new X11SyncObject;
+            m_fences.insert(m_next, fence);
+        } else if (!waitForFence(fence)) {
+            qCWarning(KWIN_CORE) << "Failed to wait for X fence";
+            m_failed = true;
+            return;
+        }
+    }
+
+    m_currentFence = fence;
     m_next = (m_next + 1) % m_fences.count();
     m_currentFence->trigger();
+    fTrace("X11 fence triggered fences=", m_fences.count());
 }
 
 void X11SyncManager::insertWait()
@@ -11,6 +11,8 @@
 #include <xcb/xcb.h>
 #include <xcb/sync.h>
 
+#include <chrono>
+
 namespace KWin
 {
 
@@ -27,6 +29,7 @@ public:
     ~X11SyncObject();
 
     State state() const { return m_state; }
+    std::chrono::steady_clock::time_point triggerTime() const { return m_triggerTime; }
 
     void trigger();
     void wait();
@@ -34,21 +37,42 @@ public:
     void reset();
     void finishResetting();
 
+    /**
+     * Checks whether the fence has been signaled without blocking. Returns @c true if
+     * the fence is done.
+     */
+    bool pollFinished();
+    /**
+     * Checks whether the X server has processed the reset request without blocking.
+     * Returns @c true if the fence is ready to be triggered again.
+     */
+    bool pollResetting();
+
 private:
     State m_state;
     GLsync m_sync;
     xcb_sync_fence_t m_fence;
     xcb_get_input_focus_cookie_t m_reset_cookie;
+    std::chrono::steady_clock::time_point m_triggerTime;
 };
 
 /**
  * SyncManager manages a set of fences used for explicit synchronization with the X command
  * stream.
+ *
+ * The fences are used in a round-robin fashion. The state of the fences that are in flight
+ * is polled at the end of every frame, so the compositor doesn't block on the X server or
+ * the GPU as long as there is a fence that is ready to be triggered. If there is none,
+ * another fence is created, up to MaxFences. The fences that haven't been needed for a
+ * while are destroyed again, down to MinFences.
+ *
+ * The fences triggered in the current and in the previous frame are never polled or reset,
+ * so there are always at least two frames between triggering a fence and resetting it.
  */
 class X11SyncManager
 {
 public:
-    enum { MaxFences = 4 };
+    enum { MinFences = 4, MaxFences = 16 };
 
     static X11SyncManager *create();
     ~X11SyncManager();
@@ -61,9 +85,21 @@ public:
 private:
     X11SyncManager();
 
+    void pollFences();
+    bool waitForFence(X11SyncObject *fence);
+    void shrink(int count);
+
+    bool isRecentFence(X11SyncObject *fence) const;
+
     X11SyncObject *m_currentFence = nullptr;
+    // the fence triggered in the previous frame
+    X11SyncObject *m_previousFence = nullptr;
     QVector<X11SyncObject *> m_fences;
     int m_next = 0;
+    bool m_failed = false;
+    // the peak number of fences in flight since the fence ring was last shrunk
+    int m_maxInFlight = 0;
+    int m_frameCount = 0;
 };
 
 } // namespace KWin
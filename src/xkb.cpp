@@ -15,6 +15,7 @@
 #include <KWaylandServer/seat_interface.h>
 // Qt
 #include <QTemporaryFile>
+#include <QtConcurrentRun>
 #include <QKeyEvent>
 #include <QtXkbCommonSupport/private/qxkbcommon_p.h>
 // xkbcommon
@@ -173,33 +174,124 @@ void Xkb::applyEnvironmentRules(xkb_rule_names &ruleNames)
     }
 }
 
+/**
+ * The rule names that describe the keymap in the kxkbrc config file.
+ */
+struct KeymapConfig
+{
+    explicit KeymapConfig(const KConfigGroup &group)
+        : model(group.readEntry("Model", "pc104").toLatin1())
+        , layout(group.readEntry("LayoutList").toLatin1())
+        , variant(group.readEntry("VariantList").toLatin1())
+        , options(group.readEntry("Options").toLatin1())
+        , resetOldOptions(group.readEntry("ResetOldOptions", false))
+    {
+    }
+
+    bool operator==(const KeymapConfig &other) const
+    {
+        return model == other.model
+            && layout == other.layout
+            && variant == other.variant
+            && options == other.options
+            && resetOldOptions == other.resetOldOptions;
+    }
+
+    xkb_rule_names ruleNames() const
+    {
+        xkb_rule_names ruleNames = {
+            .rules = nullptr,
+            .model = model.constData(),
+            .layout = layout.constData(),
+            .variant = variant.constData(),
+            .options = nullptr,
+        };
+
+        if (resetOldOptions) {
+            ruleNames.options = options.constData();
+        }
+
+        Xkb::applyEnvironmentRules(ruleNames);
+        return ruleNames;
+    }
+
+    QByteArray model;
+    QByteArray layout;
+    QByteArray variant;
+    QByteArray options;
+    bool resetOldOptions;
+};
+
+/**
+ * A keymap that is compiled in a worker thread while the compositor starts up.
+ */
+struct PrefetchedKeymap
+{
+    KeymapConfig config;
+    QFuture<xkb_keymap *> keymap;
+};
+
+static PrefetchedKeymap *s_prefetchedKeymap = nullptr;
+
+void Xkb::prefetchKeymap(const KSharedConfigPtr &config)
+{
+    if (s_prefetchedKeymap || !config || qEnvironmentVariableIsSet("KWIN_XKB_DEFAULT_KEYMAP")) {
+        return;
+    }
+    const KConfigGroup group = config->group("Layout");
+    if (!group.isValid()) {
+        return;
+    }
+
+    // KConfig is not thread safe, so the config is read here and only the compilation
+    // happens in the worker thread.
+    const KeymapConfig keymapConfig(group);
+    s_prefetchedKeymap = new PrefetchedKeymap{keymapConfig, QFuture<xkb_keymap *>()};
+    s_prefetchedKeymap->keymap = QtConcurrent::run([keymapConfig]() -> xkb_keymap * {
+        // xkb_context is not thread safe either, the keymap keeps its own context alive.
+        xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        if (!context) {
+            return nullptr;
+        }
+        xkb_context_set_log_level(context, XKB_LOG_LEVEL_DEBUG);
+        xkb_context_set_log_fn(context, &xkbLogHandler);
+        const xkb_rule_names ruleNames = keymapConfig.ruleNames();
+        xkb_keymap *keymap = xkb_keymap_new_from_names(context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
+        xkb_context_unref(context);
+        return keymap;
+    });
+}
+
+static xkb_keymap *takePrefetchedKeymap(const KeymapConfig &config)
+{
+    if (!s_prefetchedKeymap) {
+        return nullptr;
+    }
+    xkb_keymap *keymap = s_prefetchedKeymap->keymap.result();
+    if (!(s_prefetchedKeymap->config == config)) {
+        // The config has been changed while the keymap was being compiled.
+        xkb_keymap_unref(keymap);
+        keymap = nullptr;
+    }
+    delete s_prefetchedKeymap;
+    s_prefetchedKeymap = nullptr;
+    return keymap;
+}
+
 xkb_keymap *Xkb::loadKeymapFromConfig()
 {
     // load config
     if (!m_configGroup.isValid()) {
         return nullptr;
     }
-    const QByteArray model = m_configGroup.readEntry("Model", "pc104").toLatin1();
-    const QByteArray layout = m_configGroup.readEntry("LayoutList").toLatin1();
-    const QByteArray variant = m_configGroup.readEntry("VariantList").toLatin1();
-    const QByteArray options = m_configGroup.readEntry("Options").toLatin1();
-
-    xkb_rule_names ruleNames = {
-        .rules = nullptr,
-        .model = model.constData(),
-        .layout = layout.constData(),
-        .variant = variant.constData(),
-        .options = nullptr,
-    };
-
-    if (m_configGroup.readEntry("ResetOldOptions", false)) {
-        ruleNames.options = options.constData();
-    }
-
-    applyEnvironmentRules(ruleNames);
+    const KeymapConfig config(m_configGroup);
+    const xkb_rule_names ruleNames = config.ruleNames();
 
     m_layoutList = QString::fromLatin1(ruleNames.layout).split(QLatin1Char(','));
 
+    if (xkb_keymap *keymap = takePrefetchedKeymap(config)) {
+        return keymap;
+    }
     return xkb_keymap_new_from_names(m_context, &ruleNames, XKB_KEYMAP_COMPILE_NO_FLAGS);
 }
 
@@ -43,6 +43,12 @@ public:
     Xkb(QObject *parent = nullptr);
     ~Xkb() override;
     void setConfig(const KSharedConfigPtr &config);
+    /**
+     * Compiles the keymap described by the Layout group of @p config in a worker thread.
+     * The keymap is used by the next reconfigure() if the config still matches by then.
+     */
+    static void prefetchKeymap(const KSharedConfigPtr &config);
+    static void applyEnvironmentRules(xkb_rule_names &);
     void setNumLockConfig(const KSharedConfigPtr &config);
     void reconfigure();
 
@@ -104,7 +110,6 @@ Q_SIGNALS:
     void modifierStateChanged();
 
 private:
-    void applyEnvironmentRules(xkb_rule_names &);
     xkb_keymap *loadKeymapFromConfig();
     xkb_keymap *loadDefaultKeymap();
     void updateKeymap(xkb_keymap *keymap);
@@ -33,9 +33,6 @@ namespace KWin
 namespace Xwl
 {
 
-// in Bytes: equals 64KB
-static const uint32_t s_incrChunkSize = 63 * 1024;
-
 Transfer::Transfer(xcb_atom_t selection, qint32 fd, xcb_timestamp_t timestamp, QObject *parent)
     : QObject(parent)
     , m_atom(selection)
@@ -44,16 +41,30 @@ Transfer::Transfer(xcb_atom_t selection, qint32 fd, xcb_timestamp_t timestamp, Q
 {
 }
 
-void Transfer::createSocketNotifier(QSocketNotifier::Type type)
+Transfer::~Transfer()
+{
+    destroyStream();
+    closeFd();
+}
+
+TransferStream *Transfer::createStream(TransferStream::Direction direction)
 {
-    delete m_notifier;
-    m_notifier = new QSocketNotifier(m_fd, type, this);
+    Q_ASSERT(!m_stream);
+    m_stream = new TransferStream(m_fd, direction);
+    m_fd = -1;
+    connect(m_stream, &TransferStream::failed, this, &Transfer::endTransfer);
+    return m_stream;
 }
 
-void Transfer::clearSocketNotifier()
+void Transfer::destroyStream()
 {
-    delete m_notifier;
-    m_notifier = nullptr;
+    if (!m_stream) {
+        return;
+    }
+    // the stream lives in the worker thread and closes the fd there
+    disconnect(m_stream, nullptr, this, nullptr);
+    m_stream->deleteLater();
+    m_stream = nullptr;
 }
 
 void Transfer::timeout()
@@ -66,7 +77,7 @@ void Transfer::timeout()
 
 void Transfer::endTransfer()
 {
-    clearSocketNotifier();
+    destroyStream();
     closeFd();
     Q_EMIT finished();
 }
@@ -95,13 +106,9 @@ TransferWltoX::~TransferWltoX()
 
 void TransferWltoX::startTransferFromSource()
 {
-    createSocketNotifier(QSocketNotifier::Read);
-    connect(socketNotifier(), &QSocketNotifier::activated, this,
-            [this](int socket) {
-                Q_UNUSED(socket);
-                readWlSource();
-            }
-    );
+    TransferStream *stream = createStream(TransferStream::Direction::Read);
+    connect(stream, &TransferStream::chunkRead, this, &TransferWltoX::handleChunkRead);
+    stream->start();
 }
 
 int TransferWltoX::flushSourceData()
@@ -109,21 +116,23 @@ int TransferWltoX::flushSourceData()
     Q_ASSERT(!m_chunks.isEmpty());
     xcb_connection_t *xcbConn = kwinApp()->x11Connection();
 
+    const QByteArray chunk = m_chunks.takeFirst();
     xcb_change_property(xcbConn,
                         XCB_PROP_MODE_REPLACE,
                         m_request->requestor,
                         m_request->property,
                         m_request->target,
                         8,
-                        m_chunks.first().first.size(),
-                        m_chunks.first().first.data());
+                        chunk.size(),
+                        chunk.constData());
     xcb_flush(xcbConn);
 
     m_propertyIsSet = true;
     resetTimeout();
 
-    const auto rm = m_chunks.takeFirst();
-    return rm.first.size();
+    // make room for the next chunk
+    stream()->consume();
+    return chunk.size();
 }
 
 void TransferWltoX::startIncr()
@@ -155,62 +164,28 @@ void TransferWltoX::startIncr()
     Q_EMIT selectionNotify(m_request, true);
 }
 
-void TransferWltoX::readWlSource()
+void TransferWltoX::handleChunkRead(const QByteArray &chunk, bool last)
 {
-    if (m_chunks.size() == 0 ||
-            m_chunks.last().second == s_incrChunkSize) {
-        // append new chunk
-        auto next = QPair<QByteArray, int>();
-        next.first.resize(s_incrChunkSize);
-        next.second = 0;
-        m_chunks.append(next);
-    }
-
-    const auto oldLen = m_chunks.last().second;
-    const auto avail = s_incrChunkSize - m_chunks.last().second;
-    Q_ASSERT(avail > 0);
-
-    ssize_t readLen = read(fd(), m_chunks.last().first.data() + oldLen, avail);
-    if (readLen == -1) {
-        qCWarning(KWIN_XWL) << "Error reading in Wl data.";
+    m_chunks.append(chunk);
+    m_sourceDrained = last;
 
-        // TODO: cleanup X side?
-        endTransfer();
-        return;
-    }
-    m_chunks.last().second = oldLen + readLen;
-
-    if (readLen == 0) {
-        // at the fd end - complete transfer now
-        m_chunks.last().first.resize(m_chunks.last().second);
-
-        if (incr()) {
-            // incremental transfer is to be completed now
-            m_flushPropertyOnDelete = true;
-            if (!m_propertyIsSet) {
-                // flush if target's property is not set at the moment
-                flushSourceData();
-            }
-            clearSocketNotifier();
-        } else {
+    if (!incr()) {
+        if (last) {
             // non incremental transfer is to be completed now,
             // data can be transferred to X client via a single property set
             flushSourceData();
             Q_EMIT selectionNotify(m_request, true);
             endTransfer();
-        }
-    } else if (m_chunks.last().second == s_incrChunkSize) {
-        // first chunk full, but not yet at fd end -> go incremental
-        if (incr()) {
-            m_flushPropertyOnDelete = true;
-            if (!m_propertyIsSet) {
-                // flush if target's property is not set at the moment
-                flushSourceData();
-            }
         } else {
-            // starting incremental transfer
+            // first chunk full, but not yet at fd end -> go incremental
             startIncr();
         }
+    } else {
+        m_flushPropertyOnDelete = true;
+        if (!m_propertyIsSet) {
+            // flush if target's property is not set at the moment
+            flushSourceData();
+        }
     }
     resetTimeout();
 }
@@ -236,7 +211,7 @@ void TransferWltoX::handlePropertyDelete()
     m_propertyIsSet = false;
 
     if (m_flushPropertyOnDelete) {
-        if (!socketNotifier() && m_chunks.isEmpty()) {
+        if (m_sourceDrained && m_chunks.isEmpty()) {
             // transfer complete
             xcb_connection_t *xcbConn = kwinApp()->x11Connection();
 
@@ -281,6 +256,12 @@ TransferXtoWl::TransferXtoWl(xcb_atom_t selection, xcb_atom_t target, qint32 fd,
                       XCB_COPY_FROM_PARENT,
                       XCB_CW_EVENT_MASK,
                       values);
+
+    TransferStream *stream = createStream(TransferStream::Direction::Write);
+    connect(stream, &TransferStream::chunkWritten, this, &TransferXtoWl::handleChunkWritten);
+    connect(stream, &TransferStream::finished, this, &TransferXtoWl::endTransfer);
+    stream->start();
+
     // convert selection
     xcb_convert_selection(xcbConn,
                           m_window,
@@ -375,6 +356,7 @@ void TransferXtoWl::startTransfer()
         // reply's ownership is transferred
         m_receiver->transferFromProperty(reply);
         dataSourceWrite();
+        stream()->finish();
     }
 }
 
@@ -388,10 +370,18 @@ void TransferXtoWl::getIncrChunk()
         // receive mechanism has not yet been setup
         return;
     }
+    if (m_chunksInFlight >= TransferStream::s_maxChunksInFlight) {
+        // the Wayland client is too slow, fetch the chunk once it has caught up
+        m_incrChunkPending = true;
+        return;
+    }
+    m_incrChunkPending = false;
     xcb_connection_t *xcbConn = kwinApp()->x11Connection();
 
+    // Deleting the property right away lets the source prepare the next chunk
+    // while this one is still being written to the Wayland client.
     auto cookie = xcb_get_property(xcbConn,
-                                   0,
+                                   1,
                                    m_window,
                                    atoms->wl_selection,
                                    XCB_GET_PROPERTY_TYPE_ANY,
@@ -410,9 +400,9 @@ void TransferXtoWl::getIncrChunk()
         m_receiver->transferFromProperty(reply);
         dataSourceWrite();
     } else {
-        // Transfer complete
+        // Transfer complete once all chunks have been written
         free(reply);
-        endTransfer();
+        stream()->finish();
     }
 }
 
@@ -538,42 +528,27 @@ void MozUrlReceiver::setData(const char *value, int length)
 
 void TransferXtoWl::dataSourceWrite()
 {
-    QByteArray property = m_receiver->data();
+    const QByteArray property = m_receiver->data();
 
-    ssize_t len = write(fd(), property.constData(), property.size());
-    if (len == -1) {
-        qCWarning(KWIN_XWL) << "X11 to Wayland write error on fd:" << fd();
-        endTransfer();
-        return;
-    }
+    // the property reply is freed below, the stream needs its own copy
+    const QByteArray chunk(property.constData(), property.size());
+    m_receiver->partRead(property.size());
 
-    m_receiver->partRead(len);
-    if (len == property.size()) {
-        // property completely transferred
-        if (incr()) {
-            clearSocketNotifier();
-            xcb_connection_t *xcbConn = kwinApp()->x11Connection();
-            xcb_delete_property(xcbConn,
-                                m_window,
-                                atoms->wl_selection);
-            xcb_flush(xcbConn);
-        } else {
-            // transfer complete
-            endTransfer();
-        }
-    } else {
-        if (!socketNotifier()) {
-            createSocketNotifier(QSocketNotifier::Write);
-            connect(socketNotifier(), &QSocketNotifier::activated, this,
-                [this](int socket) {
-                    Q_UNUSED(socket);
-                    dataSourceWrite();
-                }
-            );
-        }
+    if (!chunk.isEmpty()) {
+        ++m_chunksInFlight;
+        stream()->write(chunk);
     }
     resetTimeout();
 }
 
+void TransferXtoWl::handleChunkWritten()
+{
+    --m_chunksInFlight;
+    resetTimeout();
+    if (m_incrChunkPending) {
+        getIncrChunk();
+    }
+}
+
 } // namespace Xwl
 } // namespace KWin
@@ -9,8 +9,9 @@
 #ifndef KWIN_XWL_TRANSFER
 #define KWIN_XWL_TRANSFER
 
+#include "transferstream.h"
+
 #include <QObject>
-#include <QSocketNotifier>
 #include <QVector>
 
 #include <xcb/xcb.h>
@@ -50,6 +51,7 @@ public:
              qint32 fd,
              xcb_timestamp_t timestamp,
              QObject *parent = nullptr);
+    ~Transfer() override;
 
     virtual bool handlePropertyNotify(xcb_property_notify_event_t *event) = 0;
     void timeout();
@@ -66,9 +68,6 @@ protected:
     xcb_atom_t atom() const {
         return m_atom;
     }
-    qint32 fd() const {
-        return m_fd;
-    }
 
     void setIncr(bool set) {
         m_incr = set;
@@ -79,19 +78,23 @@ protected:
     void resetTimeout() {
         m_timeout = false;
     }
-    void createSocketNotifier(QSocketNotifier::Type type);
-    void clearSocketNotifier();
-    QSocketNotifier *socketNotifier() const {
-        return m_notifier;
+    /**
+     * Hands the file descriptor over to a new stream that does all I/O on it.
+     */
+    TransferStream *createStream(TransferStream::Direction direction);
+    TransferStream *stream() const {
+        return m_stream;
     }
+
 private:
+    void destroyStream();
     void closeFd();
 
     xcb_atom_t m_atom;
     qint32 m_fd;
     xcb_timestamp_t m_timestamp = XCB_CURRENT_TIME;
 
-    QSocketNotifier *m_notifier = nullptr;
+    TransferStream *m_stream = nullptr;
     bool m_incr = false;
     bool m_timeout = false;
 
@@ -120,19 +123,20 @@ Q_SIGNALS:
 
 private:
     void startIncr();
-    void readWlSource();
+    void handleChunkRead(const QByteArray &chunk, bool last);
     int flushSourceData();
     void handlePropertyDelete();
 
     xcb_selection_request_event_t *m_request = nullptr;
 
-    /* contains all received data portioned in chunks
-     * TODO: explain second QPair component
+    /* contains the received data that has not been passed to the requestor yet,
+     * bounded by TransferStream::s_maxChunksInFlight
      */
-    QVector<QPair<QByteArray, int> > m_chunks;
+    QVector<QByteArray> m_chunks;
 
     bool m_propertyIsSet = false;
     bool m_flushPropertyOnDelete = false;
+    bool m_sourceDrained = false;
 
     Q_DISABLE_COPY(TransferWltoX)
 };
@@ -204,12 +208,16 @@ public:
 
 private:
     void dataSourceWrite();
+    void handleChunkWritten();
     void startTransfer();
     void getIncrChunk();
 
     xcb_window_t m_window;
     DataReceiver *m_receiver = nullptr;
 
+    int m_chunksInFlight = 0;
+    bool m_incrChunkPending = false;
+
     Q_DISABLE_COPY(TransferXtoWl)
 };
 
@@ -0,0 +1,204 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "transferstream.h"
+
+#include <QCoreApplication>
+#include <QSocketNotifier>
+#include <QThread>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+#include <xwayland_logging.h>
+
+namespace KWin
+{
+namespace Xwl
+{
+
+// Larger pipe buffers let clients write or read more data per wakeup of the worker thread.
+static const int s_pipeSize = 1024 * 1024;
+
+TransferStream::TransferStream(qint32 fd, Direction direction)
+    : m_fd(fd)
+    , m_direction(direction)
+{
+    moveToThread(workerThread());
+}
+
+TransferStream::~TransferStream()
+{
+    delete m_notifier;
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+QThread *TransferStream::workerThread()
+{
+    static QThread *thread = nullptr;
+    if (!thread) {
+        thread = new QThread();
+        thread->setObjectName(QStringLiteral("KWin Xwayland transfers"));
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, thread, [] {
+            thread->quit();
+            thread->wait();
+        });
+        thread->start();
+    }
+    return thread;
+}
+
+void TransferStream::start()
+{
+    QMetaObject::invokeMethod(this, &TransferStream::startInternal, Qt::QueuedConnection);
+}
+
+void TransferStream::consume()
+{
+    QMetaObject::invokeMethod(this, &TransferStream::consumeInternal, Qt::QueuedConnection);
+}
+
+void TransferStream::write(const QByteArray &chunk)
+{
+    QMetaObject::invokeMethod(this, [this, chunk]() {
+        m_writeQueue.enqueue(chunk);
+        writeData();
+    }, Qt::QueuedConnection);
+}
+
+void TransferStream::finish()
+{
+    QMetaObject::invokeMethod(this, [this]() {
+        m_finishing = true;
+        writeData();
+    }, Qt::QueuedConnection);
+}
+
+void TransferStream::startInternal()
+{
+    const int flags = fcntl(m_fd, F_GETFL);
+    if (flags == -1 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        qCWarning(KWIN_XWL, "Failed to make the transfer fd non-blocking: %s", strerror(errno));
+        fail();
+        return;
+    }
+#ifdef F_SETPIPE_SZ
+    // Not every fd is a pipe and the size may exceed the system limit, it's just a hint.
+    fcntl(m_fd, F_SETPIPE_SZ, s_pipeSize);
+#endif
+
+    if (m_direction == Direction::Read) {
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+        connect(m_notifier, &QSocketNotifier::activated, this, &TransferStream::readData);
+    } else {
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Write, this);
+        m_notifier->setEnabled(false);
+        connect(m_notifier, &QSocketNotifier::activated, this, &TransferStream::writeData);
+    }
+}
+
+void TransferStream::consumeInternal()
+{
+    Q_ASSERT(m_chunksInFlight > 0);
+    --m_chunksInFlight;
+    if (m_notifier && !m_sourceDrained) {
+        m_notifier->setEnabled(true);
+    }
+}
+
+void TransferStream::readData()
+{
+    while (m_chunksInFlight < s_maxChunksInFlight) {
+        if (m_readBuffer.isEmpty()) {
+            m_readBuffer.resize(s_incrChunkSize);
+            m_readLength = 0;
+        }
+
+        const ssize_t readLen = read(m_fd, m_readBuffer.data() + m_readLength, s_incrChunkSize - m_readLength);
+        if (readLen == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                qCWarning(KWIN_XWL) << "Error reading in Wl data.";
+                fail();
+            }
+            return;
+        }
+        m_readLength += readLen;
+
+        if (readLen == 0) {
+            // at the fd end
+            m_readBuffer.resize(m_readLength);
+            m_sourceDrained = true;
+            m_notifier->setEnabled(false);
+            ++m_chunksInFlight;
+            Q_EMIT chunkRead(std::exchange(m_readBuffer, QByteArray()), true);
+            return;
+        }
+        if (m_readLength == int(s_incrChunkSize)) {
+            ++m_chunksInFlight;
+            Q_EMIT chunkRead(std::exchange(m_readBuffer, QByteArray()), false);
+        }
+    }
+
+    // Pause reading until the receiver has caught up.
+    m_notifier->setEnabled(false);
+}
+
+void TransferStream::writeData()
+{
+    if (!m_notifier) {
+        return;
+    }
+
+    while (!m_writeQueue.isEmpty()) {
+        const QByteArray &chunk = m_writeQueue.head();
+        const ssize_t len = ::write(m_fd, chunk.constData() + m_writeOffset, chunk.size() - m_writeOffset);
+        if (len == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                m_notifier->setEnabled(true);
+            } else {
+                qCWarning(KWIN_XWL) << "X11 to Wayland write error on fd:" << m_fd;
+                fail();
+            }
+            return;
+        }
+
+        m_writeOffset += len;
+        if (m_writeOffset == chunk.size()) {
+            m_writeQueue.dequeue();
+            m_writeOffset = 0;
+            Q_EMIT chunkWritten();
+        }
+    }
+
+    m_notifier->setEnabled(false);
+    if (m_finishing) {
+        m_finishing = false;
+        Q_EMIT finished();
+    }
+}
+
+void TransferStream::fail()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    Q_EMIT failed();
+}
+
+} // namespace Xwl
+} // namespace KWin
@@ -0,0 +1,127 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2022 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef KWIN_XWL_TRANSFERSTREAM
+#define KWIN_XWL_TRANSFERSTREAM
+
+#include <QByteArray>
+#include <QObject>
+#include <QQueue>
+
+class QSocketNotifier;
+class QThread;
+
+namespace KWin
+{
+namespace Xwl
+{
+
+// in Bytes: equals 64KB
+static const uint32_t s_incrChunkSize = 63 * 1024;
+
+/**
+ * Moves selection data between a Wayland file descriptor and the main thread.
+ *
+ * The stream lives in a worker thread shared by all transfers, so reading from or writing
+ * to a slow or huge Wayland pipe never blocks the compositor. At most a few chunks are kept
+ * in flight; the side that produces data is paused until the other side catches up.
+ *
+ * The stream takes over the file descriptor and closes it when it's destroyed. It must be
+ * destroyed with deleteLater().
+ */
+class TransferStream : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Direction {
+        /**
+         * Data is read from a Wayland source and handed out in chunks.
+         */
+        Read,
+        /**
+         * Chunks of data are written to a Wayland target.
+         */
+        Write,
+    };
+
+    TransferStream(qint32 fd, Direction direction);
+    ~TransferStream() override;
+
+    /**
+     * The maximum number of chunks that can be in flight at the same time.
+     */
+    static const int s_maxChunksInFlight = 4;
+
+    /**
+     * Starts watching the file descriptor. May be called from any thread.
+     */
+    void start();
+    /**
+     * Notifies the stream that a chunk emitted with chunkRead() has been consumed and reading
+     * can go on. May be called from any thread.
+     */
+    void consume();
+    /**
+     * Queues the @a chunk to be written to the file descriptor. May be called from any thread.
+     */
+    void write(const QByteArray &chunk);
+    /**
+     * Notifies the stream that no more chunks will be written. The finished() signal will be
+     * emitted after all pending data has been written. May be called from any thread.
+     */
+    void finish();
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted when a chunk of data has been read. If @a last is @c true, the
+     * end of the source has been reached and no more chunks will follow.
+     */
+    void chunkRead(const QByteArray &chunk, bool last);
+    /**
+     * This signal is emitted when a chunk queued with write() has been written completely.
+     */
+    void chunkWritten();
+    /**
+     * This signal is emitted when all data has been written after finish() was called.
+     */
+    void finished();
+    /**
+     * This signal is emitted when reading or writing has failed.
+     */
+    void failed();
+
+private:
+    static QThread *workerThread();
+
+    void startInternal();
+    void consumeInternal();
+    void readData();
+    void writeData();
+    void fail();
+
+    qint32 m_fd;
+    Direction m_direction;
+    QSocketNotifier *m_notifier = nullptr;
+
+    QByteArray m_readBuffer;
+    int m_readLength = 0;
+    int m_chunksInFlight = 0;
+    bool m_sourceDrained = false;
+
+    QQueue<QByteArray> m_writeQueue;
+    int m_writeOffset = 0;
+    bool m_finishing = false;
+
+    Q_DISABLE_COPY(TransferStream)
+};
+
+} // namespace Xwl
+} // namespace KWin
+
+#endif
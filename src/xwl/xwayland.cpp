@@ -100,11 +100,12 @@ QProcess *Xwayland::process() const
     return m_xwaylandProcess;
 }
 
-void Xwayland::start()
+void Xwayland::start(StartMode mode)
 {
-    if (m_xwaylandProcess) {
+    if (m_xwaylandProcess || !m_listenFdNotifiers.isEmpty()) {
         return;
     }
+    m_startMode = mode;
 
     if (!m_listenFds.isEmpty()) {
         Q_ASSERT(!m_displayName.isEmpty());
@@ -117,6 +118,44 @@ void Xwayland::start()
         m_listenFds = m_socket->fileDescriptors();
     }
 
+    if (m_startMode == StartMode::Immediately) {
+        startInternal();
+        return;
+    }
+
+#if !defined(HAVE_XWAYLAND_TERMINATE_DELAY)
+    if (options->xwaylandIdleTimeout() > 0) {
+        qCWarning(KWIN_XWL) << "Xwayland does not support -terminate with a delay, it will not be stopped when idle";
+    }
+#endif
+
+    // Clients must be able to find the X server before it actually runs.
+    updateEnvironment();
+    installListenFdNotifiers();
+    qCInfo(KWIN_XWL) << "Xwayland will be started on demand on display" << m_displayName;
+}
+
+void Xwayland::installListenFdNotifiers()
+{
+    Q_ASSERT(m_listenFdNotifiers.isEmpty());
+    for (int socket : qAsConst(m_listenFds)) {
+        QSocketNotifier *notifier = new QSocketNotifier(socket, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &Xwayland::handleListenFdActivated);
+        m_listenFdNotifiers.append(notifier);
+    }
+}
+
+void Xwayland::uninstallListenFdNotifiers()
+{
+    qDeleteAll(m_listenFdNotifiers);
+    m_listenFdNotifiers.clear();
+}
+
+void Xwayland::handleListenFdActivated()
+{
+    // The pending connection is left in the backlog, Xwayland will accept it once it's up.
+    uninstallListenFdNotifiers();
+    qCDebug(KWIN_XWL) << "An X11 client is connecting, starting Xwayland";
     startInternal();
 }
 
@@ -205,6 +244,11 @@ bool Xwayland::startInternal()
 
     arguments << QStringLiteral("-displayfd") << QString::number(pipeFds[1]);
     arguments << QStringLiteral("-rootless");
+#if defined(HAVE_XWAYLAND_TERMINATE_DELAY)
+    if (m_startMode == StartMode::OnDemand && options->xwaylandIdleTimeout() > 0) {
+        arguments << QStringLiteral("-terminate") << QString::number(options->xwaylandIdleTimeout());
+    }
+#endif
     arguments << QStringLiteral("-wm") << QString::number(fd);
 
     m_xwaylandProcess = new QProcess(this);
@@ -227,6 +271,7 @@ bool Xwayland::startInternal()
     m_readyNotifier = new QSocketNotifier(pipeFds[0], QSocketNotifier::Read, this);
     connect(m_readyNotifier, &QSocketNotifier::activated, this, &Xwayland::handleXwaylandReady);
 
+    m_startTimer.start();
     m_xwaylandProcess->start();
 
     return true;
@@ -234,6 +279,7 @@ bool Xwayland::startInternal()
 
 void Xwayland::stop()
 {
+    uninstallListenFdNotifiers();
     if (!m_xwaylandProcess) {
         return;
     }
@@ -338,6 +384,12 @@ void Xwayland::handleXwaylandFinished(int exitCode, QProcess::ExitStatus exitSta
     switch (exitStatus) {
     case QProcess::NormalExit:
         stop();
+        if (m_startMode == StartMode::OnDemand) {
+            // Most likely Xwayland has terminated itself after the last client has gone,
+            // wait for the next client to show up.
+            qCDebug(KWIN_XWL) << "Waiting for the next X11 client to start Xwayland again";
+            installListenFdNotifiers();
+        }
         break;
     case QProcess::CrashExit:
         handleXwaylandCrashed();
@@ -406,7 +458,8 @@ void Xwayland::handleXwaylandReady()
         return;
     }
 
-    qCInfo(KWIN_XWL) << "Xwayland server started on display" << m_displayName;
+    qCInfo(KWIN_XWL) << "Xwayland server started on display" << m_displayName
+                     << "in" << m_startTimer.elapsed() << "ms";
 
     // create selection owner for WM_S0 - magic X display number expected by XWayland
     m_selectionOwner.reset(new KSelectionOwner("WM_S0", kwinApp()->x11Connection(), kwinApp()->x11RootWindow()));
@@ -425,12 +478,7 @@ void Xwayland::handleXwaylandReady()
 
     DataBridge::create(this);
 
-    auto env = m_app->processStartupEnvironment();
-    env.insert(QStringLiteral("DISPLAY"), m_displayName);
-    env.insert(QStringLiteral("XAUTHORITY"), m_xAuthority);
-    qputenv("DISPLAY", m_displayName.toUtf8());
-    qputenv("XAUTHORITY", m_xAuthority.toUtf8());
-    m_app->setProcessStartupEnvironment(env);
+    updateEnvironment();
 
     connect(kwinApp()->platform(), &Platform::primaryOutputChanged, this, &Xwayland::updatePrimary);
     updatePrimary(kwinApp()->platform()->primaryOutput());
@@ -441,6 +489,16 @@ void Xwayland::handleXwaylandReady()
     m_xrandrEventsFilter = new XrandrEventFilter(this);
 }
 
+void Xwayland::updateEnvironment()
+{
+    auto env = m_app->processStartupEnvironment();
+    env.insert(QStringLiteral("DISPLAY"), m_displayName);
+    env.insert(QStringLiteral("XAUTHORITY"), m_xAuthority);
+    qputenv("DISPLAY", m_displayName.toUtf8());
+    qputenv("XAUTHORITY", m_xAuthority.toUtf8());
+    m_app->setProcessStartupEnvironment(env);
+}
+
 void Xwayland::updatePrimary(AbstractOutput *primaryOutput)
 {
     Xcb::RandR::ScreenResources resources(rootWindow());
@@ -12,6 +12,7 @@
 
 #include "xwayland_interface.h"
 
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QSocketNotifier>
 #include <QTemporaryFile>
@@ -33,6 +34,18 @@ class KWIN_EXPORT Xwayland : public XwaylandInterface
     Q_OBJECT
 
 public:
+    enum class StartMode {
+        /**
+         * The Xwayland process is spawned right away.
+         */
+        Immediately,
+        /**
+         * The X11 sockets are created right away, but the Xwayland process is spawned only
+         * when the first X11 client connects to one of them.
+         */
+        OnDemand,
+    };
+
     Xwayland(ApplicationWaylandAbstract *app, QObject *parent = nullptr);
     ~Xwayland() override;
 
@@ -71,9 +84,14 @@ public Q_SLOTS:
      * be emitted. If the Xwayland server has started successfully, the started() signal will be
      * emitted.
      *
+     * In the StartMode::OnDemand mode, the X11 sockets are set up and DISPLAY is exported
+     * immediately, but the process is spawned only when an X11 client tries to connect. If
+     * Xwayland quits on its own because it has been idle, it will be spawned again on the
+     * next connection.
+     *
      * @see started(), stop()
      */
-    void start();
+    void start(StartMode mode = StartMode::Immediately);
     /**
      * Stops the Xwayland server.
      *
@@ -108,6 +126,7 @@ private Q_SLOTS:
     void handleXwaylandCrashed();
     void handleXwaylandError(QProcess::ProcessError error);
     void handleXwaylandReady();
+    void handleListenFdActivated();
 
     void handleSelectionLostOwnership();
     void handleSelectionFailedToClaimOwnership();
@@ -120,6 +139,10 @@ private:
     void uninstallSocketNotifier();
     void maybeDestroyReadyNotifier();
     void updatePrimary(AbstractOutput *primaryOutput);
+    void updateEnvironment();
+
+    void installListenFdNotifiers();
+    void uninstallListenFdNotifiers();
 
     bool startInternal();
     void stopInternal();
@@ -135,6 +158,7 @@ private:
     QProcess *m_xwaylandProcess = nullptr;
     QSocketNotifier *m_socketNotifier = nullptr;
     QSocketNotifier *m_readyNotifier = nullptr;
+    QVector<QSocketNotifier *> m_listenFdNotifiers;
     QTimer *m_resetCrashCountTimer = nullptr;
     ApplicationWaylandAbstract *m_app;
     QScopedPointer<KSelectionOwner> m_selectionOwner;
@@ -145,6 +169,8 @@ private:
     QString m_displayName;
     QString m_xAuthority;
 
+    StartMode m_startMode = StartMode::Immediately;
+    QElapsedTimer m_startTimer;
     int m_crashCount = 0;
     XrandrEventFilter *m_xrandrEventsFilter = nullptr;
 